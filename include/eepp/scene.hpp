@@ -8,6 +8,7 @@
 #include <eepp/scene/keyevent.hpp>
 #include <eepp/scene/mouseevent.hpp>
 #include <eepp/scene/node.hpp>
+#include <eepp/scene/nodespatialindex.hpp>
 #include <eepp/scene/nodemessage.hpp>
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/scene/scenenode.hpp>
@@ -26,6 +26,7 @@ namespace EE { namespace Scene {
 class Action;
 class ActionManager;
 class SceneNode;
+class NodeSpatialIndex;
 }} // namespace EE::Scene
 using namespace EE::Scene;
 
@@ -429,6 +430,13 @@ class EE_API Node : public Transformable {
 
 	virtual Node* overFind( const Vector2f& Point );
 
+	/** @brief Indexes the world bounds of the children in a grid, so overFind only visits the
+	 ** children under the point instead of all of them. Useful for nodes with many children. The
+	 ** index is rebuilt when a child is added, removed, moved, resized or transformed. */
+	void setChildsSpatialIndex( bool enabled );
+
+	bool hasChildsSpatialIndex() const;
+
 	/** This removes the node from its parent. Never use this unless you know what you are doing. */
 	void detach();
 
@@ -453,6 +461,7 @@ class EE_API Node : public Transformable {
   protected:
 	typedef UnorderedMap<Uint32, std::map<Uint32, EventCallback>> EventsMap;
 	friend class EventDispatcher;
+	friend class SceneNode;
 
 	std::string mId;
 	String::HashType mIdHash;
@@ -474,6 +483,8 @@ class EE_API Node : public Transformable {
 	mutable Polygon2f mPoly;
 	mutable Rectf mWorldBounds;
 	Vector2f mCenter;
+	struct ChildsIndex;
+	ChildsIndex* mChildsIndex{ nullptr };
 
 	EventsMap mEvents;
 
@@ -572,6 +583,10 @@ class EE_API Node : public Transformable {
 
 	Rectf getScreenBounds();
 
+	/** @return The world bounds expanded with the ones of the visible children drawn out of them.
+	 ** @param update False to get the bounds where the nodes were last drawn. */
+	Rectf getDamageBounds( bool update );
+
 	void setInternalPosition( const Vector2f& Pos );
 
 	void setInternalWidth( const Float& width );
@@ -590,6 +605,12 @@ class EE_API Node : public Transformable {
 
 	void setChildsDirty();
 
+	void invalidateChildsIndex();
+
+	void invalidateParentChildsIndex();
+
+	void updateChildsIndex();
+
 	void clipSmartEnable( const Int32& x, const Int32& y, const Uint32& Width, const Uint32& Height,
 						  bool needsClipPlanes );
 
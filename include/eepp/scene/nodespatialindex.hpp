@@ -0,0 +1,45 @@
+#ifndef EE_SCENE_NODESPATIALINDEX_HPP
+#define EE_SCENE_NODESPATIALINDEX_HPP
+
+#include <eepp/config.hpp>
+#include <eepp/math/rect.hpp>
+#include <eepp/math/vector2.hpp>
+#include <vector>
+
+using namespace EE::Math;
+
+namespace EE { namespace Scene {
+
+/** @brief Uniform grid of rectangles, used to index the world bounds of the children of a node.
+ ** Every cell keeps the indexes of the rectangles that overlap it, so a point query only tests
+ ** the rectangles of one cell. */
+class EE_API NodeSpatialIndex {
+  public:
+	/** @brief Builds the grid from the rectangles, the index of each one is its position. */
+	void build( const std::vector<Rectf>& bounds );
+
+	void clear();
+
+	bool empty() const;
+
+	/** @brief Appends the indexes of the rectangles containing the point, from the last to the
+	 ** first one, which is the order the children are hit tested. */
+	void query( const Vector2f& point, std::vector<Uint32>& indexes ) const;
+
+  protected:
+	std::vector<Rectf> mBounds;
+	// Cell c holds mCellItems[mCellStart[c]] to mCellItems[mCellStart[c + 1]]
+	std::vector<Uint32> mCellStart;
+	std::vector<Uint32> mCellItems;
+	Rectf mGridBounds;
+	Uint32 mColumns{ 0 };
+	Uint32 mRows{ 0 };
+	Float mCellWidth{ 0 };
+	Float mCellHeight{ 0 };
+
+	void getCell( const Float& x, const Float& y, Uint32& column, Uint32& row ) const;
+};
+
+}} // namespace EE::Scene
+
+#endif
@@ -38,6 +38,24 @@ class EE_API SceneNode : public Node {
 
 	void disableDrawInvalidation();
 
+	/** @brief Redraws only the damaged region of the scene.
+	 ** The screen bounds of the invalidated nodes are joined into a damaged region, and only that
+	 ** region is cleared and redrawn into the frame buffer, the rest keeps the previous frame. It
+	 ** requires the frame buffer and the draw invalidation to be enabled, and it applies only to
+	 ** the root scene node. The invalidation highlight also draws the damaged regions. */
+	void setPartialRedraw( bool partialRedraw );
+
+	bool isPartialRedraw() const;
+
+	/** @return The number of pixels redrawn into the frame buffer in the last frame. */
+	const Uint64& getRedrawnPixels() const;
+
+	/** @return The region being redrawn: the damaged region during a partial redraw, otherwise
+	 ** the scene bounds. The nodes outside of it don't need to be drawn. */
+	const Rectf& getRedrawBounds();
+
+	virtual void invalidate( Node* invalidator );
+
 	EE::Window::Window* getWindow();
 
 	FrameBuffer* getFrameBuffer() const;
@@ -143,6 +161,15 @@ class EE_API SceneNode : public Node {
 	UnorderedSet<Node*> mScheduledUpdateRemove;
 	UnorderedSet<Node*> mMouseOverNodes;
 	Float mDPI;
+	bool mPartialRedraw{ false };
+	bool mDamageFull{ true };
+	bool mRedrawingDamage{ false };
+	Uint64 mRedrawnPixels{ 0 };
+	Rectf mDamageBounds;
+	Rectf mRedrawBounds;
+	// Nodes invalidated since the last frame, their new bounds are known when drawing
+	UnorderedSet<Node*> mDamagedNodes;
+	std::vector<Rectf> mDamageRegions;
 
 	virtual void onSizeChange();
 
@@ -171,6 +198,14 @@ class EE_API SceneNode : public Node {
 	void drawFrameBuffer();
 
 	Sizei getFrameBufferSize();
+
+	void addDamage( const Rectf& bounds );
+
+	void setFullDamage();
+
+	bool prepareDamageRedraw();
+
+	void drawDamageRegions();
 };
 
 }} // namespace EE::Scene
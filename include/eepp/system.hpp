@@ -10,6 +10,7 @@
 #include <eepp/system/directorypack.hpp>
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/functionstring.hpp>
+#include <eepp/system/future.hpp>
 #include <eepp/system/inifile.hpp>
 #include <eepp/system/iostream.hpp>
 #include <eepp/system/iostreamdeflate.hpp>
@@ -27,6 +28,7 @@
 #include <eepp/system/packmanager.hpp>
 #include <eepp/system/pak.hpp>
 #include <eepp/system/process.hpp>
+#include <eepp/system/processioservice.hpp>
 #include <eepp/system/rc4.hpp>
 #include <eepp/system/resourceloader.hpp>
 #include <eepp/system/resourcemanager.hpp>
@@ -34,6 +36,7 @@
 #include <eepp/system/scopedop.hpp>
 #include <eepp/system/singleton.hpp>
 #include <eepp/system/sys.hpp>
+#include <eepp/system/taskqueue.hpp>
 #include <eepp/system/thread.hpp>
 #include <eepp/system/threadlocal.hpp>
 #include <eepp/system/threadlocalptr.hpp>
@@ -0,0 +1,423 @@
+#ifndef EE_SYSTEM_FUTURE_HPP
+#define EE_SYSTEM_FUTURE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <eepp/config.hpp>
+#include <eepp/core/debug.hpp>
+#include <eepp/system/taskqueue.hpp>
+#include <eepp/system/threadpool.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace EE { namespace System {
+
+template <typename T> class Future;
+template <typename T> class Promise;
+
+namespace Private {
+
+/** State shared by a Promise and its Futures, without the value. */
+class EE_API FutureStateBase : NonCopyable {
+  public:
+	virtual ~FutureStateBase() {}
+
+	bool isReady() const;
+
+	bool isCancelled() const;
+
+	/** @return True if it's ready or cancelled */
+	bool isDone() const;
+
+	/** @brief Blocks until it's ready or cancelled. */
+	void wait() const;
+
+	/** @return True if it was pending and it's cancelled now */
+	bool cancel();
+
+	/** @brief Runs the continuation when it's ready or cancelled, from the thread that completes
+	 ** it, or right away if it's already done. */
+	void onDone( TaskFunction&& continuation );
+
+  protected:
+	enum Status { Pending, Ready, Cancelled };
+
+	mutable std::mutex mMutex;
+	mutable std::condition_variable mDone;
+	Status mStatus{ Pending };
+	std::vector<TaskFunction> mContinuations;
+
+	/* must be called with mMutex locked and the status pending */
+	std::vector<TaskFunction> complete( Status status );
+
+	void notify( std::vector<TaskFunction>&& continuations );
+};
+
+struct FutureVoid {};
+
+template <typename T>
+using FutureValueType = std::conditional_t<std::is_void<T>::value, FutureVoid, T>;
+
+template <typename T> class FutureState : public FutureStateBase {
+  public:
+	using Value = FutureValueType<T>;
+
+	bool setValue( Value&& value ) {
+		std::vector<TaskFunction> continuations;
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			if ( mStatus != Pending )
+				return false;
+			mValue.emplace( std::move( value ) );
+			continuations = complete( Ready );
+		}
+		notify( std::move( continuations ) );
+		return true;
+	}
+
+	/** The value can only be read once it's ready, and it doesn't change after that */
+	const Value& value() const { return *mValue; }
+
+  protected:
+	std::optional<Value> mValue;
+};
+
+template <typename T> struct IsFuture : std::false_type {};
+
+template <typename T> struct IsFuture<Future<T>> : std::true_type {};
+
+template <typename T> struct FutureUnwrap {
+	using Type = T;
+};
+
+template <typename T> struct FutureUnwrap<Future<T>> {
+	using Type = T;
+};
+
+/* the result of calling F with the value of a Future<T> */
+template <typename T, typename F> struct ContinuationResult {
+	using Type = std::invoke_result_t<F, const T&>;
+};
+
+template <typename F> struct ContinuationResult<void, F> {
+	using Type = std::invoke_result_t<F>;
+};
+
+/* forwards the result of an inner future to the promise */
+template <typename T> void forwardFuture( const Future<T>& inner, Promise<T>&& promise ) {
+	auto state = inner.getState();
+	/* an invalid future never completes */
+	if ( !state ) {
+		promise.cancel();
+		return;
+	}
+	state->onDone( [state, promise = std::move( promise )]() mutable {
+		if ( !state->isReady() ) {
+			promise.cancel();
+		} else if constexpr ( std::is_void<T>::value ) {
+			promise.setValue();
+		} else {
+			promise.setValue( T( state->value() ) );
+		}
+	} );
+}
+
+/* calls func with args and sets its result (or forwards the future it returns) to the promise */
+template <typename R, typename F, typename... Args>
+void invokeAndSet( Promise<typename FutureUnwrap<R>::Type>& promise, F& func, Args&&... args ) {
+	if ( promise.isCancelled() )
+		return;
+	if constexpr ( IsFuture<R>::value ) {
+		forwardFuture( func( std::forward<Args>( args )... ), std::move( promise ) );
+	} else if constexpr ( std::is_void<R>::value ) {
+		func( std::forward<Args>( args )... );
+		promise.setValue();
+	} else {
+		promise.setValue( func( std::forward<Args>( args )... ) );
+	}
+}
+
+} // namespace Private
+
+/** @brief Result of an asynchronous operation, that can be chained with more operations.
+ ** A continuation runs when the future is ready, on a ThreadPool (then) or on a TaskQueue
+ ** (onMainThread), and returns a new future with its result. A continuation that returns a
+ ** Future is flattened, its result is the result of the returned future.
+ ** Cancelling a future cancels all the continuations chained to it.
+ ** @code
+ ** runAsync( pool, [path] { return loadFile( path ); } )
+ **	.then( pool, []( const std::string& data ) { return parse( data ); } )
+ **	.onMainThread( sceneNode->getMainThreadQueue(), [this]( const Document& doc ) {
+ **		show( doc );
+ **	} );
+ ** @endcode */
+template <typename T> class Future {
+  public:
+	using ValueType = T;
+
+	using State = Private::FutureState<T>;
+
+	Future() {}
+
+	explicit Future( std::shared_ptr<State> state ) : mState( std::move( state ) ) {}
+
+	bool isValid() const { return mState != nullptr; }
+
+	bool isReady() const { return mState && mState->isReady(); }
+
+	bool isCancelled() const { return mState && mState->isCancelled(); }
+
+	/** @return True if it's ready or cancelled */
+	bool isDone() const { return !mState || mState->isDone(); }
+
+	/** @brief Blocks until it's ready or cancelled.
+	 ** Must not be called from the thread that has to complete it (e.g. waiting for an
+	 ** onMainThread continuation from the main thread). */
+	void wait() const {
+		if ( mState )
+			mState->wait();
+	}
+
+	/** @brief Waits for the value. The future must not be cancelled. */
+	template <typename U = T, typename = std::enable_if_t<!std::is_void<U>::value>>
+	const U& get() const {
+		mState->wait();
+		eeASSERT( mState->isReady() );
+		return mState->value();
+	}
+
+	/** @brief Cancels the future if it's not ready, the continuations won't run. */
+	bool cancel() { return mState && mState->cancel(); }
+
+	/** @brief Runs `func` with the value in the thread pool when the future is ready.
+	 ** If the pool is destroyed before that, the returned future is cancelled.
+	 ** Like any task of a pool, `func` must not own the pool: the pool would be destroyed from one
+	 ** of its threads if it releases the last reference. */
+	template <typename F>
+	auto then( const std::shared_ptr<ThreadPool>& pool, F&& func,
+			   ThreadPool::Priority priority = ThreadPool::Priority::Interactive ) {
+		std::weak_ptr<ThreadPool> weakPool( pool );
+		ThreadPool* poolPtr = pool.get();
+		return chain(
+			[weakPool, poolPtr, priority]( TaskFunction&& task ) {
+				// From a thread of the pool it's alive, and locking it there could make that
+				// thread release the last reference and destroy the pool
+				if ( ThreadPool::isWorkerThreadOf( poolPtr ) ) {
+					poolPtr->submit( std::move( task ), priority );
+				} else if ( auto pool = weakPool.lock() ) {
+					pool->submit( std::move( task ), priority );
+				}
+			},
+			std::forward<F>( func ) );
+	}
+
+	/** @brief Runs `func` with the value in the thread that processes the queue when the future
+	 ** is ready. If the queue is destroyed before that, the returned future is cancelled. */
+	template <typename F> auto onMainThread( const std::shared_ptr<TaskQueue>& queue, F&& func ) {
+		std::weak_ptr<TaskQueue> weakQueue( queue );
+		return chain(
+			[weakQueue]( TaskFunction&& task ) {
+				if ( auto queue = weakQueue.lock() )
+					queue->post( std::move( task ) );
+			},
+			std::forward<F>( func ) );
+	}
+
+	const std::shared_ptr<State>& getState() const { return mState; }
+
+  protected:
+	std::shared_ptr<State> mState;
+
+	template <typename Post, typename F> auto chain( Post&& post, F&& func ) {
+		using R = typename Private::ContinuationResult<T, std::decay_t<F>>::Type;
+		using Result = typename Private::FutureUnwrap<R>::Type;
+
+		Promise<Result> promise;
+		Future<Result> future( promise.getFuture() );
+
+		if ( !mState ) {
+			promise.cancel();
+			return future;
+		}
+
+		// A task that can't be posted is destroyed with the promise, which cancels the future
+		mState->onDone( [state = mState, post = std::forward<Post>( post ),
+						 func = std::forward<F>( func ), promise = std::move( promise )]() mutable {
+			if ( !state->isReady() ) {
+				promise.cancel();
+				return;
+			}
+			post( TaskFunction(
+				[state, func = std::move( func ), promise = std::move( promise )]() mutable {
+					if constexpr ( std::is_void<T>::value ) {
+						Private::invokeAndSet<R>( promise, func );
+					} else {
+						Private::invokeAndSet<R>( promise, func, state->value() );
+					}
+				} ) );
+		} );
+
+		return future;
+	}
+};
+
+/** @brief Sets the value of a Future. Destroying it before setting a value cancels the future. */
+template <typename T> class Promise {
+  public:
+	using State = Private::FutureState<T>;
+
+	Promise() : mState( std::make_shared<State>() ) {}
+
+	Promise( Promise&& other ) noexcept : mState( std::move( other.mState ) ) {}
+
+	Promise& operator=( Promise&& other ) noexcept {
+		if ( this != &other ) {
+			cancel();
+			mState = std::move( other.mState );
+		}
+		return *this;
+	}
+
+	Promise( const Promise& ) = delete;
+
+	Promise& operator=( const Promise& ) = delete;
+
+	~Promise() { cancel(); }
+
+	Future<T> getFuture() const { return Future<T>( mState ); }
+
+	template <typename U = T, typename = std::enable_if_t<!std::is_void<U>::value>>
+	bool setValue( U value ) {
+		return mState && mState->setValue( std::move( value ) );
+	}
+
+	template <typename U = T, typename = std::enable_if_t<std::is_void<U>::value>>
+	bool setValue() {
+		return mState && mState->setValue( Private::FutureVoid{} );
+	}
+
+	bool cancel() { return mState && mState->cancel(); }
+
+	bool isCancelled() const { return !mState || mState->isCancelled(); }
+
+  protected:
+	std::shared_ptr<State> mState;
+};
+
+/** @return A future that is already ready with the value */
+template <typename T> Future<std::decay_t<T>> makeReadyFuture( T&& value ) {
+	Promise<std::decay_t<T>> promise;
+	promise.setValue( std::forward<T>( value ) );
+	return promise.getFuture();
+}
+
+inline Future<void> makeReadyFuture() {
+	Promise<void> promise;
+	promise.setValue();
+	return promise.getFuture();
+}
+
+/** @brief Runs `func` in the thread pool and returns a future with its result. */
+template <typename F>
+auto runAsync( const std::shared_ptr<ThreadPool>& pool, F&& func,
+			   ThreadPool::Priority priority = ThreadPool::Priority::Interactive ) {
+	using R = std::invoke_result_t<std::decay_t<F>>;
+	using Result = typename Private::FutureUnwrap<R>::Type;
+
+	Promise<Result> promise;
+	Future<Result> future( promise.getFuture() );
+	if ( pool ) {
+		pool->submit(
+			[func = std::forward<F>( func ), promise = std::move( promise )]() mutable {
+				Private::invokeAndSet<R>( promise, func );
+			},
+			priority );
+	}
+	return future;
+}
+
+/** @return A future with the values of all the futures, in the same order. It's cancelled as
+ ** soon as any of them is cancelled. */
+template <typename T> auto whenAll( const std::vector<Future<T>>& futures ) {
+	using Result = std::conditional_t<std::is_void<T>::value, void, std::vector<T>>;
+
+	struct Join {
+		std::vector<Future<T>> futures;
+		Promise<Result> promise;
+		std::atomic<size_t> remaining{ 0 };
+	};
+
+	for ( const auto& future : futures ) {
+		if ( !future.isValid() ) {
+			Promise<Result> promise;
+			promise.cancel();
+			return promise.getFuture();
+		}
+	}
+
+	auto join = std::make_shared<Join>();
+	join->futures = futures;
+	join->remaining = futures.size() + 1;
+	Future<Result> future( join->promise.getFuture() );
+
+	auto onDone = [join]( const std::shared_ptr<Private::FutureState<T>>& state ) {
+		if ( state && !state->isReady() ) {
+			join->promise.cancel();
+			return;
+		}
+		if ( --join->remaining > 0 )
+			return;
+		if constexpr ( std::is_void<T>::value ) {
+			join->promise.setValue();
+		} else {
+			std::vector<T> values;
+			values.reserve( join->futures.size() );
+			for ( const auto& future : join->futures )
+				values.emplace_back( future.getState()->value() );
+			join->promise.setValue( std::move( values ) );
+		}
+		join->futures.clear();
+	};
+
+	for ( const auto& future : futures ) {
+		future.getState()->onDone(
+			[onDone, state = future.getState()]() mutable { onDone( state ); } );
+	}
+	// The extra count avoids completing it while the continuations are being added
+	onDone( nullptr );
+	return future;
+}
+
+/** @return A future that is ready when all the futures are ready, and cancelled as soon as any of
+ ** them is cancelled. */
+template <typename... Ts> Future<void> whenAll( const Future<Ts>&... futures ) {
+	auto promise = std::make_shared<Promise<void>>();
+	auto remaining = std::make_shared<std::atomic<size_t>>( sizeof...( Ts ) + 1 );
+	Future<void> future( promise->getFuture() );
+
+	auto onDone = [promise, remaining]( const Private::FutureStateBase* state ) {
+		if ( state && !state->isReady() ) {
+			promise->cancel();
+		} else if ( --*remaining == 0 ) {
+			promise->setValue();
+		}
+	};
+
+	bool valid = ( futures.isValid() && ... );
+	if ( !valid ) {
+		promise->cancel();
+		return future;
+	}
+	( futures.getState()->onDone(
+		  [onDone, state = futures.getState()]() mutable { onDone( state.get() ); } ),
+	  ... );
+	onDone( nullptr );
+	return future;
+}
+
+}} // namespace EE::System
+
+#endif
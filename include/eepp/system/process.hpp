@@ -30,7 +30,11 @@ class EE_API Process {
 		// Search for program names in the PATH variable. Always enabled on Windows.
 		// Note: this will **not** search for paths in any provided custom environment
 		// and instead uses the PATH of the spawning process.
-		SearchUserPath = 0x10
+		SearchUserPath = 0x10,
+
+		// Read stdout/stderr asynchronously from the shared ProcessIOService instead of a
+		// dedicated thread per process (only POSIX platforms, ignored otherwise).
+		SharedIOService = 0x20
 	};
 
 	static inline constexpr Uint32 getDefaultOptions() {
@@ -83,7 +87,9 @@ class EE_API Process {
 				 const std::unordered_map<std::string, std::string>& environment = {},
 				 const std::string& workingDirectory = "" );
 
-	/** @brief Starts a new thread to receive all stdout and stderr data */
+	/** @brief Starts a new thread to receive all stdout and stderr data.
+	 ** If the process was created with the Option::SharedIOService option the data is received
+	 ** from the ProcessIOService threads instead. */
 	void startAsyncRead( ReadFn readStdOut = nullptr, ReadFn readStdErr = nullptr );
 
 	/** @brief Read all standard output from the child process.
@@ -224,6 +230,9 @@ class EE_API Process {
 	void* mProcess{ nullptr };
 	bool mShuttingDown{ false };
 	bool mIsAsync{ false };
+	Uint32 mOptions{ 0 };
+	Uint64 mStdOutWatch{ 0 };
+	Uint64 mStdErrWatch{ 0 };
 	size_t mBufferSize{ 131072 };
 	std::thread mStdOutThread;
 	std::thread mStdErrThread;
@@ -232,6 +241,8 @@ class EE_API Process {
 	ReadFn mReadStdErrFn;
 
 	size_t readAll( std::string& buffer, bool readErr, Time timeout = Time::Zero );
+
+	void stopSharedRead();
 };
 
 }} // namespace EE::System
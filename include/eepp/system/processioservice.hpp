@@ -0,0 +1,90 @@
+#ifndef EE_SYSTEM_PROCESSIOSERVICE_HPP
+#define EE_SYSTEM_PROCESSIOSERVICE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <eepp/config.hpp>
+#include <eepp/core/noncopyable.hpp>
+#include <eepp/system/threadpool.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace EE { namespace System {
+
+/** @brief Reads the output pipes of many child processes from a single thread.
+ ** The pipes are watched with epoll (Linux) or poll (other POSIX platforms), and when a pipe
+ ** has data it's read and its callback is called from a small thread pool. The callbacks of
+ ** the same pipe are called in order and never at the same time.
+ ** It's used by Process::startAsyncRead when the process is created with the
+ ** Process::SharedIOService option. */
+class EE_API ProcessIOService : NonCopyable {
+  public:
+	typedef std::function<void( const char* bytes, size_t n )> ReadFn;
+
+	static ProcessIOService* instance();
+
+	/** @return If the platform supports the service (it doesn't on Windows and Emscripten) */
+	static bool isSupported();
+
+	~ProcessIOService();
+
+	/** @brief Starts watching a pipe. The pipe is set as non-blocking.
+	 ** @param fd The file descriptor of the pipe.
+	 ** @param bufferSize Maximum number of bytes passed to each call of `readFn`.
+	 ** @param readFn Called with the data read. The data is NUL terminated when it fits in the
+	 ** buffer.
+	 ** @return The id of the watch, or 0 if the pipe couldn't be watched. */
+	Uint64 add( int fd, size_t bufferSize, ReadFn readFn );
+
+	/** @brief Stops watching a pipe, it must be called before the pipe is closed.
+	 ** Waits until the callback of the pipe returns if it's running, so it must not be called
+	 ** from the callback. The watch is removed automatically when the pipe is closed by the
+	 ** child process, but calling it then is harmless. */
+	void remove( Uint64 id );
+
+	/** @return The number of pipes being watched */
+	size_t count();
+
+  protected:
+	struct Watch {
+		Uint64 id{ 0 };
+		int fd{ -1 };
+		ReadFn readFn;
+		std::string buffer;
+		/* a task of the pool is reading the pipe, the pipe is not watched meanwhile */
+		bool reading{ false };
+		std::atomic<bool> removed{ false };
+	};
+
+	ProcessIOService();
+
+	std::unordered_map<Uint64, std::shared_ptr<Watch>> mWatches;
+	std::mutex mMutex;
+	std::condition_variable mReadDone;
+	std::unique_ptr<ThreadPool> mPool;
+	std::thread mThread;
+	std::atomic<bool> mRunning{ false };
+	Uint64 mLastId{ 0 };
+	int mPollFd{ -1 };
+	int mWakeFd[2]{ -1, -1 };
+
+	void run();
+
+	void wake();
+
+	void dispatch( Uint64 id );
+
+	void read( const std::shared_ptr<Watch>& watch );
+
+	bool watch( const Watch& watch, bool add );
+
+	void unwatch( const Watch& watch );
+};
+
+}} // namespace EE::System
+
+#endif // EE_SYSTEM_PROCESSIOSERVICE_HPP
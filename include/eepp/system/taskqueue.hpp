@@ -0,0 +1,42 @@
+#ifndef EE_SYSTEM_TASKQUEUE_HPP
+#define EE_SYSTEM_TASKQUEUE_HPP
+
+#include <deque>
+#include <eepp/config.hpp>
+#include <eepp/core/noncopyable.hpp>
+#include <eepp/system/threadpool.hpp>
+#include <eepp/system/time.hpp>
+#include <mutex>
+
+namespace EE { namespace System {
+
+/** @brief Queue of functions that are run by the thread that owns it.
+ ** Any thread can post functions to it, and the owner runs them when it calls process. The
+ ** UISceneNode owns one that is processed every frame on the main thread. */
+class EE_API TaskQueue : NonCopyable {
+  public:
+	static std::shared_ptr<TaskQueue> New();
+
+	void post( TaskFunction&& func );
+
+	/** @brief Runs the queued functions in order.
+	 ** @param budget Stops after the first function that exceeds the time budget, the remaining
+	 ** functions are kept for the next call. Time::Zero runs all of them.
+	 ** @return The number of functions run. */
+	size_t process( const Time& budget = Time::Zero );
+
+	/** @brief Drops all the queued functions without running them. */
+	void clear();
+
+	size_t size() const;
+
+	bool empty() const;
+
+  protected:
+	mutable std::mutex mMutex;
+	std::deque<TaskFunction> mQueue;
+};
+
+}} // namespace EE::System
+
+#endif
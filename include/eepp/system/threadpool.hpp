@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
 #include <eepp/core/noncopyable.hpp>
 #include <eepp/system/lock.hpp>
@@ -11,11 +12,197 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace EE { namespace System {
 
+/** @brief Move-only callable that stores small functors inline, avoiding a heap allocation. */
+class EE_API TaskFunction {
+  public:
+	/** Functors up to this size (and nothrow movable) are stored inline */
+	static constexpr size_t InlineSize = 6 * sizeof( void* );
+
+	TaskFunction() {}
+
+	template <typename F, typename = std::enable_if_t<
+							  !std::is_same<std::decay_t<F>, TaskFunction>::value>>
+	TaskFunction( F&& func ) {
+		using Fn = std::decay_t<F>;
+		if constexpr ( isInline<Fn>() ) {
+			new ( mStorage ) Fn( std::forward<F>( func ) );
+			mOps = &sInlineOps<Fn>;
+		} else {
+			*reinterpret_cast<Fn**>( mStorage ) = new Fn( std::forward<F>( func ) );
+			mOps = &sHeapOps<Fn>;
+		}
+	}
+
+	TaskFunction( TaskFunction&& other ) noexcept : mOps( other.mOps ) {
+		if ( mOps ) {
+			mOps->move( mStorage, other.mStorage );
+			other.mOps = nullptr;
+		}
+	}
+
+	TaskFunction& operator=( TaskFunction&& other ) noexcept {
+		if ( this != &other ) {
+			reset();
+			mOps = other.mOps;
+			if ( mOps ) {
+				mOps->move( mStorage, other.mStorage );
+				other.mOps = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	TaskFunction( const TaskFunction& ) = delete;
+
+	TaskFunction& operator=( const TaskFunction& ) = delete;
+
+	~TaskFunction() { reset(); }
+
+	void operator()() { mOps->invoke( mStorage ); }
+
+	explicit operator bool() const { return mOps != nullptr; }
+
+	void reset() {
+		if ( mOps ) {
+			mOps->destroy( mStorage );
+			mOps = nullptr;
+		}
+	}
+
+  protected:
+	struct Ops {
+		void ( *invoke )( void* storage );
+		/* move constructs into dst and destroys src */
+		void ( *move )( void* dst, void* src );
+		void ( *destroy )( void* storage );
+	};
+
+	template <typename Fn> static constexpr bool isInline() {
+		return sizeof( Fn ) <= InlineSize && alignof( Fn ) <= alignof( std::max_align_t ) &&
+			   std::is_nothrow_move_constructible<Fn>::value;
+	}
+
+	template <typename Fn> static constexpr Ops sInlineOps = {
+		[]( void* storage ) { ( *static_cast<Fn*>( storage ) )(); },
+		[]( void* dst, void* src ) {
+			new ( dst ) Fn( std::move( *static_cast<Fn*>( src ) ) );
+			static_cast<Fn*>( src )->~Fn();
+		},
+		[]( void* storage ) { static_cast<Fn*>( storage )->~Fn(); } };
+
+	template <typename Fn> static constexpr Ops sHeapOps = {
+		[]( void* storage ) { ( **static_cast<Fn**>( storage ) )(); },
+		[]( void* dst, void* src ) {
+			*static_cast<Fn**>( dst ) = *static_cast<Fn**>( src );
+			*static_cast<Fn**>( src ) = nullptr;
+		},
+		[]( void* storage ) { delete *static_cast<Fn**>( storage ); } };
+
+	alignas( std::max_align_t ) unsigned char mStorage[InlineSize];
+	const Ops* mOps{ nullptr };
+};
+
+class ThreadPool;
+
+/** @brief Shared state of a task submitted to a ThreadPool. */
+class EE_API TaskState {
+  public:
+	enum Status { Queued, Running, Done, Cancelled };
+
+	Uint64 getId() const { return mId; }
+
+	Status getStatus() const { return mStatus.load( std::memory_order_acquire ); }
+
+	bool isCancellationRequested() const {
+		return mCancelRequested.load( std::memory_order_acquire );
+	}
+
+  protected:
+	friend class ThreadPool;
+	friend class TaskHandle;
+
+	Uint64 mId{ 0 };
+	Uint64 mTag{ 0 };
+	std::atomic<Status> mStatus{ Queued };
+	std::atomic<bool> mCancelRequested{ false };
+	std::mutex mMutex;
+	std::condition_variable mFinished;
+
+	/** @return True if the task was still queued, so it will not run */
+	bool cancel();
+
+	void finish( Status status );
+};
+
+/** @brief Lets a running task know that its cancellation was requested. */
+class EE_API CancellationToken {
+  public:
+	CancellationToken() {}
+
+	explicit CancellationToken( std::shared_ptr<TaskState> state ) :
+		mState( std::move( state ) ) {}
+
+	bool isCancelled() const { return mState && mState->isCancellationRequested(); }
+
+  protected:
+	std::shared_ptr<TaskState> mState;
+};
+
+/** @brief Handle to a task submitted with ThreadPool::submit. */
+class EE_API TaskHandle {
+  public:
+	TaskHandle() {}
+
+	explicit TaskHandle( std::shared_ptr<TaskState> state ) : mState( std::move( state ) ) {}
+
+	bool isValid() const { return mState != nullptr; }
+
+	Uint64 getId() const { return mState ? mState->getId() : 0; }
+
+	/** @return True if the task is waiting in the queue */
+	bool isQueued() const;
+
+	/** @return True if the task finished running or was cancelled */
+	bool isDone() const;
+
+	bool isCancelled() const;
+
+	/** @brief Requests the cancellation of the task.
+	 ** A queued task is dropped, a running task can check it with its CancellationToken.
+	 ** @return True if the task was still queued, so it will not run. */
+	bool cancel();
+
+	/** @brief Blocks until the task finished running or was cancelled.
+	 ** Must not be called from a task of the same pool waiting for itself. */
+	void wait() const;
+
+	CancellationToken getCancellationToken() const { return CancellationToken( mState ); }
+
+  protected:
+	std::shared_ptr<TaskState> mState;
+};
+
+/** @brief Pool of worker threads.
+ ** Every worker owns a queue for each priority. Tasks submitted from a worker go to its own queue,
+ ** the rest are distributed round-robin, and an idle worker steals from the other queues. The
+ ** interactive tasks of every queue run before any background task. */
 class EE_API ThreadPool : NonCopyable {
   public:
+	enum class Priority : Uint8 {
+		/** Work the user is waiting for: tokenizing, LSP, loading the visible document... */
+		Interactive,
+		/** Work that can be delayed: project search, indexing, git status... */
+		Background
+	};
+
 	static std::shared_ptr<ThreadPool> createShared( Uint32 numThreads,
 													 bool terminateOnClose = false );
 
@@ -31,7 +218,30 @@ class EE_API ThreadPool : NonCopyable {
 	Uint64 run(
 		const std::function<void()>& func,
 		const std::function<void( const Uint64& )>& doneCallback = []( const Uint64& ) {},
-		const Uint64& tag = 0 );
+		const Uint64& tag = 0, Priority priority = Priority::Interactive );
+
+	/** @brief Queues a task and returns a handle to wait for it or cancel it.
+	 ** The function can receive a `const CancellationToken&` to check if its cancellation was
+	 ** requested while running.
+	 ** @param tag Optional tag, the task can be cancelled with removeWithTag. */
+	template <typename F>
+	TaskHandle submit( F&& func, Priority priority = Priority::Interactive, Uint64 tag = 0 ) {
+		auto state = std::make_shared<TaskState>();
+		state->mId = ++mLastWorkId;
+		state->mTag = tag;
+		if constexpr ( std::is_invocable<std::decay_t<F>, const CancellationToken&>::value ) {
+			push( Work{ TaskFunction( [func = std::forward<F>( func ),
+										token = CancellationToken( state )]() mutable {
+							func( token );
+						} ),
+						nullptr, state->mId, state },
+				  priority );
+		} else {
+			push( Work{ TaskFunction( std::forward<F>( func ) ), nullptr, state->mId, state },
+				  priority );
+		}
+		return TaskHandle( state );
+	}
 
 	Uint32 numThreads() const;
 
@@ -39,31 +249,66 @@ class EE_API ThreadPool : NonCopyable {
 
 	void setTerminateOnClose( bool terminateOnClose );
 
+	/** @return True if the task is waiting in the queue.
+	 ** Prefer keeping a TaskHandle, the tasks queued with `run` are looked up in every queue. */
 	bool existsIdInQueue( const Uint64& id );
 
 	bool existsTagInQueue( const Uint64& tag );
 
+	/** @brief Removes a queued task.
+	 ** Prefer keeping a TaskHandle, the tasks queued with `run` are looked up in every queue. */
 	bool removeId( const Uint64& id );
 
+	/** @brief Cancels all the queued tasks with the tag, it doesn't need to scan the queues. */
 	bool removeWithTag( const Uint64& tag );
 
+	/** @return True if called from one of the threads of this pool */
+	bool isWorkerThread() const;
+
+	/** @return True if called from one of the threads of the pool. The pool is not accessed, so
+	 ** it can be used with a pool that could be destroyed. */
+	static bool isWorkerThreadOf( const ThreadPool* pool );
+
   private:
+	static constexpr size_t PriorityCount = 2;
+
 	struct Work {
+		TaskFunction func;
+		std::function<void( const Uint64& )> callback;
 		Uint64 id{ 0 };
-		const std::function<void()> func;
-		const std::function<void( const Uint64& )> callback;
-		Uint64 tag{ 0 };
+		/* only set for the submitted tasks and the tagged ones */
+		std::shared_ptr<TaskState> state;
 	};
 
-	void threadFunc();
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Work> work[PriorityCount];
+	};
 
 	std::vector<std::unique_ptr<Thread>> mThreads;
-	std::deque<std::unique_ptr<Work>> mWork;
-	std::atomic<Uint64> mLastWorkId;
-	bool mShuttingDown = false;
+	std::vector<std::unique_ptr<Queue>> mQueues;
+	std::atomic<Uint64> mLastWorkId{ 0 };
+	std::atomic<Uint32> mNextQueue{ 0 };
+	/* queued tasks, including the cancelled ones still in a queue */
+	std::atomic<size_t> mPending{ 0 };
+	std::atomic<Uint32> mSleeping{ 0 };
+	std::atomic<bool> mShuttingDown{ false };
 	bool mTerminateOnClose = false;
-	mutable std::mutex mMutex;
+	std::mutex mSleepMutex;
 	std::condition_variable mWorkAvailable;
+	/* states of the queued and running tasks with a tag */
+	std::mutex mTagsMutex;
+	std::unordered_map<Uint64, std::vector<std::shared_ptr<TaskState>>> mTags;
+
+	void threadFunc( size_t index );
+
+	void push( Work&& work, Priority priority );
+
+	bool pop( size_t index, Work& work );
+
+	void execute( Work& work );
+
+	void untag( const std::shared_ptr<TaskState>& state );
 };
 
 }} // namespace EE::System
@@ -126,6 +126,12 @@ class EE_API UIAbstractView : public UIScrollableWidget {
 
 	virtual void onModelSelectionChange();
 
+	virtual void onModelRowsInserted( const ModelIndex& /*parent*/, int /*first*/, int /*last*/ ) {}
+
+	virtual void onModelRowsDeleted( const ModelIndex& /*parent*/, int /*first*/, int /*last*/ ) {}
+
+	virtual void onModelRowsMoved() {}
+
 	void modelUpdate( unsigned flags );
 
 	UIAbstractView( const std::string& tag );
@@ -2,14 +2,22 @@
 #define EE_UI_CSS_ELEMENTDEFINITION_HPP
 
 #include <eepp/core/noncopyable.hpp>
+#include <eepp/ui/css/animationdefinition.hpp>
 #include <eepp/ui/css/propertyidset.hpp>
 #include <eepp/ui/css/stylesheetproperty.hpp>
 #include <eepp/ui/css/stylesheetstyle.hpp>
+#include <eepp/ui/css/transitiondefinition.hpp>
+#include <memory>
 
 namespace EE { namespace UI { namespace CSS {
 
 class EE_API ElementDefinition : NonCopyable {
   public:
+	struct PropertyDelta {
+		// Properties declared by only one of the definitions or with different values
+		PropertyIdSet changed;
+	};
+
 	ElementDefinition( const StyleSheetStyleVector& styleSheetStyles );
 
 	StyleSheetProperty* getProperty( const Uint32& id );
@@ -28,16 +36,40 @@ class EE_API ElementDefinition : NonCopyable {
 
 	const StyleSheetStyleVector& getStyles() const;
 
+	/** @brief The properties that change when a widget goes from the other definition to this one.
+	 ** Definitions are shared by every widget with the same matched rules, so the delta is computed
+	 ** once and reused by all the widgets that make the same change. */
+	const PropertyDelta& getDeltaFrom( const std::shared_ptr<ElementDefinition>& from );
+
+	/** @return The parsed transition properties. */
+	const TransitionsMap& getTransitions();
+
+	/** @return The parsed animation properties. */
+	const AnimationsMap& getAnimations();
+
 	void refresh();
 
   protected:
+	struct CachedDelta {
+		std::weak_ptr<ElementDefinition> from;
+		// The delta is stale once the other definition is refreshed
+		Uint64 fromVersion{ 0 };
+		PropertyDelta delta;
+	};
+
 	StyleSheetStyleVector mStyles;
 	StyleSheetProperties mProperties;
 	StyleSheetVariables mVariables;
 	PropertyIdSet mPropertyIds;
 	std::vector<const CSS::StyleSheetProperty*> mTransitionProperties;
 	std::vector<const CSS::StyleSheetProperty*> mAnimationProperties;
+	UnorderedMap<const ElementDefinition*, CachedDelta> mDeltas;
+	Uint64 mVersion{ 0 };
+	TransitionsMap mTransitions;
+	AnimationsMap mAnimations;
 	bool mStructurallyVolatile;
+	bool mTransitionsParsed{ false };
+	bool mAnimationsParsed{ false };
 
 	void findVariables( const CSS::StyleSheetStyle* style );
 };
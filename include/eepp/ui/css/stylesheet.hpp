@@ -26,6 +26,16 @@ class EE_API StyleSheet {
 	std::shared_ptr<ElementDefinition> getElementStyles( UIWidget* element,
 														 const bool& applyPseudo = false ) const;
 
+	/** @brief Collects the styles that select the element, sorted by specificity.
+	 ** It doesn't modify the style sheet, so several threads can match elements at the same time
+	 ** as long as the widgets are not modified meanwhile. */
+	void matchElementStyles( UIWidget* element, const bool& applyPseudo,
+							 StyleSheetStyleVector& styles ) const;
+
+	/** @return The cached definition of the matched styles, nullptr if there are none. */
+	std::shared_ptr<ElementDefinition>
+	getElementDefinition( const StyleSheetStyleVector& styles ) const;
+
 	const std::vector<std::shared_ptr<StyleSheetStyle>>& getStyles() const;
 
 	std::vector<std::shared_ptr<StyleSheetStyle>>
@@ -72,10 +82,23 @@ class EE_API StyleSheet {
 	StyleSheet& operator=( const StyleSheet& other );
 
   protected:
+	struct IndexedStyle {
+		StyleSheetStyle* style;
+		// Position in the style sheet, it breaks the specificity ties
+		Uint64 order;
+	};
+	using StyleIndex = UnorderedMap<size_t, std::vector<IndexedStyle>>;
+
 	Uint64 mVersion{ 1 };
+	Uint64 mStyleCount{ 0 };
 	Uint32 mMarker{ 0 };
 	std::vector<std::shared_ptr<StyleSheetStyle>> mNodes;
-	UnorderedMap<size_t, StyleSheetStyleVector> mNodeIndex;
+	// The styles are indexed by their rightmost compound selector: by tag and id, else by its
+	// first class, else by its first pseudo-class. The universal tag matches any element when
+	// the pseudo-classes are not applied, so "*.class" goes to the universal bucket (hash 0).
+	StyleIndex mNodeIndex;
+	StyleIndex mClassIndex;
+	StyleIndex mPseudoClassIndex;
 	MediaQueryList::vector mMediaQueryList;
 	KeyframesDefinitionMap mKeyframesMap;
 	using ElementDefinitionCache = UnorderedMap<size_t, std::shared_ptr<ElementDefinition>>;
@@ -86,6 +109,10 @@ class EE_API StyleSheet {
 	void addMediaQueryList( MediaQueryList::ptr list );
 
 	bool addStyleToNodeIndex( StyleSheetStyle* style );
+
+	void collectStyles( std::vector<IndexedStyle>& styles, const StyleIndex& index, size_t hash,
+						UIWidget* element, const bool& applyPseudo,
+						bool useAncestorFilter ) const;
 };
 
 }}} // namespace EE::UI::CSS
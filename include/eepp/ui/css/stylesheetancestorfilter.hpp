@@ -0,0 +1,55 @@
+#ifndef EE_UI_CSS_STYLESHEETANCESTORFILTER_HPP
+#define EE_UI_CSS_STYLESHEETANCESTORFILTER_HPP
+
+#include <eepp/config.hpp>
+#include <eepp/core/noncopyable.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EE { namespace UI {
+class UIWidget;
+}} // namespace EE::UI
+
+namespace EE { namespace UI { namespace CSS {
+
+/** @brief Counting Bloom filter of the tags, ids and classes of the ancestors of the widgets that
+ ** are reloading their style.
+ ** A Scope is kept for each widget while its children are styled, so the selectors that require
+ ** an ancestor feature that is not in the filter are rejected without walking the tree. */
+class EE_API StyleSheetAncestorFilter {
+  protected:
+	struct State;
+
+  public:
+	enum Kind { Tag, Id, Class };
+
+	/** @brief Adds the element to the filter for the lifetime of the scope.
+	 ** If the element is not a child of the last element in the filter a new filter is built from
+	 ** its ancestors, and the previous one is restored when the scope ends. */
+	class EE_API Scope : NonCopyable {
+	  public:
+		explicit Scope( UIWidget* element );
+
+		~Scope();
+
+	  protected:
+		std::unique_ptr<State> mSaved;
+		bool mRoot{ false };
+	};
+
+	static Uint32 hash( Kind kind, const std::string& value );
+
+	/** @return True if the filter holds exactly the ancestors of the element. */
+	static bool isActiveFor( const UIWidget* element );
+
+	/** @return False if any of the hashes is not in the filter, then no ancestor can match. */
+	static bool mayContain( const std::vector<Uint32>& hashes );
+
+  protected:
+	static State& getState();
+};
+
+}}} // namespace EE::UI::CSS
+
+#endif
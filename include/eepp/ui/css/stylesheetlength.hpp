@@ -43,6 +43,9 @@ class EE_API StyleSheetLength {
 
 	static StyleSheetLength fromString( const std::string& str, const Float& defaultValue = 0 );
 
+	/** @return False if the string is not a length, the length is not modified in that case. */
+	static bool parse( const std::string& str, StyleSheetLength& length );
+
 	StyleSheetLength();
 
 	StyleSheetLength( const Float& val, const Unit& unit );
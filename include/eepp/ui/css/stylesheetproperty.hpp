@@ -173,11 +173,31 @@ class EE_API StyleSheetProperty {
 
 	StyleSheetLength asStyleSheetLength() const;
 
+	/** @return True if the value was parsed as a single length when it was set. */
+	bool isParsedLength() const;
+
+	/** @return The value parsed when it was set, only valid if isParsedLength. */
+	StyleSheetLength getParsedLength() const;
+
 	const String::HashType& getValueHash() const;
 
 	const std::vector<VariableFunctionCache>& getVarCache() const;
 
   protected:
+	// Colors, lengths and times are parsed once when the value is set, so applying the property
+	// doesn't parse the string again. The lengths are still converted to pixels on each use,
+	// since their units can depend on the node.
+	enum class ParsedType : Uint8 { None, Color, Length, Time };
+
+	union ParsedValue {
+		Uint32 color;
+		struct {
+			Float value;
+			StyleSheetLength::Unit unit;
+		} length;
+		Int64 time;
+	};
+
 	std::string mName;
 	String::HashType mNameHash;
 	std::string mValue;
@@ -191,12 +211,15 @@ class EE_API StyleSheetProperty {
 	const ShorthandDefinition* mShorthandDefinition;
 	std::vector<StyleSheetProperty> mIndexedProperty;
 	std::vector<VariableFunctionCache> mVarCache;
+	ParsedType mParsedType{ ParsedType::None };
+	ParsedValue mParsedValue;
 
 	explicit StyleSheetProperty( const bool& isVolatile, const PropertyDefinition* definition,
 								 const std::string& value, const Uint32& specificity = 0,
 								 const Uint32& index = 0 );
 
 	void cleanValue();
+	void parseValue();
 	void checkImportant();
 	void createIndexed();
 	void checkVars();
@@ -35,10 +35,19 @@ class EE_API StyleSheetSelector {
 
 	const std::string& getSelectorTagName() const;
 
+	const std::vector<std::string>& getSelectorClasses() const;
+
+	const std::vector<std::string>& getSelectorPseudoClasses() const;
+
+	/** @return The StyleSheetAncestorFilter hashes of the features that the ancestors of an
+	 ** element must have to be selected. */
+	const std::vector<Uint32>& getAncestorHashes() const;
+
   protected:
 	std::string mName;
 	Uint32 mSpecificity;
 	std::vector<StyleSheetSelectorRule> mSelectorRules;
+	std::vector<Uint32> mAncestorHashes;
 	bool mCacheable;
 	bool mStructurallyVolatile;
 
@@ -6,6 +6,8 @@
 #include <memory>
 
 #include <eepp/system/fileinfo.hpp>
+#include <eepp/system/taskqueue.hpp>
+#include <eepp/system/threadpool.hpp>
 #include <eepp/system/translator.hpp>
 #include <eepp/ui/models/model.hpp>
 #include <eepp/ui/uiicon.hpp>
@@ -34,7 +36,8 @@ struct FileEvent {
 		type( action ), directory( directory ), filename( filename ), oldFilename( oldFilename ) {}
 };
 
-class EE_API FileSystemModel : public Model {
+class EE_API FileSystemModel : public Model,
+							   public std::enable_shared_from_this<FileSystemModel> {
   public:
 	enum class Mode { DirectoriesOnly, FilesAndDirectories };
 
@@ -76,6 +79,8 @@ class EE_API FileSystemModel : public Model {
 		Count,
 	};
 
+	struct LoadRequest;
+
 	struct EE_API Node {
 	  public:
 		Node( const std::string& rootPath, const FileSystemModel& model );
@@ -117,6 +122,12 @@ class EE_API FileSystemModel : public Model {
 
 		const Uint32& getHash() { return mHash; }
 
+		/** @return True while the children are being listed in the thread pool. */
+		bool isLoading() const { return mLoading; }
+
+		/** @return True if it's the child displayed while the parent is loading. */
+		bool isPlaceholder() const { return mPlaceholder; }
+
 	  private:
 		friend class FileSystemModel;
 
@@ -134,12 +145,19 @@ class EE_API FileSystemModel : public Model {
 		std::vector<Node*> mChildren;
 		bool mHasTraversed{ false };
 		bool mInfoDirty{ true };
+		bool mLoading{ false };
+		// A change happened while loading, the directory is refreshed once loaded
+		bool mLoadDirty{ false };
+		bool mPlaceholder{ false };
 		Uint32 mHash{ 0 };
+		std::shared_ptr<LoadRequest> mLoadRequest;
 
 		ModelIndex index( const FileSystemModel& model, int column ) const;
 
 		void cleanChildren();
 
+		void cancelLoad();
+
 		void traverseIfNeeded( const FileSystemModel& );
 
 		void refreshIfNeeded( const FileSystemModel& );
@@ -195,6 +213,21 @@ class EE_API FileSystemModel : public Model {
 
 	virtual bool classModelRoleEnabled() { return true; }
 
+	/** @brief Lists the directories in the thread pool when they are traversed. A placeholder
+	 ** child is displayed meanwhile, and the children are inserted in batches as their
+	 ** information is read. The root directory, and all of them without a thread pool or a main
+	 ** thread queue, are listed synchronously. */
+	void setThreadPool( const std::shared_ptr<ThreadPool>& threadPool );
+
+	const std::shared_ptr<ThreadPool>& getThreadPool() const;
+
+	/** @brief The queue where the children listed in the thread pool are inserted, it must be
+	 ** processed by the thread that runs the views of the model (usually
+	 ** UISceneNode::getMainThreadQueue). */
+	void setMainThreadQueue( const std::shared_ptr<TaskQueue>& mainThreadQueue );
+
+	const std::shared_ptr<TaskQueue>& getMainThreadQueue() const;
+
 	~FileSystemModel();
 
   protected:
@@ -205,6 +238,9 @@ class EE_API FileSystemModel : public Model {
 	Mode mMode{ Mode::FilesAndDirectories };
 	DisplayConfig mDisplayConfig;
 	std::array<std::string, Column::Count> mColumnNames;
+	std::string mLoadingText;
+	std::shared_ptr<ThreadPool> mThreadPool;
+	std::shared_ptr<TaskQueue> mMainThreadQueue;
 
 	ModelIndex mPreviouslySelectedIndex{};
 
@@ -217,6 +253,11 @@ class EE_API FileSystemModel : public Model {
 
 	bool handleFileEventLocked( const FileEvent& event );
 
+	bool loadAsync( Node* node );
+
+	bool insertLoadedNodes( LoadRequest& request, std::vector<Node*>& folders,
+							std::vector<Node*>& files, bool done, bool& refreshed );
+
 	void setupColumnNames( Translator* translator );
 };
 
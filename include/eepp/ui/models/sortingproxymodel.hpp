@@ -1,9 +1,12 @@
 #ifndef EE_UI_MODELS_SORTINGPROXYMODEL_HPP
 #define EE_UI_MODELS_SORTINGPROXYMODEL_HPP
 
+#include <eepp/system/threadpool.hpp>
 #include <eepp/ui/models/model.hpp>
 #include <memory>
 
+using namespace EE::System;
+
 namespace EE { namespace UI { namespace Models {
 
 class EE_API SortingProxyModel final : public Model, private Model::Client {
@@ -56,6 +59,12 @@ class EE_API SortingProxyModel final : public Model, private Model::Client {
 
 	virtual bool classModelRoleEnabled();
 
+	/** @brief Large mappings are sorted in parallel in the thread pool. The sort keys are
+	 ** always read from the source model in the calling thread. */
+	void setThreadPool( const std::shared_ptr<ThreadPool>& threadPool );
+
+	const std::shared_ptr<ThreadPool>& getThreadPool() const;
+
   private:
 	// NOTE: The data() of indexes points to the corresponding Mapping object for that index.
 	struct Mapping {
@@ -70,12 +79,26 @@ class EE_API SortingProxyModel final : public Model, private Model::Client {
 
 	virtual void onModelUpdated( unsigned );
 
+	virtual void modelDidInsertRows( const ModelIndex& parent, int first, int last );
+
+	virtual void modelDidDeleteRows( const ModelIndex& parent, int first, int last );
+
 	Model& source();
 
 	const Model& source() const;
 
 	void sortMapping( Mapping&, int column, SortOrder );
 
+	void sortRows( std::vector<int>& rows, const ModelIndex& sourceParent, int column,
+				   SortOrder sortOrder ) const;
+
+	bool rowLessThan( int row1, int row2, const ModelIndex& sourceParent, int column,
+					  SortOrder sortOrder ) const;
+
+	void setMappingRows( Mapping& mapping, std::vector<int>&& sourceRows );
+
+	void remapSelection( const Mapping& mapping, const std::function<int( int )>& proxyRowMap );
+
 	InternalMapIterator buildMapping( const ModelIndex& proxyIndex );
 
 	void invalidate( unsigned flags = Model::UpdateFlag::DontInvalidateIndexes );
@@ -90,6 +113,9 @@ class EE_API SortingProxyModel final : public Model, private Model::Client {
 	SortOrder mSortOrder{ SortOrder::Ascending };
 	ModelRole mSortRole{ ModelRole::Sort };
 	bool mSortingCaseSensitive{ false };
+	// The source rows inserted or deleted since the last update are already in the mappings
+	bool mRowsPatched{ false };
+	std::shared_ptr<ThreadPool> mThreadPool;
 };
 
 }}} // namespace EE::UI::Models
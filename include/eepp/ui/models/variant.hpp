@@ -72,6 +72,7 @@ class EE_API Variant {
 	UIIcon* asIcon() const { return mValue.asIcon; }
 	void* asDataPtr() const { return mValue.asDataPtr; }
 	bool is( const Type& type ) const { return type == mType; }
+	const Type& type() const { return mType; }
 	bool isString() const {
 		return mType == Type::StdString || mType == Type::cstr || mType == Type::String;
 	}
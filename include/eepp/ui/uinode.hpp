@@ -14,6 +14,7 @@
 
 namespace EE { namespace Graphics {
 class Drawable;
+class FrameBuffer;
 }} // namespace EE::Graphics
 
 namespace EE { namespace Scene {
@@ -276,6 +277,19 @@ class EE_API UINode : public Node {
 
 	virtual void nodeDraw();
 
+	/** @brief Enables the retained drawing of the node.
+	 ** The content of the node and its children is drawn into a frame buffer, and while nothing
+	 ** in the subtree calls invalidateDraw the frame buffer is drawn instead of the subtree.
+	 ** Moving the node doesn't invalidate it. Only for nodes using the default nodeDraw, and whose
+	 ** subtree reports every visual change through invalidateDraw. */
+	void setRetainedDraw( bool retainedDraw );
+
+	bool isRetainedDraw() const;
+
+	virtual bool isDrawInvalidator() const;
+
+	virtual void invalidate( Node* invalidator );
+
 	void clearForeground();
 
 	void clearBackground();
@@ -343,6 +357,7 @@ class EE_API UINode : public Node {
 	std::string mMinHeightEq;
 	std::string mMaxWidthEq;
 	std::string mMaxHeightEq;
+	FrameBuffer* mRetainedFrameBuffer{ nullptr };
 
 	virtual Uint32 onMouseDown( const Vector2i& position, const Uint32& flags );
 
@@ -409,6 +424,10 @@ class EE_API UINode : public Node {
 
 	void drawBox();
 
+	void drawContent( bool needsClipPlanes );
+
+	void drawRetained();
+
 	void setInternalPosition( const Vector2f& Pos );
 
 	virtual void setInternalSize( const Sizef& size );
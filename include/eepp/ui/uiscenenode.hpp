@@ -2,6 +2,7 @@
 #define EE_UISCENENODE_HPP
 
 #include <eepp/scene/scenenode.hpp>
+#include <eepp/system/future.hpp>
 #include <eepp/system/threadpool.hpp>
 #include <eepp/system/translator.hpp>
 #include <eepp/ui/css/stylesheet.hpp>
@@ -22,11 +23,23 @@ class UIWindow;
 class UIWidget;
 class UILayout;
 class UIIcon;
+class UIStyle;
 
 enum class ColorSchemePreference { Light, Dark };
 
 class EE_API UISceneNode : public SceneNode {
   public:
+	struct StyleUpdateStats {
+		//! Dirty widgets skipped because a dirty ancestor already reloads them
+		Uint32 pruned{ 0 };
+		//! Widgets whose style state was matched against the style sheet
+		Uint32 matched{ 0 };
+		//! Widgets of the matched ones that were matched in the thread pool
+		Uint32 matchedInParallel{ 0 };
+		//! Widgets that applied a new style definition
+		Uint32 applied{ 0 };
+	};
+
 	static UISceneNode* New( EE::Window::Window* window = NULL );
 
 	explicit UISceneNode( EE::Window::Window* window = NULL );
@@ -113,6 +126,19 @@ class EE_API UISceneNode : public SceneNode {
 
 	void updateDirtyStyleStates();
 
+	/** @return The style definition of the widget for its current state. The widgets of the dirty
+	 ** style states are matched in parallel in the thread pool before being applied. */
+	std::shared_ptr<CSS::ElementDefinition> getElementStyles( UIWidget* widget );
+
+	/** @return The style work done since the start of the last update. */
+	const StyleUpdateStats& getStyleUpdateStats() const;
+
+	/** @brief Minimum number of widgets with a dirty style state to match them in parallel.
+	 ** Default 256. */
+	void setParallelStyleMatchThreshold( Uint32 threshold );
+
+	Uint32 getParallelStyleMatchThreshold() const;
+
 	const bool& isUpdatingLayouts() const;
 
 	UIIconThemeManager* getUIIconThemeManager() const;
@@ -164,11 +190,28 @@ class EE_API UISceneNode : public SceneNode {
 
 	void setThreadPool( const std::shared_ptr<ThreadPool>& threadPool );
 
+	/** @return The queue processed every frame on the main thread, used to run the
+	 ** Future::onMainThread continuations. */
+	const std::shared_ptr<TaskQueue>& getMainThreadQueue() const;
+
+	/** @brief Maximum time spent per frame running the functions of the main thread queue, the
+	 ** rest wait for the next frame. Time::Zero runs all of them. Default 4 ms. */
+	void setMainThreadQueueBudget( const Time& budget );
+
+	const Time& getMainThreadQueueBudget() const;
+
+	/** @brief Runs `func` in the scene thread pool, see Future. */
+	template <typename F>
+	auto runAsync( F&& func, ThreadPool::Priority priority = ThreadPool::Priority::Interactive ) {
+		return System::runAsync( mThreadPool, std::forward<F>( func ), priority );
+	}
+
 	void setTheme( UITheme* theme );
 
   protected:
 	friend class EE::UI::UIWindow;
 	friend class EE::UI::UIWidget;
+	friend class EE::UI::UIStyle;
 	UIWidget* mRoot{ nullptr };
 	Sizef mDpSize;
 	Uint32 mFlags;
@@ -186,12 +229,19 @@ class EE_API UISceneNode : public SceneNode {
 	UnorderedSet<UIWidget*> mDirtyStyleState;
 	UnorderedMap<UIWidget*, bool> mDirtyStyleStateCSSAnimations;
 	UnorderedSet<UILayout*> mDirtyLayouts;
+	// The dirty roots being processed, the deleted widgets are set to nullptr
+	std::vector<std::vector<UIWidget*>*> mStyleRootLists;
+	UnorderedMap<UIWidget*, CSS::StyleSheetStyleVector> mStyleMatches;
+	StyleUpdateStats mStyleUpdateStats;
+	Uint32 mParallelStyleMatchThreshold{ 256 };
 	std::vector<std::pair<Float, std::string>> mTimes;
 	ColorSchemePreference mColorSchemePreference{ ColorSchemePreference::Dark };
 	Uint32 mMaxInvalidationDepth{ 2 };
 	Node* mCurParent{ nullptr };
 	Uint32 mCurOnSizeChangeListener{ 0 };
 	std::shared_ptr<ThreadPool> mThreadPool;
+	std::shared_ptr<TaskQueue> mMainThreadQueue;
+	Time mMainThreadQueueBudget{ Milliseconds( 4 ) };
 
 	virtual void resizeNode( EE::Window::Window* win );
 
@@ -203,6 +253,10 @@ class EE_API UISceneNode : public SceneNode {
 
 	void setInternalPixelsSize( const Sizef& size );
 
+	std::vector<UIWidget*> takeDirtyRoots( UnorderedSet<UIWidget*>& dirty );
+
+	void matchStylesInParallel( const std::vector<UIWidget*>& roots );
+
 	void setActiveWindow( UIWindow* window );
 
 	void setFocusLastWindow( UIWindow* window );
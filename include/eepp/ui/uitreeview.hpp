@@ -1,6 +1,7 @@
 #ifndef EE_UI_UITREEVIEW_HPP
 #define EE_UI_UITREEVIEW_HPP
 
+#include <atomic>
 #include <eepp/ui/abstract/uiabstracttableview.hpp>
 #include <eepp/ui/uiicon.hpp>
 #include <eepp/ui/uitablerow.hpp>
@@ -106,6 +107,16 @@ class EE_API UITreeView : public UIAbstractTableView {
 
 	virtual void onOpenTreeModelIndex( const ModelIndex& index, bool open );
 
+	/** @return The number of visible rows, the rows of the expanded nodes included. */
+	size_t getVisibleRowCount() const;
+
+	/** @return The index (at the tree column) of the visible row, or an invalid index. */
+	ModelIndex getIndexAtRow( const size_t& row ) const;
+
+	/** @return The visible row of the index, or -1 if it's not visible. It's a binary search over
+	 ** the visible rows on every level of the index tree. */
+	Int64 getRowFromIndex( const ModelIndex& index ) const;
+
   protected:
 	enum class IterationDecision {
 		Continue,
@@ -130,11 +141,25 @@ class EE_API UITreeView : public UIAbstractTableView {
 		bool open{ false };
 	};
 
+	// The visible rows flattened in the tree order, so the rows of the viewport are found without
+	// traversing the model. It's rebuilt on model updates and patched on expand and collapse and
+	// on row inserts and deletes.
+	struct FlatRow {
+		ModelIndex index;
+		// Position of the parent row, -1 for the top level rows
+		Int64 parent;
+		Uint32 depth;
+	};
+
+	mutable std::vector<FlatRow> mFlatRows;
+	mutable std::atomic<bool> mFlatRowsDirty{ true };
+	bool mFlatRowsPatched{ false };
+
 	typedef std::function<IterationDecision( const int&, const ModelIndex&, const size_t&,
 											 const Float& )>
 		TreeViewCallback;
 
-	void traverseTree( TreeViewCallback ) const;
+	void traverseTree( TreeViewCallback, const size_t& startRow = 0 ) const;
 
 	mutable std::unordered_map<void*, MetadataForIndex> mViewMetadata;
 
@@ -142,6 +167,29 @@ class EE_API UITreeView : public UIAbstractTableView {
 
 	UITreeView::MetadataForIndex& getIndexMetadata( const ModelIndex& index ) const;
 
+	const std::vector<FlatRow>& getFlatRows() const;
+
+	void appendFlatRows( std::vector<FlatRow>& rows, const Int64& offset, const ModelIndex& index,
+						 const Int64& parentRow, const Uint32& depth ) const;
+
+	size_t getFirstVisibleRow() const;
+
+	Int64 getFlatRowSubtreeEnd( const Int64& row ) const;
+
+	void replaceFlatRows( const Int64& first, const Int64& last, std::vector<FlatRow>& rows );
+
+	void updateFlatRowChilds( const ModelIndex& index );
+
+	void setIndexOpen( const ModelIndex& index, bool open );
+
+	virtual void onModelUpdate( unsigned flags );
+
+	virtual void onModelRowsInserted( const ModelIndex& parent, int first, int last );
+
+	virtual void onModelRowsDeleted( const ModelIndex& parent, int first, int last );
+
+	virtual void onModelRowsMoved();
+
 	virtual void onColumnSizeChange( const size_t& colIndex, bool fromUserInteraction = false );
 
 	virtual UIWidget* updateCell( const Vector2<Int64>& posIndex, const ModelIndex& index,
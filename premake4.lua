@@ -1543,11 +1543,28 @@ solution "eepp"
 		includedirs { "src/thirdparty" }
 		build_link_configuration( "eepp-ui-perf-test", true )
 
+	project "eterm-perf-test"
+		kind "ConsoleApp"
+		language "C++"
+		files { "src/tests/eterm_perf_test/*.cpp" }
+		includedirs { "src/modules/eterm/include/", "src/thirdparty" }
+		links { "eterm-static" }
+		build_link_configuration( "eterm-perf-test", true )
+
+	project "eepp-threadpool-perf-test"
+		kind "ConsoleApp"
+		language "C++"
+		files { "src/tests/threadpool_perf_test/*.cpp" }
+		includedirs { "src/thirdparty" }
+		build_link_configuration( "eepp-threadpool-perf-test", true )
+
 	project "eepp-unit_tests"
 		kind "ConsoleApp"
 		targetdir("./bin/unit_tests")
 		language "C++"
 		files { "src/tests/unit_tests/*.cpp" }
+		includedirs { "src/modules/eterm/include/" }
+		links { "eterm-static" }
 		build_link_configuration( "eepp-unit_tests", true )
 
 if os.isfile("external_projects.lua") then
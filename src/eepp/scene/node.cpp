@@ -4,11 +4,18 @@
 #include <eepp/scene/action.hpp>
 #include <eepp/scene/actionmanager.hpp>
 #include <eepp/scene/node.hpp>
+#include <eepp/scene/nodespatialindex.hpp>
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/scene/scenenode.hpp>
 
 namespace EE { namespace Scene {
 
+struct Node::ChildsIndex {
+	NodeSpatialIndex grid;
+	std::vector<Node*> childs;
+	bool dirty{ true };
+};
+
 Node* Node::New() {
 	return eeNew( Node, () );
 }
@@ -41,6 +48,11 @@ Node::~Node() {
 
 		if ( isMouseOverMeOrChilds() )
 			mSceneNode->removeMouseOverNode( this );
+
+		if ( mSceneNode != this && mSceneNode->isPartialRedraw() ) {
+			mSceneNode->mDamagedNodes.erase( this );
+			mSceneNode->addDamage( getDamageBounds( false ) );
+		}
 	}
 
 	childDeleteAll();
@@ -48,6 +60,8 @@ Node::~Node() {
 	if ( NULL != mParentNode )
 		mParentNode->childRemove( this );
 
+	eeSAFE_DELETE( mChildsIndex );
+
 	EventDispatcher* eventDispatcher = getEventDispatcher();
 
 	if ( NULL != eventDispatcher ) {
@@ -136,6 +150,7 @@ Node* Node::setPosition( const Float& x, const Float& y ) {
 void Node::setInternalSize( const Sizef& size ) {
 	mSize = size;
 	mNodeFlags |= NODE_FLAG_POLYGON_DIRTY;
+	invalidateParentChildsIndex();
 	updateCenter();
 	sendCommonEvent( Event::OnSizeChange );
 	invalidateDraw();
@@ -501,7 +516,9 @@ void Node::onEnabledChange() {
 
 void Node::onPositionChange() {
 	sendCommonEvent( Event::OnPositionChange );
-	invalidateDraw();
+	// A node drawn from its own frame buffer is just drawn at the new position
+	if ( NULL != mNodeDrawInvalidator )
+		mNodeDrawInvalidator->invalidate( this );
 }
 
 void Node::onSizeChange() {
@@ -638,6 +655,8 @@ void Node::childDeleteAll() {
 }
 
 void Node::childAdd( Node* node ) {
+	invalidateChildsIndex();
+
 	if ( NULL == mChild ) {
 		mChild = node;
 		mChildLast = node;
@@ -658,6 +677,8 @@ void Node::childAdd( Node* node ) {
 void Node::childAddAt( Node* node, Uint32 index ) {
 	eeASSERT( NULL != node );
 
+	invalidateChildsIndex();
+
 	Node* nodeLoop = mChild;
 
 	node->setParent( this );
@@ -710,6 +731,8 @@ void Node::childAddAt( Node* node, Uint32 index ) {
 }
 
 void Node::childRemove( Node* node ) {
+	invalidateChildsIndex();
+
 	if ( node == mChild ) {
 		mChild = mChild->mNext;
 
@@ -977,18 +1000,31 @@ Node* Node::overFind( const Vector2f& point ) {
 			writeNodeFlag( NODE_FLAG_MOUSEOVER_ME_OR_CHILD, 1 );
 			mSceneNode->addMouseOverNode( this );
 
-			Node* child = mChildLast;
+			if ( NULL != mChildsIndex ) {
+				updateChildsIndex();
 
-			while ( NULL != child ) {
-				Node* childOver = child->overFind( point );
+				// Only the children whose bounds contain the point, from the topmost
+				std::vector<Uint32> candidates;
+				mChildsIndex->grid.query( point, candidates );
 
-				if ( NULL != childOver ) {
-					pOver = childOver;
-
-					break; // Search from top to bottom, so the first over will be the topmost
+				for ( Uint32 index : candidates ) {
+					if ( NULL != ( pOver = mChildsIndex->childs[index]->overFind( point ) ) )
+						break;
 				}
+			} else {
+				Node* child = mChildLast;
 
-				child = child->mPrev;
+				while ( NULL != child ) {
+					Node* childOver = child->overFind( point );
+
+					if ( NULL != childOver ) {
+						pOver = childOver;
+
+						break; // Search from top to bottom, so the first over will be the topmost
+					}
+
+					child = child->mPrev;
+				}
 			}
 
 			if ( NULL == pOver )
@@ -999,6 +1035,45 @@ Node* Node::overFind( const Vector2f& point ) {
 	return pOver;
 }
 
+void Node::setChildsSpatialIndex( bool enabled ) {
+	if ( enabled && NULL == mChildsIndex ) {
+		mChildsIndex = eeNew( ChildsIndex, () );
+	} else if ( !enabled ) {
+		eeSAFE_DELETE( mChildsIndex );
+	}
+}
+
+bool Node::hasChildsSpatialIndex() const {
+	return NULL != mChildsIndex;
+}
+
+void Node::invalidateChildsIndex() {
+	if ( NULL != mChildsIndex )
+		mChildsIndex->dirty = true;
+}
+
+void Node::invalidateParentChildsIndex() {
+	if ( NULL != mParentNode )
+		mParentNode->invalidateChildsIndex();
+}
+
+void Node::updateChildsIndex() {
+	if ( NULL == mChildsIndex || !mChildsIndex->dirty )
+		return;
+
+	std::vector<Rectf> bounds;
+	mChildsIndex->childs.clear();
+
+	for ( Node* child = mChild; NULL != child; child = child->mNext ) {
+		mChildsIndex->childs.push_back( child );
+		// Updates the child polygon, the child notifies any later change
+		bounds.push_back( child->getWorldBounds() );
+	}
+
+	mChildsIndex->grid.build( bounds );
+	mChildsIndex->dirty = false;
+}
+
 void Node::detach() {
 	if ( mParentNode ) {
 		mParentNode->childRemove( this );
@@ -1132,6 +1207,32 @@ const Polygon2f& Node::getWorldPolygon() {
 	return mPoly;
 }
 
+Rectf Node::getDamageBounds( bool update ) {
+	Rectf bounds( update ? getWorldBounds() : mWorldBounds );
+
+	// The children of a clipped node can't be drawn out of its bounds
+	if ( isClipped() )
+		return bounds;
+
+	for ( Node* child = mChild; NULL != child; child = child->mNext ) {
+		if ( !child->mVisible )
+			continue;
+
+		Rectf childBounds( child->getDamageBounds( update ) );
+
+		if ( childBounds.getWidth() <= 0 || childBounds.getHeight() <= 0 )
+			continue;
+
+		if ( bounds.getWidth() <= 0 || bounds.getHeight() <= 0 ) {
+			bounds = childBounds;
+		} else {
+			bounds.expand( childBounds );
+		}
+	}
+
+	return bounds;
+}
+
 const Rectf& Node::getWorldBounds() {
 	if ( mNodeFlags & NODE_FLAG_POLYGON_DIRTY )
 		updateWorldPolygon();
@@ -1304,7 +1405,10 @@ void Node::setReverseDraw( bool reverseDraw ) {
 }
 
 void Node::invalidateDraw() {
-	if ( NULL != mNodeDrawInvalidator ) {
+	if ( ( mNodeFlags & NODE_FLAG_FRAME_BUFFER ) && isDrawInvalidator() ) {
+		// The node caches its own drawing, it must be redrawn and it invalidates its parents.
+		invalidate( this );
+	} else if ( NULL != mNodeDrawInvalidator ) {
 		mNodeDrawInvalidator->invalidate( this );
 	}
 }
@@ -1361,6 +1465,8 @@ void Node::setDirty() {
 
 	mNodeFlags |= NODE_FLAG_POSITION_DIRTY | NODE_FLAG_POLYGON_DIRTY;
 
+	invalidateParentChildsIndex();
+
 	setChildsDirty();
 }
 
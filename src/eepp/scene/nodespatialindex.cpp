@@ -0,0 +1,95 @@
+#include <cmath>
+#include <eepp/scene/nodespatialindex.hpp>
+
+namespace EE { namespace Scene {
+
+static constexpr Uint32 MAX_GRID_SIDE = 64;
+
+void NodeSpatialIndex::build( const std::vector<Rectf>& bounds ) {
+	clear();
+
+	mBounds = bounds;
+
+	if ( mBounds.empty() )
+		return;
+
+	mGridBounds = mBounds[0];
+	for ( const auto& rect : mBounds )
+		mGridBounds.expand( rect );
+
+	// Around one rectangle per cell when they are evenly distributed
+	Uint32 side = eemax( 1u, eemin( MAX_GRID_SIDE, (Uint32)std::sqrt( (double)mBounds.size() ) ) );
+	mColumns = mGridBounds.getWidth() > 0 ? side : 1;
+	mRows = mGridBounds.getHeight() > 0 ? side : 1;
+	mCellWidth = mGridBounds.getWidth() > 0 ? mGridBounds.getWidth() / mColumns : 1;
+	mCellHeight = mGridBounds.getHeight() > 0 ? mGridBounds.getHeight() / mRows : 1;
+
+	// Counting sort of the items by cell, keeping them in ascending order in every cell
+	mCellStart.assign( mColumns * mRows + 1, 0 );
+
+	for ( int pass = 0; pass < 2; pass++ ) {
+		std::vector<Uint32> cursor;
+
+		if ( pass == 1 ) {
+			for ( size_t i = 1; i < mCellStart.size(); i++ )
+				mCellStart[i] += mCellStart[i - 1];
+			mCellItems.resize( mCellStart.back() );
+			cursor.assign( mCellStart.begin(), mCellStart.end() - 1 );
+		}
+
+		for ( Uint32 i = 0; i < mBounds.size(); i++ ) {
+			Uint32 left, top, right, bottom;
+			getCell( mBounds[i].Left, mBounds[i].Top, left, top );
+			getCell( mBounds[i].Right, mBounds[i].Bottom, right, bottom );
+
+			for ( Uint32 row = top; row <= bottom; row++ ) {
+				for ( Uint32 column = left; column <= right; column++ ) {
+					Uint32 cell = row * mColumns + column;
+					if ( pass == 0 ) {
+						mCellStart[cell + 1]++;
+					} else {
+						mCellItems[cursor[cell]++] = i;
+					}
+				}
+			}
+		}
+	}
+}
+
+void NodeSpatialIndex::clear() {
+	mBounds.clear();
+	mCellStart.clear();
+	mCellItems.clear();
+	mGridBounds = Rectf();
+	mColumns = mRows = 0;
+}
+
+bool NodeSpatialIndex::empty() const {
+	return mBounds.empty();
+}
+
+void NodeSpatialIndex::query( const Vector2f& point, std::vector<Uint32>& indexes ) const {
+	if ( mBounds.empty() || !mGridBounds.contains( point ) )
+		return;
+
+	Uint32 column, row;
+	getCell( point.x, point.y, column, row );
+
+	Uint32 cell = row * mColumns + column;
+
+	for ( Uint32 i = mCellStart[cell + 1]; i > mCellStart[cell]; i-- ) {
+		Uint32 index = mCellItems[i - 1];
+		if ( mBounds[index].contains( point ) )
+			indexes.push_back( index );
+	}
+}
+
+void NodeSpatialIndex::getCell( const Float& x, const Float& y, Uint32& column,
+								Uint32& row ) const {
+	Float cx = ( x - mGridBounds.Left ) / mCellWidth;
+	Float cy = ( y - mGridBounds.Top ) / mCellHeight;
+	column = cx <= 0 ? 0 : eemin( mColumns - 1, (Uint32)cx );
+	row = cy <= 0 ? 0 : eemin( mRows - 1, (Uint32)cy );
+}
+
+}} // namespace EE::Scene
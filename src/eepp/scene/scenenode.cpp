@@ -1,5 +1,7 @@
 #include <eepp/graphics/framebuffer.hpp>
 #include <eepp/graphics/globalbatchrenderer.hpp>
+#include <eepp/graphics/pixeldensity.hpp>
+#include <eepp/graphics/primitives.hpp>
 #include <eepp/graphics/renderer/renderer.hpp>
 #include <eepp/graphics/textureregion.hpp>
 #include <eepp/scene/actionmanager.hpp>
@@ -53,6 +55,10 @@ SceneNode::SceneNode( EE::Window::Window* window ) :
 }
 
 SceneNode::~SceneNode() {
+	// The children are destroyed by ~Node, they must not add damage to this node by then
+	mPartialRedraw = false;
+	mDamagedNodes.clear();
+
 	if ( -1 != mResizeCb && NULL != Engine::existsSingleton() &&
 		 Engine::instance()->existsWindow( mWindow ) ) {
 		mWindow->popResizeCallback( mResizeCb );
@@ -102,18 +108,43 @@ void SceneNode::draw() {
 		if ( !clips.empty() )
 			clippingMask->clipPlaneDisable();
 
+		bool redraw = NULL == mFrameBuffer || !usesInvalidation() || invalidated();
+
+		mRedrawingDamage = redraw && prepareDamageRedraw();
+
 		matrixSet();
 
-		if ( NULL == mFrameBuffer || !usesInvalidation() || invalidated() ) {
+		if ( redraw ) {
 			bool needsClipPlanes = isMeOrParentTreeScaledOrRotatedOrFrameBuffer();
 
-			clipStart( needsClipPlanes );
+			if ( mRedrawingDamage ) {
+				mRedrawnPixels = (Uint64)mRedrawBounds.area();
+
+				// Only the damaged region is cleared, the rest of the buffer keeps the last frame
+				clippingMask->clipEnable( mRedrawBounds.Left, mRedrawBounds.Top,
+										  mRedrawBounds.getWidth(), mRedrawBounds.getHeight() );
 
-			drawChilds();
+				mFrameBuffer->clear();
+			} else {
+				mRedrawnPixels = (Uint64)mSize.getWidth() * (Uint64)mSize.getHeight();
+			}
 
-			clipEnd( needsClipPlanes );
+			if ( !mRedrawingDamage || 0 != mRedrawnPixels ) {
+				clipStart( needsClipPlanes );
+
+				drawChilds();
+
+				clipEnd( needsClipPlanes );
+			}
+
+			if ( mRedrawingDamage )
+				clippingMask->clipDisable();
+		} else {
+			mRedrawnPixels = 0;
 		}
 
+		mRedrawingDamage = false;
+
 		matrixUnset();
 
 		if ( !clips.empty() )
@@ -121,6 +152,9 @@ void SceneNode::draw() {
 
 		postDraw();
 
+		if ( redraw )
+			drawDamageRegions();
+
 		writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 0 );
 	}
 
@@ -295,6 +329,119 @@ void SceneNode::disableDrawInvalidation() {
 	mUseInvalidation = false;
 }
 
+void SceneNode::setPartialRedraw( bool partialRedraw ) {
+	mPartialRedraw = partialRedraw;
+	setFullDamage();
+	invalidateDraw();
+}
+
+bool SceneNode::isPartialRedraw() const {
+	return mPartialRedraw;
+}
+
+const Uint64& SceneNode::getRedrawnPixels() const {
+	return mRedrawnPixels;
+}
+
+const Rectf& SceneNode::getRedrawBounds() {
+	return mRedrawingDamage ? mRedrawBounds : getWorldBounds();
+}
+
+void SceneNode::invalidate( Node* invalidator ) {
+	Node::invalidate( invalidator );
+
+	if ( !mPartialRedraw || mDamageFull )
+		return;
+
+	// Windows draw shadows out of their bounds and redraw their whole frame buffer
+	if ( NULL == invalidator || invalidator == this || invalidator->isWindow() ) {
+		setFullDamage();
+		return;
+	}
+
+	for ( Node* node = invalidator->mNodeDrawInvalidator; NULL != node && node != this;
+		  node = node->mNodeDrawInvalidator ) {
+		if ( node->isWindow() || node == node->mNodeDrawInvalidator ) {
+			setFullDamage();
+			return;
+		}
+	}
+
+	// The bounds where the node was last drawn, the new ones are added before drawing
+	addDamage( invalidator->getDamageBounds( false ) );
+
+	mDamagedNodes.insert( invalidator );
+}
+
+void SceneNode::addDamage( const Rectf& bounds ) {
+	if ( mDamageFull || bounds.getWidth() <= 0 || bounds.getHeight() <= 0 )
+		return;
+
+	if ( mDamageBounds.getWidth() <= 0 || mDamageBounds.getHeight() <= 0 ) {
+		mDamageBounds = bounds;
+	} else {
+		mDamageBounds.expand( bounds );
+	}
+
+	if ( mHighlightInvalidation )
+		mDamageRegions.push_back( bounds );
+}
+
+void SceneNode::setFullDamage() {
+	mDamageFull = true;
+	mDamageBounds = Rectf();
+	mDamagedNodes.clear();
+	mDamageRegions.clear();
+}
+
+bool SceneNode::prepareDamageRedraw() {
+	// The damage is clipped with scissors, in window coordinates
+	bool partial = mPartialRedraw && !mDamageFull && NULL == mParentNode &&
+				   NULL != mFrameBuffer && mUseInvalidation &&
+				   mFrameBuffer->getHeight() == (Int32)mWindow->getHeight();
+
+	if ( partial ) {
+		for ( Node* node : mDamagedNodes )
+			addDamage( node->getDamageBounds( true ) );
+
+		if ( mDamageBounds.getWidth() > 0 && mDamageBounds.getHeight() > 0 ) {
+			mRedrawBounds =
+				Rectf( eefloor( mDamageBounds.Left ), eefloor( mDamageBounds.Top ),
+					   eeceil( mDamageBounds.Right ), eeceil( mDamageBounds.Bottom ) );
+			mRedrawBounds.shrink( getWorldBounds() );
+		} else {
+			mRedrawBounds = Rectf();
+		}
+	} else {
+		mDamageRegions.clear();
+	}
+
+	mDamageFull = false;
+	mDamageBounds = Rectf();
+	mDamagedNodes.clear();
+
+	return partial;
+}
+
+void SceneNode::drawDamageRegions() {
+	if ( !mHighlightInvalidation || !mPartialRedraw )
+		return;
+
+	Primitives P;
+	P.setFillMode( DRAW_LINE );
+	P.setColor( mHighlightInvalidationColor );
+	P.setLineWidth( PixelDensity::dpToPx( 1 ) );
+
+	if ( mDamageRegions.empty() ) {
+		P.drawRectangle( getScreenBounds() );
+	} else {
+		for ( const auto& region : mDamageRegions )
+			P.drawRectangle( region );
+	}
+
+	mDamageRegions.clear();
+}
+
 EE::Window::Window* SceneNode::getWindow() {
 	return mWindow;
 }
@@ -306,7 +453,8 @@ void SceneNode::matrixSet() {
 
 			mFrameBuffer->bind();
 
-			mFrameBuffer->clear();
+			if ( !mRedrawingDamage )
+				mFrameBuffer->clear();
 		}
 
 		if ( 0.f != mScreenPos ) {
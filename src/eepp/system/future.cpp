@@ -0,0 +1,60 @@
+#include <eepp/system/future.hpp>
+
+namespace EE { namespace System { namespace Private {
+
+bool FutureStateBase::isReady() const {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mStatus == Ready;
+}
+
+bool FutureStateBase::isCancelled() const {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mStatus == Cancelled;
+}
+
+bool FutureStateBase::isDone() const {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mStatus != Pending;
+}
+
+void FutureStateBase::wait() const {
+	std::unique_lock<std::mutex> lock( mMutex );
+	mDone.wait( lock, [this] { return mStatus != Pending; } );
+}
+
+bool FutureStateBase::cancel() {
+	std::vector<TaskFunction> continuations;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if ( mStatus != Pending )
+			return false;
+		continuations = complete( Cancelled );
+	}
+	notify( std::move( continuations ) );
+	return true;
+}
+
+void FutureStateBase::onDone( TaskFunction&& continuation ) {
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if ( mStatus == Pending ) {
+			mContinuations.emplace_back( std::move( continuation ) );
+			return;
+		}
+	}
+	continuation();
+}
+
+std::vector<TaskFunction> FutureStateBase::complete( Status status ) {
+	mStatus = status;
+	return std::move( mContinuations );
+}
+
+void FutureStateBase::notify( std::vector<TaskFunction>&& continuations ) {
+	mDone.notify_all();
+	// Out of the lock, the continuations can chain more work on this state
+	for ( auto& continuation : continuations )
+		continuation();
+}
+
+}}} // namespace EE::System::Private
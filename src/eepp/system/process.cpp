@@ -6,6 +6,7 @@
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/lock.hpp>
 #include <eepp/system/process.hpp>
+#include <eepp/system/processioservice.hpp>
 #include <eepp/system/sys.hpp>
 
 #if EE_PLATFORM == EE_PLATFORM_MACOS || EE_PLATFORM == EE_PLATFORM_IOS
@@ -41,6 +42,7 @@ Process::Process( const std::string& command, Uint32 options,
 
 Process::~Process() {
 	mShuttingDown = true;
+	stopSharedRead();
 	if ( mProcess && isAlive() )
 		kill();
 	if ( mStdOutThread.joinable() )
@@ -74,6 +76,8 @@ bool Process::create( const std::string& command, const std::vector<std::string>
 					  const std::string& workingDirectory ) {
 	if ( mProcess )
 		return false;
+	mOptions = options;
+	options &= ~Process::SharedIOService;
 	std::vector<const char*> strings;
 	mProcess = eeMalloc( sizeof( subprocess_s ) );
 	memset( mProcess, 0, sizeof( subprocess_s ) );
@@ -192,6 +196,7 @@ bool Process::kill() {
 
 bool Process::destroy() {
 	eeASSERT( mProcess != nullptr );
+	stopSharedRead();
 	return 0 == subprocess_destroy( PROCESS_PTR );
 }
 
@@ -333,6 +338,27 @@ void Process::startAsyncRead( ReadFn readStdOut, ReadFn readStdErr ) {
 		} );
 	}
 #elif defined( EE_PLATFORM_POSIX )
+	if ( ( mOptions & Process::SharedIOService ) && ProcessIOService::isSupported() ) {
+		auto stdOutFd = fileno( PROCESS_PTR->stdout_file );
+		auto stdErrFd = PROCESS_PTR->stderr_file ? fileno( PROCESS_PTR->stderr_file ) : 0;
+		ProcessIOService* service = ProcessIOService::instance();
+		if ( stdOutFd ) {
+			mStdOutWatch =
+				service->add( stdOutFd, mBufferSize, [this]( const char* bytes, size_t n ) {
+					if ( !mShuttingDown && mReadStdOutFn )
+						mReadStdOutFn( bytes, n );
+				} );
+		}
+		if ( stdErrFd && stdOutFd != stdErrFd ) {
+			mStdErrWatch =
+				service->add( stdErrFd, mBufferSize, [this]( const char* bytes, size_t n ) {
+					if ( !mShuttingDown && mReadStdErrFn )
+						mReadStdErrFn( bytes, n );
+				} );
+		}
+		return;
+	}
+
 	mStdOutThread = std::thread( [this] {
 		auto stdOutFd = fileno( PROCESS_PTR->stdout_file );
 		auto stdErrFd = PROCESS_PTR->stderr_file ? fileno( PROCESS_PTR->stderr_file ) : 0;
@@ -390,4 +416,13 @@ void Process::startAsyncRead( ReadFn readStdOut, ReadFn readStdErr ) {
 #endif
 }
 
+void Process::stopSharedRead() {
+	if ( mStdOutWatch == 0 && mStdErrWatch == 0 )
+		return;
+	// Must be done before the pipes are closed
+	ProcessIOService::instance()->remove( mStdOutWatch );
+	ProcessIOService::instance()->remove( mStdErrWatch );
+	mStdOutWatch = mStdErrWatch = 0;
+}
+
 }} // namespace EE::System
@@ -0,0 +1,292 @@
+#include <eepp/system/processioservice.hpp>
+#include <eepp/system/sys.hpp>
+#include <vector>
+
+#ifdef EE_PLATFORM_POSIX
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#if EE_PLATFORM == EE_PLATFORM_LINUX || EE_PLATFORM == EE_PLATFORM_ANDROID
+#include <sys/epoll.h>
+#define EE_PROCESS_IO_EPOLL
+#endif
+#endif
+
+namespace EE { namespace System {
+
+/* Reads of the same pipe done before giving the turn to the other pipes */
+static constexpr int MAX_READS_PER_DISPATCH = 16;
+
+ProcessIOService* ProcessIOService::instance() {
+	static ProcessIOService sInstance;
+	return &sInstance;
+}
+
+bool ProcessIOService::isSupported() {
+#if defined( EE_PLATFORM_POSIX ) && EE_PLATFORM != EE_PLATFORM_EMSCRIPTEN
+	return true;
+#else
+	return false;
+#endif
+}
+
+#if defined( EE_PLATFORM_POSIX ) && EE_PLATFORM != EE_PLATFORM_EMSCRIPTEN
+
+static bool setNonBlocking( int fd ) {
+	int flags = fcntl( fd, F_GETFL );
+	return flags != -1 && fcntl( fd, F_SETFL, flags | O_NONBLOCK ) == 0;
+}
+
+ProcessIOService::ProcessIOService() {
+	if ( pipe( mWakeFd ) != 0 ) {
+		mWakeFd[0] = mWakeFd[1] = -1;
+		return;
+	}
+	for ( int fd : mWakeFd ) {
+		setNonBlocking( fd );
+		fcntl( fd, F_SETFD, FD_CLOEXEC );
+	}
+
+#ifdef EE_PROCESS_IO_EPOLL
+	mPollFd = epoll_create1( EPOLL_CLOEXEC );
+	if ( mPollFd == -1 )
+		return;
+	epoll_event ev{};
+	ev.events = EPOLLIN;
+	ev.data.u64 = 0;
+	if ( epoll_ctl( mPollFd, EPOLL_CTL_ADD, mWakeFd[0], &ev ) != 0 )
+		return;
+#endif
+
+	mPool = ThreadPool::createUnique( eemax( 2, eemin( 4, Sys::getCPUCount() ) ) );
+	mRunning = true;
+	mThread = std::thread( &ProcessIOService::run, this );
+}
+
+ProcessIOService::~ProcessIOService() {
+	if ( mRunning ) {
+		mRunning = false;
+		wake();
+		mThread.join();
+	}
+	// Waits for the reads in progress
+	mPool.reset();
+	if ( mPollFd != -1 )
+		close( mPollFd );
+	for ( int fd : mWakeFd ) {
+		if ( fd != -1 )
+			close( fd );
+	}
+}
+
+Uint64 ProcessIOService::add( int fd, size_t bufferSize, ReadFn readFn ) {
+	if ( !mRunning || fd < 0 || !readFn || bufferSize == 0 || !setNonBlocking( fd ) )
+		return 0;
+
+	auto watch = std::make_shared<Watch>();
+	watch->fd = fd;
+	watch->readFn = std::move( readFn );
+	// One extra byte to always NUL terminate the data
+	watch->buffer.resize( bufferSize + 1 );
+
+	std::unique_lock<std::mutex> lock( mMutex );
+	watch->id = ++mLastId;
+	if ( !this->watch( *watch, true ) )
+		return 0;
+	mWatches[watch->id] = watch;
+	lock.unlock();
+#ifndef EE_PROCESS_IO_EPOLL
+	wake();
+#endif
+	return watch->id;
+}
+
+void ProcessIOService::remove( Uint64 id ) {
+	std::unique_lock<std::mutex> lock( mMutex );
+	auto found = mWatches.find( id );
+	if ( found == mWatches.end() )
+		return;
+	std::shared_ptr<Watch> watch = found->second;
+	mWatches.erase( found );
+	watch->removed = true;
+	unwatch( *watch );
+	mReadDone.wait( lock, [&watch] { return !watch->reading; } );
+#ifndef EE_PROCESS_IO_EPOLL
+	lock.unlock();
+	wake();
+#endif
+}
+
+size_t ProcessIOService::count() {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mWatches.size();
+}
+
+void ProcessIOService::wake() {
+	char c = 0;
+	while ( ::write( mWakeFd[1], &c, 1 ) == -1 && errno == EINTR )
+		;
+}
+
+bool ProcessIOService::watch( const Watch& watch, bool add ) {
+#ifdef EE_PROCESS_IO_EPOLL
+	// One shot: the pipe is not reported again until the read task re-arms it
+	epoll_event ev{};
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	ev.data.u64 = watch.id;
+	return epoll_ctl( mPollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, watch.fd, &ev ) == 0;
+#else
+	// The poll loop rebuilds its set after every change
+	return true;
+#endif
+}
+
+void ProcessIOService::unwatch( const Watch& watch ) {
+#ifdef EE_PROCESS_IO_EPOLL
+	epoll_ctl( mPollFd, EPOLL_CTL_DEL, watch.fd, nullptr );
+#endif
+}
+
+void ProcessIOService::dispatch( Uint64 id ) {
+	std::shared_ptr<Watch> watch;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		auto found = mWatches.find( id );
+		if ( found == mWatches.end() || found->second->reading )
+			return;
+		watch = found->second;
+		watch->reading = true;
+	}
+	mPool->run( [this, watch] { read( watch ); } );
+}
+
+void ProcessIOService::read( const std::shared_ptr<Watch>& watch ) {
+	const size_t size = watch->buffer.size() - 1;
+	bool closed = false;
+
+	for ( int i = 0; i < MAX_READS_PER_DISPATCH && !watch->removed; ++i ) {
+		const ssize_t n = ::read( watch->fd, &watch->buffer[0], size );
+		if ( n > 0 ) {
+			watch->buffer[n] = '\0';
+			watch->readFn( watch->buffer.c_str(), static_cast<size_t>( n ) );
+			if ( static_cast<size_t>( n ) < size )
+				break;
+		} else if ( n == 0 || ( errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK ) ) {
+			closed = true;
+			break;
+		} else if ( errno != EINTR ) {
+			break;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		watch->reading = false;
+		if ( !watch->removed ) {
+			if ( closed || !this->watch( *watch, false ) ) {
+				watch->removed = true;
+				mWatches.erase( watch->id );
+				unwatch( *watch );
+			}
+		}
+	}
+	mReadDone.notify_all();
+
+#ifndef EE_PROCESS_IO_EPOLL
+	wake();
+#endif
+}
+
+void ProcessIOService::run() {
+#ifdef EE_PROCESS_IO_EPOLL
+	std::vector<epoll_event> events( 64 );
+	while ( mRunning ) {
+		int res = epoll_wait( mPollFd, events.data(), static_cast<int>( events.size() ), -1 );
+		if ( res < 0 ) {
+			if ( errno == EINTR )
+				continue;
+			break;
+		}
+		for ( int i = 0; i < res; ++i ) {
+			if ( events[i].data.u64 == 0 ) {
+				char buf[64];
+				while ( ::read( mWakeFd[0], buf, sizeof( buf ) ) > 0 )
+					;
+			} else {
+				dispatch( events[i].data.u64 );
+			}
+		}
+	}
+#else
+	std::vector<pollfd> pollfds;
+	std::vector<Uint64> ids;
+	while ( mRunning ) {
+		pollfds.clear();
+		ids.clear();
+		pollfds.push_back( { mWakeFd[0], POLLIN, 0 } );
+		ids.push_back( 0 );
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			for ( const auto& watch : mWatches ) {
+				if ( watch.second->reading )
+					continue;
+				pollfds.push_back( { watch.second->fd, POLLIN, 0 } );
+				ids.push_back( watch.first );
+			}
+		}
+
+		int res = poll( pollfds.data(), static_cast<nfds_t>( pollfds.size() ), -1 );
+		if ( res < 0 ) {
+			if ( errno == EINTR )
+				continue;
+			break;
+		}
+		for ( size_t i = 0; i < pollfds.size(); ++i ) {
+			if ( pollfds[i].revents == 0 )
+				continue;
+			if ( ids[i] == 0 ) {
+				char buf[64];
+				while ( ::read( mWakeFd[0], buf, sizeof( buf ) ) > 0 )
+					;
+			} else {
+				dispatch( ids[i] );
+			}
+		}
+	}
+#endif
+}
+
+#else
+
+ProcessIOService::ProcessIOService() {}
+
+ProcessIOService::~ProcessIOService() {}
+
+Uint64 ProcessIOService::add( int, size_t, ReadFn ) {
+	return 0;
+}
+
+void ProcessIOService::remove( Uint64 ) {}
+
+size_t ProcessIOService::count() {
+	return 0;
+}
+
+void ProcessIOService::wake() {}
+
+bool ProcessIOService::watch( const Watch&, bool ) {
+	return false;
+}
+
+void ProcessIOService::unwatch( const Watch& ) {}
+
+void ProcessIOService::dispatch( Uint64 ) {}
+
+void ProcessIOService::read( const std::shared_ptr<Watch>& ) {}
+
+void ProcessIOService::run() {}
+
+#endif
+
+}} // namespace EE::System
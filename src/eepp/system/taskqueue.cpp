@@ -0,0 +1,60 @@
+#include <eepp/system/clock.hpp>
+#include <eepp/system/taskqueue.hpp>
+
+namespace EE { namespace System {
+
+std::shared_ptr<TaskQueue> TaskQueue::New() {
+	return std::make_shared<TaskQueue>();
+}
+
+void TaskQueue::post( TaskFunction&& func ) {
+	std::lock_guard<std::mutex> lock( mMutex );
+	mQueue.emplace_back( std::move( func ) );
+}
+
+size_t TaskQueue::process( const Time& budget ) {
+	Clock clock;
+	size_t count = 0;
+	// Only the functions queued before the call run, the ones they post wait for the next one
+	size_t pending = size();
+
+	while ( count < pending ) {
+		TaskFunction func;
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			if ( mQueue.empty() )
+				break;
+			func = std::move( mQueue.front() );
+			mQueue.pop_front();
+		}
+
+		func();
+		count++;
+
+		if ( budget != Time::Zero && clock.getElapsedTime() >= budget )
+			break;
+	}
+
+	return count;
+}
+
+void TaskQueue::clear() {
+	std::deque<TaskFunction> queue;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		queue.swap( mQueue );
+	}
+	// Destroyed out of the lock, the functions could post new ones when destroyed
+}
+
+size_t TaskQueue::size() const {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mQueue.size();
+}
+
+bool TaskQueue::empty() const {
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mQueue.empty();
+}
+
+}} // namespace EE::System
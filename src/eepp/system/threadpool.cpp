@@ -3,6 +3,59 @@
 
 namespace EE { namespace System {
 
+/* the pool and the queue of the current worker thread */
+static thread_local ThreadPool* sWorkerPool = nullptr;
+static thread_local size_t sWorkerIndex = 0;
+
+bool TaskState::cancel() {
+	mCancelRequested.store( true, std::memory_order_release );
+	Status expected = Queued;
+	if ( !mStatus.compare_exchange_strong( expected, Cancelled ) )
+		return false;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+	}
+	mFinished.notify_all();
+	return true;
+}
+
+void TaskState::finish( Status status ) {
+	mStatus.store( status, std::memory_order_release );
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+	}
+	mFinished.notify_all();
+}
+
+bool TaskHandle::isQueued() const {
+	return mState && mState->getStatus() == TaskState::Queued;
+}
+
+bool TaskHandle::isDone() const {
+	if ( !mState )
+		return true;
+	auto status = mState->getStatus();
+	return status == TaskState::Done || status == TaskState::Cancelled;
+}
+
+bool TaskHandle::isCancelled() const {
+	return mState && mState->getStatus() == TaskState::Cancelled;
+}
+
+bool TaskHandle::cancel() {
+	return mState && mState->cancel();
+}
+
+void TaskHandle::wait() const {
+	if ( !mState )
+		return;
+	std::unique_lock<std::mutex> lock( mState->mMutex );
+	mState->mFinished.wait( lock, [this] {
+		auto status = mState->getStatus();
+		return status == TaskState::Done || status == TaskState::Cancelled;
+	} );
+}
+
 std::shared_ptr<ThreadPool> ThreadPool::createShared( Uint32 numThreads, bool terminateOnClose ) {
 	std::shared_ptr<ThreadPool> pool( new ThreadPool( numThreads, terminateOnClose ) );
 	return pool;
@@ -19,15 +72,18 @@ ThreadPool* ThreadPool::createRaw( Uint32 numThreads, bool terminateOnClose ) {
 
 ThreadPool::ThreadPool( Uint32 numThreads, bool terminateOnClose ) :
 	mTerminateOnClose( terminateOnClose ) {
+	for ( Uint32 i = 0; i < eemax<Uint32>( 1, numThreads ); ++i )
+		mQueues.emplace_back( std::make_unique<Queue>() );
+
 	for ( Uint32 i = 0; i < numThreads; ++i ) {
-		mThreads.emplace_back( std::make_unique<Thread>( &ThreadPool::threadFunc, this ) );
+		mThreads.emplace_back( std::make_unique<Thread>( [this, i]() { threadFunc( i ); } ) );
 		mThreads.back()->launch();
 	}
 }
 
 ThreadPool::~ThreadPool() {
 	{
-		std::unique_lock<std::mutex> lock( mMutex );
+		std::unique_lock<std::mutex> lock( mSleepMutex );
 		mShuttingDown = true;
 	}
 
@@ -42,28 +98,122 @@ ThreadPool::~ThreadPool() {
 	}
 }
 
-void ThreadPool::threadFunc() {
+void ThreadPool::threadFunc( size_t index ) {
+	sWorkerPool = this;
+	sWorkerIndex = index;
+
+	Work work;
 	while ( true ) {
-		std::unique_ptr<Work> work;
-		{
-			std::unique_lock<std::mutex> lock( mMutex );
+		if ( pop( index, work ) ) {
+			execute( work );
+			continue;
+		}
 
-			mWorkAvailable.wait( lock, [this]() { return !mWork.empty() || mShuttingDown; } );
+		std::unique_lock<std::mutex> lock( mSleepMutex );
+		// Pairs with the check of mSleeping in push: either the pusher sees this worker
+		// sleeping and notifies it, or this worker sees the pending work
+		mSleeping++;
+		mWorkAvailable.wait( lock, [this]() { return mPending > 0 || mShuttingDown; } );
+		mSleeping--;
 
-			if ( mShuttingDown && mWork.empty() ) {
-				return;
-			}
+		if ( mShuttingDown && mPending == 0 )
+			return;
+	}
+}
 
-			work = std::move( mWork.front() );
-			mWork.pop_front();
-		}
+void ThreadPool::push( Work&& work, Priority priority ) {
+	if ( mShuttingDown ) {
+		// It will never run, so the handle must not wait for it
+		if ( work.state )
+			work.state->cancel();
+		return;
+	}
+
+	if ( work.state && work.state->mTag ) {
+		std::lock_guard<std::mutex> lock( mTagsMutex );
+		mTags[work.state->mTag].emplace_back( work.state );
+	}
+
+	size_t index = sWorkerPool == this ? sWorkerIndex : mNextQueue++ % mQueues.size();
+
+	// Counted before it's queued, so mPending never underflows when the work is taken
+	// right away by another worker
+	mPending++;
+	{
+		Queue& queue = *mQueues[index];
+		std::lock_guard<std::mutex> lock( queue.mutex );
+		queue.work[static_cast<size_t>( priority )].emplace_back( std::move( work ) );
+	}
 
-		work->func();
+	if ( mSleeping > 0 ) {
+		{
+			std::lock_guard<std::mutex> lock( mSleepMutex );
+		}
+		mWorkAvailable.notify_one();
+	}
+}
 
-		if ( work->callback != nullptr ) {
-			work->callback( work->id );
+bool ThreadPool::pop( size_t index, Work& work ) {
+	const size_t count = mQueues.size();
+	for ( size_t priority = 0; priority < PriorityCount; ++priority ) {
+		// The own queue first, then steal from the next ones
+		for ( size_t i = 0; i < count; ++i ) {
+			Queue& queue = *mQueues[( index + i ) % count];
+			std::lock_guard<std::mutex> lock( queue.mutex );
+			auto& deque = queue.work[priority];
+			if ( deque.empty() )
+				continue;
+			work = std::move( deque.front() );
+			deque.pop_front();
+			mPending--;
+			return true;
 		}
 	}
+	return false;
+}
+
+void ThreadPool::execute( Work& work ) {
+	bool cancelled = false;
+
+	if ( work.state ) {
+		TaskState::Status expected = TaskState::Queued;
+		cancelled = !work.state->mStatus.compare_exchange_strong( expected, TaskState::Running );
+	}
+
+	if ( !cancelled ) {
+		work.func();
+
+		if ( work.callback != nullptr )
+			work.callback( work.id );
+	}
+
+	if ( work.state ) {
+		untag( work.state );
+		if ( !cancelled )
+			work.state->finish( TaskState::Done );
+	}
+
+	// Release the captures now, not when the next work is taken
+	work.func.reset();
+	work.callback = nullptr;
+	work.state.reset();
+}
+
+void ThreadPool::untag( const std::shared_ptr<TaskState>& state ) {
+	if ( !state->mTag )
+		return;
+	std::lock_guard<std::mutex> lock( mTagsMutex );
+	auto found = mTags.find( state->mTag );
+	if ( found == mTags.end() )
+		return;
+	auto& states = found->second;
+	auto it = std::find( states.begin(), states.end(), state );
+	if ( it != states.end() ) {
+		*it = std::move( states.back() );
+		states.pop_back();
+	}
+	if ( states.empty() )
+		mTags.erase( found );
 }
 
 bool ThreadPool::terminateOnClose() const {
@@ -74,62 +224,103 @@ void ThreadPool::setTerminateOnClose( bool terminateOnClose ) {
 	mTerminateOnClose = terminateOnClose;
 }
 
+bool ThreadPool::isWorkerThread() const {
+	return sWorkerPool == this;
+}
+
+bool ThreadPool::isWorkerThreadOf( const ThreadPool* pool ) {
+	return sWorkerPool == pool;
+}
+
 bool ThreadPool::existsIdInQueue( const Uint64& id ) {
-	std::unique_lock<std::mutex> lock( mMutex );
-	return std::any_of( mWork.begin(), mWork.end(),
-						[id]( const std::unique_ptr<Work>& work ) { return work->id == id; } );
+	for ( auto& queue : mQueues ) {
+		std::lock_guard<std::mutex> lock( queue->mutex );
+		for ( const auto& deque : queue->work ) {
+			for ( const auto& work : deque ) {
+				if ( work.id == id )
+					return !work.state || work.state->getStatus() == TaskState::Queued;
+			}
+		}
+	}
+	return false;
 }
 
 bool ThreadPool::existsTagInQueue( const Uint64& tag ) {
-	std::unique_lock<std::mutex> lock( mMutex );
-	return std::any_of( mWork.begin(), mWork.end(),
-						[tag]( const std::unique_ptr<Work>& work ) { return work->tag == tag; } );
+	std::lock_guard<std::mutex> lock( mTagsMutex );
+	auto found = mTags.find( tag );
+	if ( found == mTags.end() )
+		return false;
+	return std::any_of( found->second.begin(), found->second.end(),
+						[]( const std::shared_ptr<TaskState>& state ) {
+							return state->getStatus() == TaskState::Queued;
+						} );
 }
 
 bool ThreadPool::removeId( const Uint64& id ) {
-	std::unique_lock<std::mutex> lock( mMutex );
-	for ( auto it = mWork.begin(); it != mWork.end(); ++it ) {
-		if ( it->get()->id == id ) {
-			mWork.erase( it );
-			return true;
+	std::shared_ptr<TaskState> state;
+	bool removed = false;
+	for ( auto& queue : mQueues ) {
+		std::lock_guard<std::mutex> lock( queue->mutex );
+		for ( auto& deque : queue->work ) {
+			for ( auto it = deque.begin(); it != deque.end(); ++it ) {
+				if ( it->id == id ) {
+					state = std::move( it->state );
+					deque.erase( it );
+					mPending--;
+					removed = true;
+					break;
+				}
+			}
+			if ( removed )
+				break;
 		}
+		if ( removed )
+			break;
 	}
-	return false;
+	if ( state ) {
+		untag( state );
+		return state->cancel();
+	}
+	return removed;
 }
 
 bool ThreadPool::removeWithTag( const Uint64& tag ) {
-	std::vector<Uint64> ids;
+	std::vector<std::shared_ptr<TaskState>> states;
 	{
-		std::unique_lock<std::mutex> lock( mMutex );
-		for ( const auto& work : mWork )
-			if ( work->tag == tag )
-				ids.emplace_back( work->id );
+		std::lock_guard<std::mutex> lock( mTagsMutex );
+		auto found = mTags.find( tag );
+		if ( found == mTags.end() )
+			return false;
+		states = found->second;
 	}
-	for ( const auto& id : ids )
-		removeId( id );
-	return !ids.empty();
+	// The cancelled work is dropped when a worker takes it
+	bool removed = false;
+	for ( const auto& state : states )
+		removed = state->cancel() || removed;
+	return removed;
 }
 
 Uint64 ThreadPool::run( const std::function<void()>& func,
 						const std::function<void( const Uint64& )>& doneCallback,
-						const Uint64& tag ) {
+						const Uint64& tag, Priority priority ) {
 	Uint64 id = ++mLastWorkId;
-	{
-		std::unique_lock<std::mutex> lock( mMutex );
 
-		if ( mShuttingDown )
-			return id;
+	if ( mShuttingDown )
+		return id;
 
-		mWork.emplace_back( new Work{ id, func, doneCallback, tag } );
+	std::shared_ptr<TaskState> state;
+	if ( tag != 0 ) {
+		state = std::make_shared<TaskState>();
+		state->mId = id;
+		state->mTag = tag;
 	}
 
-	mWorkAvailable.notify_one();
+	push( Work{ TaskFunction( func ), doneCallback, id, std::move( state ) }, priority );
 
 	return id;
 }
 
 Uint32 ThreadPool::numThreads() const {
-	std::unique_lock<std::mutex> lock( mMutex );
 	return mShuttingDown ? 0 : static_cast<Uint32>( mThreads.size() );
 }
 
@@ -40,7 +40,72 @@ const StyleSheetStyleVector& ElementDefinition::getStyles() const {
 	return mStyles;
 }
 
+const ElementDefinition::PropertyDelta&
+ElementDefinition::getDeltaFrom( const std::shared_ptr<ElementDefinition>& from ) {
+	auto it = mDeltas.find( from.get() );
+	Uint64 fromVersion = from ? from->mVersion : 0;
+
+	// The address could belong to a released definition
+	if ( it != mDeltas.end() && it->second.from.lock() == from &&
+		 it->second.fromVersion == fromVersion )
+		return it->second.delta;
+
+	if ( it == mDeltas.end() && mDeltas.size() >= 64 ) {
+		for ( auto cur = mDeltas.begin(); cur != mDeltas.end(); ) {
+			if ( cur->second.from.expired() && cur->first != nullptr )
+				cur = mDeltas.erase( cur );
+			else
+				++cur;
+		}
+	}
+
+	CachedDelta& cached = mDeltas[from.get()];
+	cached.from = from;
+	cached.fromVersion = fromVersion;
+	cached.delta = PropertyDelta();
+
+	PropertyDelta& delta = cached.delta;
+	delta.changed = mPropertyIds;
+
+	if ( !from )
+		return delta;
+
+	delta.changed |= from->getPropertyIds();
+
+	for ( Uint32 id : ( from->getPropertyIds() & mPropertyIds ) ) {
+		const StyleSheetProperty* p0 = from->getProperty( id );
+		const StyleSheetProperty* p1 = getProperty( id );
+
+		if ( nullptr != p0 && nullptr != p1 && *p0 == *p1 )
+			delta.changed.erase( id );
+	}
+
+	return delta;
+}
+
+const TransitionsMap& ElementDefinition::getTransitions() {
+	if ( !mTransitionsParsed ) {
+		mTransitions = TransitionDefinition::parseTransitionProperties( mTransitionProperties );
+		mTransitionsParsed = true;
+	}
+	return mTransitions;
+}
+
+const AnimationsMap& ElementDefinition::getAnimations() {
+	if ( !mAnimationsParsed ) {
+		mAnimations = AnimationDefinition::parseAnimationProperties( mAnimationProperties );
+		mAnimationsParsed = true;
+	}
+	return mAnimations;
+}
+
 void ElementDefinition::refresh() {
+	mVersion++;
+	mDeltas.clear();
+	mTransitions.clear();
+	mAnimations.clear();
+	mTransitionsParsed = false;
+	mAnimationsParsed = false;
 	mProperties.clear();
 	mTransitionProperties.clear();
 	mAnimationProperties.clear();
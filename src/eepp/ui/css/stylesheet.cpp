@@ -2,6 +2,7 @@
 #include <array>
 #include <eepp/system/log.hpp>
 #include <eepp/ui/css/stylesheet.hpp>
+#include <eepp/ui/css/stylesheetancestorfilter.hpp>
 #include <eepp/ui/css/stylesheetproperty.hpp>
 #include <eepp/ui/css/stylesheetselector.hpp>
 #include <eepp/ui/uiwidget.hpp>
@@ -12,9 +13,12 @@ StyleSheet::StyleSheet() {}
 
 void StyleSheet::clear() {
 	mVersion = 1;
+	mStyleCount = 0;
 	mMarker = 0;
 	mNodes.clear();
 	mNodeIndex.clear();
+	mClassIndex.clear();
+	mPseudoClassIndex.clear();
 	mMediaQueryList.clear();
 	mKeyframesMap.clear();
 	mNodeCache.clear();
@@ -56,6 +60,23 @@ void StyleSheet::setMarker( const Uint32& marker ) {
 		keyframes.second.setMarker( marker );
 }
 
+template <typename Index> static void removeStylesWithMarker( Index& index, const Uint32& marker ) {
+	std::vector<size_t> deprecatedNodeIndex;
+	for ( auto& nodeIndex : index ) {
+		auto& nodes = nodeIndex.second;
+		nodes.erase( std::remove_if( nodes.begin(), nodes.end(),
+									 [marker]( const auto& node ) {
+										 return node.style->getMarker() == marker;
+									 } ),
+					 nodes.end() );
+		if ( nodes.empty() )
+			deprecatedNodeIndex.emplace_back( nodeIndex.first );
+	}
+
+	for ( auto removeIndex : deprecatedNodeIndex )
+		index.erase( removeIndex );
+}
+
 void StyleSheet::removeAllWithMarker( const Uint32& marker ) {
 	std::vector<std::shared_ptr<StyleSheetStyle>> removeNodes;
 
@@ -63,26 +84,9 @@ void StyleSheet::removeAllWithMarker( const Uint32& marker ) {
 		if ( node->getMarker() == marker )
 			removeNodes.emplace_back( node );
 
-	std::vector<size_t> deprecatedNodeIndex;
-	for ( auto& nodeIndex : mNodeIndex ) {
-		std::vector<StyleSheetStyle*> removeNodesIndex;
-		for ( auto node : nodeIndex.second ) {
-			if ( node->getMarker() == marker ) {
-				removeNodesIndex.emplace_back( node );
-			}
-		}
-		for ( auto removeNodeIndex : removeNodesIndex ) {
-			auto found =
-				std::find( nodeIndex.second.begin(), nodeIndex.second.end(), removeNodeIndex );
-			if ( found != nodeIndex.second.end() )
-				nodeIndex.second.erase( found );
-		}
-		if ( nodeIndex.second.empty() )
-			deprecatedNodeIndex.emplace_back( nodeIndex.first );
-	}
-
-	for ( auto removeIndex : deprecatedNodeIndex )
-		mNodeIndex.erase( removeIndex );
+	removeStylesWithMarker( mNodeIndex, marker );
+	removeStylesWithMarker( mClassIndex, marker );
+	removeStylesWithMarker( mPseudoClassIndex, marker );
 
 	std::vector<MediaQueryList::ptr> removeMediaQueries;
 	for ( auto& mediaQueryList : mMediaQueryList ) {
@@ -161,8 +165,11 @@ const Uint64& StyleSheet::getVersion() const {
 StyleSheet& StyleSheet::operator=( const StyleSheet& other ) {
 	mVersion += other.mVersion; // Increase version since the original stylesheet changed
 	mMarker = other.mMarker;
+	mStyleCount = other.mStyleCount;
 	mNodes = other.mNodes;
 	mNodeIndex = other.mNodeIndex;
+	mClassIndex = other.mClassIndex;
+	mPseudoClassIndex = other.mPseudoClassIndex;
 	mMediaQueryList = other.mMediaQueryList;
 	mKeyframesMap = other.mKeyframesMap;
 	mNodeCache = other.mNodeCache;
@@ -170,19 +177,36 @@ StyleSheet& StyleSheet::operator=( const StyleSheet& other ) {
 }
 
 bool StyleSheet::addStyleToNodeIndex( StyleSheetStyle* style ) {
-	const std::string& id = style->getSelector().getSelectorId();
-	const std::string& tag = style->getSelector().getSelectorTagName();
-	if ( style->hasProperties() || style->hasVariables() ) {
-		size_t nodeHash = this->nodeHash( "*" == tag ? "" : tag, id );
-		StyleSheetStyleVector& nodes = mNodeIndex[nodeHash];
-		auto it = std::find( nodes.begin(), nodes.end(), style );
-		if ( it == nodes.end() ) {
-			nodes.push_back( style );
-			return true;
-		} else {
-			Log::debug( "Ignored style %s", style->getSelector().getName().c_str() );
-		}
+	if ( !style->hasProperties() && !style->hasVariables() )
+		return false;
+
+	const StyleSheetSelector& selector = style->getSelector();
+	const std::string& id = selector.getSelectorId();
+	const std::string& tag = selector.getSelectorTagName();
+	const std::vector<std::string>& classes = selector.getSelectorClasses();
+	const std::vector<std::string>& pseudoClasses = selector.getSelectorPseudoClasses();
+	std::vector<IndexedStyle>* nodes;
+
+	if ( !id.empty() || ( !tag.empty() && "*" != tag ) ) {
+		nodes = &mNodeIndex[nodeHash( "*" == tag ? "" : tag, id )];
+	} else if ( tag.empty() && !classes.empty() ) {
+		nodes = &mClassIndex[std::hash<std::string>()( classes[0] )];
+	} else if ( classes.empty() && !pseudoClasses.empty() ) {
+		nodes = &mPseudoClassIndex[std::hash<std::string>()( pseudoClasses[0] )];
+	} else {
+		nodes = &mNodeIndex[0];
+	}
+
+	auto it = std::find_if( nodes->begin(), nodes->end(), [style]( const IndexedStyle& node ) {
+		return node.style == style;
+	} );
+
+	if ( it == nodes->end() ) {
+		nodes->push_back( { style, mStyleCount++ } );
+		return true;
 	}
+
+	Log::debug( "Ignored style %s", selector.getName().c_str() );
 	return false;
 }
 
@@ -227,18 +251,40 @@ void StyleSheet::combineStyleSheet( const StyleSheet& styleSheet ) {
 	addKeyframes( styleSheet.getKeyframes() );
 }
 
-inline static bool StyleSheetNodeSort( const StyleSheetStyle* lhs, const StyleSheetStyle* rhs ) {
-	return lhs->getSelector().getSpecificity() < rhs->getSelector().getSpecificity();
+void StyleSheet::collectStyles( std::vector<IndexedStyle>& styles, const StyleIndex& index,
+								size_t hash, UIWidget* element, const bool& applyPseudo,
+								bool useAncestorFilter ) const {
+	auto itNodes = index.find( hash );
+	if ( itNodes == index.end() )
+		return;
+
+	for ( const IndexedStyle& node : itNodes->second ) {
+		const StyleSheetSelector& selector = node.style->getSelector();
+		if ( useAncestorFilter &&
+			 !StyleSheetAncestorFilter::mayContain( selector.getAncestorHashes() ) )
+			continue;
+		if ( node.style->isMediaValid() && selector.select( element, applyPseudo ) )
+			styles.push_back( node );
+	}
 }
 
 // This is based on the RmlUi implementation.
 std::shared_ptr<ElementDefinition> StyleSheet::getElementStyles( UIWidget* element,
 																 const bool& applyPseudo ) const {
-	static StyleSheetStyleVector applicableNodes;
+	static StyleSheetStyleVector applicableStyles;
+	matchElementStyles( element, applyPseudo, applicableStyles );
+	return getElementDefinition( applicableStyles );
+}
+
+void StyleSheet::matchElementStyles( UIWidget* element, const bool& applyPseudo,
+									 StyleSheetStyleVector& styles ) const {
+	static thread_local std::vector<IndexedStyle> applicableNodes;
 	applicableNodes.clear();
+	styles.clear();
 
 	const std::string& tag = element->getElementTag();
 	const std::string& id = element->getId();
+	bool useAncestorFilter = StyleSheetAncestorFilter::isActiveFor( element );
 
 	std::array<size_t, 4> nodeHash;
 	int numHashes = 2;
@@ -252,25 +298,55 @@ std::shared_ptr<ElementDefinition> StyleSheet::getElementStyles( UIWidget* eleme
 		nodeHash[3] = this->nodeHash( tag, id );
 	}
 
-	for ( int i = 0; i < numHashes; i++ ) {
-		auto itNodes = mNodeIndex.find( nodeHash[i] );
-		if ( itNodes != mNodeIndex.end() ) {
-			const StyleSheetStyleVector& nodes = itNodes->second;
-			for ( StyleSheetStyle* node : nodes ) {
-				if ( node->isMediaValid() && node->getSelector().select( element, applyPseudo ) ) {
-					applicableNodes.push_back( node );
-				}
-			}
+	for ( int i = 0; i < numHashes; i++ )
+		collectStyles( applicableNodes, mNodeIndex, nodeHash[i], element, applyPseudo,
+					   useAncestorFilter );
+
+	if ( !mClassIndex.empty() ) {
+		const std::vector<std::string>& classes = element->getStyleSheetClasses();
+		for ( size_t i = 0; i < classes.size(); i++ ) {
+			if ( std::find( classes.begin(), classes.begin() + i, classes[i] ) !=
+				 classes.begin() + i )
+				continue;
+			collectStyles( applicableNodes, mClassIndex, std::hash<std::string>()( classes[i] ),
+						   element, applyPseudo, useAncestorFilter );
+		}
+	}
+
+	if ( !mPseudoClassIndex.empty() ) {
+		// Without the pseudo-classes applied any of them can match
+		if ( applyPseudo ) {
+			for ( const auto& pseudoClass : element->getStyleSheetPseudoClasses() )
+				collectStyles( applicableNodes, mPseudoClassIndex,
+							   std::hash<std::string>()( pseudoClass ), element, applyPseudo,
+							   useAncestorFilter );
+		} else {
+			for ( const auto& nodes : mPseudoClassIndex )
+				collectStyles( applicableNodes, mPseudoClassIndex, nodes.first, element,
+							   applyPseudo, useAncestorFilter );
 		}
 	}
 
-	std::sort( applicableNodes.begin(), applicableNodes.end(), StyleSheetNodeSort );
+	std::sort( applicableNodes.begin(), applicableNodes.end(),
+			   []( const IndexedStyle& lhs, const IndexedStyle& rhs ) {
+				   Uint32 lhsSpecificity = lhs.style->getSelector().getSpecificity();
+				   Uint32 rhsSpecificity = rhs.style->getSelector().getSpecificity();
+				   if ( lhsSpecificity != rhsSpecificity )
+					   return lhsSpecificity < rhsSpecificity;
+				   return lhs.order < rhs.order;
+			   } );
+
+	for ( const IndexedStyle& node : applicableNodes )
+		styles.push_back( node.style );
+}
 
-	if ( applicableNodes.empty() )
+std::shared_ptr<ElementDefinition>
+StyleSheet::getElementDefinition( const StyleSheetStyleVector& styles ) const {
+	if ( styles.empty() )
 		return nullptr;
 
 	size_t seed = 0;
-	for ( const StyleSheetStyle* node : applicableNodes )
+	for ( const StyleSheetStyle* node : styles )
 		HashCombine( seed, node );
 
 	auto cacheIterator = mNodeCache.find( seed );
@@ -279,7 +355,7 @@ std::shared_ptr<ElementDefinition> StyleSheet::getElementStyles( UIWidget* eleme
 		return definition;
 	}
 
-	auto newDefinition = std::make_shared<ElementDefinition>( applicableNodes );
+	auto newDefinition = std::make_shared<ElementDefinition>( styles );
 	mNodeCache[seed] = newDefinition;
 
 	return newDefinition;
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <array>
+#include <eepp/ui/css/stylesheetancestorfilter.hpp>
+#include <eepp/ui/uiwidget.hpp>
+
+namespace EE { namespace UI { namespace CSS {
+
+static constexpr Uint32 FILTER_BITS = 12;
+static constexpr Uint32 FILTER_SIZE = 1 << FILTER_BITS;
+static constexpr Uint32 FILTER_MASK = FILTER_SIZE - 1;
+static constexpr Uint8 FILTER_SATURATED = 0xFF;
+
+struct StyleSheetAncestorFilter::State {
+	std::vector<UIWidget*> elements;
+	std::vector<size_t> offsets;
+	std::vector<Uint32> hashes;
+	std::array<Uint8, FILTER_SIZE> counters{};
+
+	void add( Uint32 hash ) {
+		hashes.push_back( hash );
+		for ( Uint32 index : { hash & FILTER_MASK, ( hash >> FILTER_BITS ) & FILTER_MASK } ) {
+			// A saturated counter stays saturated, it only adds false positives
+			if ( counters[index] != FILTER_SATURATED )
+				counters[index]++;
+		}
+	}
+
+	void push( UIWidget* element ) {
+		elements.push_back( element );
+		offsets.push_back( hashes.size() );
+		add( hash( Tag, element->getElementTag() ) );
+		if ( !element->getId().empty() )
+			add( hash( Id, element->getId() ) );
+		for ( const auto& cls : element->getStyleSheetClasses() )
+			add( hash( Class, cls ) );
+	}
+
+	void pop() {
+		for ( size_t i = offsets.back(); i < hashes.size(); ++i ) {
+			Uint32 hash = hashes[i];
+			for ( Uint32 index : { hash & FILTER_MASK, ( hash >> FILTER_BITS ) & FILTER_MASK } ) {
+				if ( counters[index] != FILTER_SATURATED )
+					counters[index]--;
+			}
+		}
+		hashes.resize( offsets.back() );
+		offsets.pop_back();
+		elements.pop_back();
+	}
+
+	void clear() {
+		elements.clear();
+		offsets.clear();
+		hashes.clear();
+		counters.fill( 0 );
+	}
+};
+
+StyleSheetAncestorFilter::State& StyleSheetAncestorFilter::getState() {
+	// Per thread, the widgets matched from other threads never see the traversal state
+	static thread_local StyleSheetAncestorFilter::State state;
+	return state;
+}
+
+StyleSheetAncestorFilter::Scope::Scope( UIWidget* element ) {
+	State& state = getState();
+	UIWidget* parent = element->getStyleSheetParentElement();
+
+	if ( state.elements.empty() || state.elements.back() != parent ) {
+		mRoot = true;
+
+		if ( !state.elements.empty() )
+			mSaved = std::make_unique<State>( std::move( state ) );
+
+		state.clear();
+
+		std::vector<UIWidget*> ancestors;
+		for ( UIWidget* ancestor = parent; NULL != ancestor;
+			  ancestor = ancestor->getStyleSheetParentElement() )
+			ancestors.push_back( ancestor );
+
+		for ( auto it = ancestors.rbegin(); it != ancestors.rend(); ++it )
+			state.push( *it );
+	}
+
+	state.push( element );
+}
+
+StyleSheetAncestorFilter::Scope::~Scope() {
+	State& state = getState();
+
+	if ( !mRoot ) {
+		state.pop();
+	} else if ( mSaved ) {
+		state = std::move( *mSaved );
+	} else {
+		state.clear();
+	}
+}
+
+Uint32 StyleSheetAncestorFilter::hash( Kind kind, const std::string& value ) {
+	Uint32 hash = String::hash( value ) ^ ( ( kind + 1 ) * 0x9E3779B9u );
+	hash *= 0x85EBCA6Bu;
+	return hash ^ ( hash >> 16 );
+}
+
+bool StyleSheetAncestorFilter::isActiveFor( const UIWidget* element ) {
+	const State& state = getState();
+	return !state.elements.empty() &&
+		   state.elements.back() == element->getStyleSheetParentElement();
+}
+
+bool StyleSheetAncestorFilter::mayContain( const std::vector<Uint32>& hashes ) {
+	const State& state = getState();
+	for ( Uint32 hash : hashes ) {
+		if ( 0 == state.counters[hash & FILTER_MASK] ||
+			 0 == state.counters[( hash >> FILTER_BITS ) & FILTER_MASK] )
+			return false;
+	}
+	return true;
+}
+
+}}} // namespace EE::UI::CSS
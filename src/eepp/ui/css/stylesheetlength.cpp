@@ -296,12 +296,17 @@ StyleSheetLength& StyleSheetLength::operator=( const StyleSheetLength& val ) {
 }
 
 StyleSheetLength StyleSheetLength::fromString( const std::string& str, const Float& defaultValue ) {
+	StyleSheetLength length;
+	if ( !parse( str, length ) )
+		length.setValue( defaultValue, Unit::Px );
+	return length;
+}
+
+bool StyleSheetLength::parse( const std::string& str, StyleSheetLength& length ) {
 	PercentagePositions isPercentage = isPercentagePosition( String::hash( str ) );
 	if ( PercentagePositions::None != isPercentage )
-		return fromString( positionToPercentage( isPercentage ), defaultValue );
+		return parse( positionToPercentage( isPercentage ), length );
 
-	StyleSheetLength length;
-	length.setValue( defaultValue, Unit::Px );
 	std::string num;
 	std::string unit;
 
@@ -315,13 +320,12 @@ StyleSheetLength StyleSheetLength::fromString( const std::string& str, const Flo
 		}
 	}
 
-	if ( !num.empty() ) {
-		Float val = 0;
-		if ( String::fromString<Float>( val, num ) )
-			length.setValue( val, unitFromString( unit ) );
-	}
+	Float val = 0;
+	if ( num.empty() || !String::fromString<Float>( val, num ) )
+		return false;
 
-	return length;
+	length.setValue( val, unitFromString( unit ) );
+	return true;
 }
 
 std::string StyleSheetLength::toString() const {
@@ -15,7 +15,12 @@
 namespace EE { namespace UI { namespace CSS {
 
 StyleSheetProperty::StyleSheetProperty() :
-	mSpecificity( 0 ), mVolatile( false ), mImportant( false ) {}
+	mSpecificity( 0 ),
+	mVolatile( false ),
+	mImportant( false ),
+	mIsVarValue( false ),
+	mPropertyDefinition( NULL ),
+	mShorthandDefinition( NULL ) {}
 
 StyleSheetProperty::StyleSheetProperty( const PropertyDefinition* definition,
 										const std::string& value, const Uint32& index,
@@ -36,6 +41,7 @@ StyleSheetProperty::StyleSheetProperty( const PropertyDefinition* definition,
 	checkImportant();
 	createIndexed();
 	checkVars();
+	parseValue();
 
 	if ( NULL == mShorthandDefinition && NULL == mPropertyDefinition ) {
 		Log::warning( "Property \"%s\" is not defined!", mName.c_str() );
@@ -60,6 +66,7 @@ StyleSheetProperty::StyleSheetProperty( const bool& isVolatile,
 	cleanValue();
 	checkImportant();
 	checkVars();
+	parseValue();
 
 	if ( NULL == mShorthandDefinition && NULL == mPropertyDefinition ) {
 		Log::warning( "Property \"%s\" is not defined!", mName.c_str() );
@@ -86,6 +93,7 @@ StyleSheetProperty::StyleSheetProperty( const std::string& name, const std::stri
 	checkImportant();
 	createIndexed();
 	checkVars();
+	parseValue();
 
 	if ( NULL == mShorthandDefinition && NULL == mPropertyDefinition ) {
 		Log::warning( "Property \"%s\" is not defined!", mName.c_str() );
@@ -112,6 +120,7 @@ StyleSheetProperty::StyleSheetProperty( const std::string& name, const std::stri
 	checkImportant();
 	createIndexed();
 	checkVars();
+	parseValue();
 
 	if ( NULL == mShorthandDefinition && NULL == mPropertyDefinition ) {
 		Log::warning( "Property \"%s\" is not defined!" );
@@ -162,6 +171,7 @@ void StyleSheetProperty::setValue( const std::string& value, bool updateHash ) {
 	if ( updateHash )
 		mValueHash = String::hash( value );
 	mIsVarValue = String::startsWith( mValue, "var(" );
+	parseValue();
 	createIndexed();
 }
 
@@ -298,6 +308,8 @@ bool StyleSheetProperty::asBool( bool defaultValue ) const {
 }
 
 Color StyleSheetProperty::asColor() const {
+	if ( ParsedType::Color == mParsedType )
+		return Color( mParsedValue.color );
 	return Color::fromString( mValue );
 }
 
@@ -521,6 +533,9 @@ Uint32 StyleSheetProperty::asFontStyle() const {
 }
 
 Time StyleSheetProperty::asTime( const Time& defaultTime ) {
+	if ( ParsedType::Time == mParsedType )
+		return Microseconds( mParsedValue.time );
+
 	if ( !mValue.empty() ) {
 		return Time::fromString( mValue );
 	}
@@ -563,6 +578,44 @@ const Uint32& StyleSheetProperty::getIndex() const {
 	return mIndex;
 }
 
+void StyleSheetProperty::parseValue() {
+	mParsedType = ParsedType::None;
+
+	if ( NULL == mPropertyDefinition || mIsVarValue || mValue.empty() ||
+		 mValue.find( "var(" ) != std::string::npos )
+		return;
+
+	switch ( mPropertyDefinition->getType() ) {
+		case PropertyType::Color: {
+			// Named colors can be registered at any moment, only the literal ones are kept
+			if ( '#' == mValue[0] || mValue.find( '(' ) != std::string::npos ) {
+				mParsedValue.color = Color::fromString( mValue ).getValue();
+				mParsedType = ParsedType::Color;
+			}
+			break;
+		}
+		case PropertyType::NumberLength:
+		case PropertyType::NumberLengthFixed:
+		case PropertyType::RadiusLength: {
+			StyleSheetLength length;
+			if ( mValue.find( ' ' ) == std::string::npos &&
+				 StyleSheetLength::parse( mValue, length ) ) {
+				mParsedValue.length.value = length.getValue();
+				mParsedValue.length.unit = length.getUnit();
+				mParsedType = ParsedType::Length;
+			}
+			break;
+		}
+		case PropertyType::Time: {
+			mParsedValue.time = Time::fromString( mValue ).asMicroseconds();
+			mParsedType = ParsedType::Time;
+			break;
+		}
+		default:
+			break;
+	}
+}
+
 void StyleSheetProperty::cleanValue() {
 	if ( NULL != mPropertyDefinition && mPropertyDefinition->getType() == PropertyType::String ) {
 		String::trimInPlace( mValue, '"' );
@@ -659,7 +712,15 @@ Sizei StyleSheetProperty::asSizei( UINode* node, const Sizei& defaultValue ) con
 }
 
 StyleSheetLength StyleSheetProperty::asStyleSheetLength() const {
-	return StyleSheetLength( mValue );
+	return isParsedLength() ? getParsedLength() : StyleSheetLength( mValue );
+}
+
+bool StyleSheetProperty::isParsedLength() const {
+	return ParsedType::Length == mParsedType;
+}
+
+StyleSheetLength StyleSheetProperty::getParsedLength() const {
+	return StyleSheetLength( mParsedValue.length.value, mParsedValue.length.unit );
 }
 
 const String::HashType& StyleSheetProperty::getValueHash() const {
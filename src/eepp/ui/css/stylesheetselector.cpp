@@ -1,3 +1,4 @@
+#include <eepp/ui/css/stylesheetancestorfilter.hpp>
 #include <eepp/ui/css/stylesheetselector.hpp>
 #include <eepp/ui/uiwidget.hpp>
 
@@ -106,6 +107,30 @@ void StyleSheetSelector::parseSelector( std::string selector ) {
 				}
 			}
 		}
+
+		// The descendant and child rules always match an ancestor of the selected element.
+		// The universal tag is skipped since it matches anything when the pseudo-classes are
+		// not applied.
+		for ( size_t i = 1; i < mSelectorRules.size(); i++ ) {
+			const StyleSheetSelectorRule& rule = mSelectorRules[i];
+
+			if ( ( rule.getPatternMatch() != StyleSheetSelectorRule::DESCENDANT &&
+				   rule.getPatternMatch() != StyleSheetSelectorRule::CHILD ) ||
+				 rule.getTagName() == "*" )
+				continue;
+
+			if ( !rule.getTagName().empty() )
+				mAncestorHashes.push_back( StyleSheetAncestorFilter::hash(
+					StyleSheetAncestorFilter::Tag, rule.getTagName() ) );
+
+			if ( !rule.getId().empty() )
+				mAncestorHashes.push_back(
+					StyleSheetAncestorFilter::hash( StyleSheetAncestorFilter::Id, rule.getId() ) );
+
+			for ( const auto& cls : rule.getClasses() )
+				mAncestorHashes.push_back(
+					StyleSheetAncestorFilter::hash( StyleSheetAncestorFilter::Class, cls ) );
+		}
 	}
 }
 
@@ -347,4 +372,16 @@ const std::string& StyleSheetSelector::getSelectorTagName() const {
 	return mSelectorRules[0].getTagName();
 }
 
+const std::vector<std::string>& StyleSheetSelector::getSelectorClasses() const {
+	return mSelectorRules[0].getClasses();
+}
+
+const std::vector<std::string>& StyleSheetSelector::getSelectorPseudoClasses() const {
+	return mSelectorRules[0].getPseudoClasses();
+}
+
+const std::vector<Uint32>& StyleSheetSelector::getAncestorHashes() const {
+	return mAncestorHashes;
+}
+
 }}} // namespace EE::UI::CSS
@@ -204,6 +204,10 @@ bool StyleSheetSelectorRule::hasClass( const std::string& cls ) const {
 	return std::find( mClasses.begin(), mClasses.end(), cls ) != mClasses.end();
 }
 
+const std::vector<std::string>& StyleSheetSelectorRule::getClasses() const {
+	return mClasses;
+}
+
 bool StyleSheetSelectorRule::hasPseudoClasses() const {
 	return !mPseudoClasses.empty();
 }
@@ -14,6 +14,33 @@ using namespace EE::Scene;
 
 namespace EE { namespace UI { namespace Models {
 
+// Entries read between each insertion of the loaded children
+static constexpr size_t LOAD_BATCH_SIZE = 256;
+
+struct FileSystemModel::LoadRequest {
+	// Cleared when the node stops waiting for it, only accessed from the main thread
+	Node* node{ nullptr };
+	// The folders loaded so far, the next ones are inserted after them
+	size_t folders{ 0 };
+	// Set with the node cleared, stops the listing in the thread pool
+	std::atomic<bool> cancelled{ false };
+};
+
+// The children read in the thread pool, inserted from the main thread. The nodes left are the
+// ones of a load cancelled meanwhile.
+struct LoadBatch {
+	std::vector<FileSystemModel::Node*> folders;
+	std::vector<FileSystemModel::Node*> files;
+	bool done{ false };
+
+	~LoadBatch() {
+		for ( auto* child : folders )
+			eeDelete( child );
+		for ( auto* child : files )
+			eeDelete( child );
+	}
+};
+
 FileSystemModel::Node::Node( const std::string& rootPath, const FileSystemModel& model ) :
 	mInfo( FileSystem::getRealPath( rootPath ) ) {
 	mInfoDirty = false;
@@ -94,6 +121,7 @@ Int64 FileSystemModel::Node::findChildRowFromName( const std::string& name,
 }
 
 FileSystemModel::Node::~Node() {
+	cancelLoad();
 	cleanChildren();
 }
 
@@ -153,10 +181,31 @@ static bool isAcceptedExtension( const std::vector<std::string>& acceptedExtensi
 	return true;
 }
 
+static bool isFileVisible( const FileInfo& file, const FileSystemModel::Mode& mode,
+						   const FileSystemModel::DisplayConfig& displayCfg ) {
+	bool isFolder = file.isDirectory() || file.linksToDirectory();
+
+	if ( mode == FileSystemModel::Mode::DirectoriesOnly && !isFolder )
+		return false;
+
+	const auto& patterns = displayCfg.acceptedExtensions;
+
+	if ( isFolder || patterns.empty() )
+		return !displayCfg.fileIsVisibleFn || displayCfg.fileIsVisibleFn( file.getFilepath() );
+
+	return std::find( patterns.begin(), patterns.end(),
+					  FileSystem::fileExtension( file.getFilepath() ) ) != patterns.end();
+}
+
 void FileSystemModel::Node::refresh( const FileSystemModel& model ) {
 	if ( !mInfo.isDirectory() )
 		return;
 
+	if ( mLoading ) {
+		mLoadDirty = true;
+		return;
+	}
+
 	auto oldFiles = mChildren;
 
 	const auto& displayCfg = model.getDisplayConfig();
@@ -202,50 +251,35 @@ void FileSystemModel::Node::cleanChildren() {
 	mChildren.clear();
 }
 
+void FileSystemModel::Node::cancelLoad() {
+	if ( mLoadRequest ) {
+		mLoadRequest->node = nullptr;
+		mLoadRequest->cancelled = true;
+		mLoadRequest.reset();
+	}
+	mLoading = false;
+	mLoadDirty = false;
+}
+
 void FileSystemModel::Node::traverseIfNeeded( const FileSystemModel& model ) {
 	if ( !mInfo.isDirectory() || mHasTraversed )
 		return;
 	mHasTraversed = true;
+	cancelLoad();
 	cleanChildren();
 
+	// The root is listed synchronously, its rows are ready as soon as the root path is set
+	if ( nullptr != mParent && const_cast<FileSystemModel&>( model ).loadAsync( this ) )
+		return;
+
 	const auto& displayCfg = model.getDisplayConfig();
 
 	auto files = FileSystem::filesInfoGetInPath( mInfo.getFilepath(), false, displayCfg.sortByName,
 												 displayCfg.foldersFirst, displayCfg.ignoreHidden );
 
-	const auto& patterns = displayCfg.acceptedExtensions;
-	bool accepted;
 	for ( auto file : files ) {
-		if ( ( model.getMode() == Mode::DirectoriesOnly &&
-			   ( file.isDirectory() || file.linksToDirectory() ) ) ||
-			 model.getMode() == Mode::FilesAndDirectories ) {
-			if ( file.isDirectory() || file.linksToDirectory() || patterns.empty() ) {
-				if ( displayCfg.fileIsVisibleFn &&
-					 !displayCfg.fileIsVisibleFn( file.getFilepath() ) )
-					continue;
-				mChildren.emplace_back( eeNew( Node, ( std::move( file ), this ) ) );
-			} else {
-				accepted = false;
-				if ( patterns.size() ) {
-					for ( size_t z = 0; z < patterns.size(); z++ ) {
-						if ( patterns[z] == FileSystem::fileExtension( file.getFilepath() ) ) {
-							accepted = true;
-							break;
-						}
-					}
-				} else {
-					if ( displayCfg.fileIsVisibleFn ) {
-						if ( displayCfg.fileIsVisibleFn( file.getFilepath() ) )
-							accepted = true;
-					} else {
-						accepted = true;
-					}
-				}
-
-				if ( accepted )
-					mChildren.emplace_back( eeNew( Node, ( std::move( file ), this ) ) );
-			}
-		}
+		if ( isFileVisible( file, model.getMode(), displayCfg ) )
+			mChildren.emplace_back( eeNew( Node, ( std::move( file ), this ) ) );
 	}
 }
 
@@ -289,6 +323,9 @@ FileSystemModel::FileSystemModel( const std::string& rootPath, const FileSystemM
 	mRoot = std::make_unique<Node>( mRootPath, *this );
 	mInitOK = true;
 	setupColumnNames( translator );
+	mLoadingText = translator
+					   ? translator->getString( "filesystemmodel_loading", "Loading..." ).toUtf8()
+					   : "Loading...";
 	invalidate();
 }
 
@@ -356,7 +393,10 @@ void FileSystemModel::refresh() {
 }
 
 void FileSystemModel::update() {
-	mRoot = std::make_unique<Node>( mRootPath, *this );
+	{
+		Lock l( resourceMutex() );
+		mRoot = std::make_unique<Node>( mRootPath, *this );
+	}
 	invalidate();
 }
 
@@ -408,6 +448,13 @@ Variant FileSystemModel::data( const ModelIndex& index, ModelRole role ) const {
 
 	auto& node = this->nodeRef( index );
 
+	if ( node.mPlaceholder ) {
+		if ( index.column() == Column::Name &&
+			 ( role == ModelRole::Display || role == ModelRole::Sort ) )
+			return Variant( mLoadingText.c_str() );
+		return {};
+	}
+
 	switch ( role ) {
 		case ModelRole::Custom: {
 			return Variant( node.info().getFilepath().c_str() );
@@ -527,6 +574,22 @@ void FileSystemModel::setDisplayConfig( const DisplayConfig& displayConfig ) {
 	}
 }
 
+void FileSystemModel::setThreadPool( const std::shared_ptr<ThreadPool>& threadPool ) {
+	mThreadPool = threadPool;
+}
+
+const std::shared_ptr<ThreadPool>& FileSystemModel::getThreadPool() const {
+	return mThreadPool;
+}
+
+void FileSystemModel::setMainThreadQueue( const std::shared_ptr<TaskQueue>& mainThreadQueue ) {
+	mMainThreadQueue = mainThreadQueue;
+}
+
+const std::shared_ptr<TaskQueue>& FileSystemModel::getMainThreadQueue() const {
+	return mMainThreadQueue;
+}
+
 const ModelIndex& FileSystemModel::getPreviouslySelectedIndex() const {
 	return mPreviouslySelectedIndex;
 }
@@ -581,7 +644,166 @@ size_t FileSystemModel::getFileIndex( Node* parent, const FileInfo& file ) {
 	return pos;
 }
 
+bool FileSystemModel::loadAsync( Node* node ) {
+	std::weak_ptr<FileSystemModel> weakModel = weak_from_this();
+
+	// The model must be owned by a shared_ptr, the loader can outlive it
+	if ( !mThreadPool || !mMainThreadQueue || weakModel.expired() )
+		return false;
+
+	auto request = std::make_shared<LoadRequest>();
+	request->node = node;
+	node->mLoadRequest = request;
+	node->mLoading = true;
+
+	Node* placeholder = eeNew( Node, () );
+	placeholder->mParent = node;
+	placeholder->mPlaceholder = true;
+	placeholder->mInfoDirty = false;
+	node->mChildren.emplace_back( placeholder );
+
+	std::string path( node->fullPath() );
+	FileSystem::dirAddSlashAtEnd( path );
+	std::weak_ptr<TaskQueue> weakQueue( mMainThreadQueue );
+
+	// Only the directory is read in the pool, the nodes are inserted and the views notified from
+	// the main thread
+	mThreadPool->submit( [weakModel, weakQueue, request, node, path, mode = mMode,
+						  displayCfg = mDisplayConfig] {
+		// Sorted by name only, the folders are inserted before the files as they are found
+		auto names = FileSystem::filesGetInPath( path, displayCfg.sortByName, false, false );
+		size_t i = 0;
+		bool done = false;
+
+		while ( !done ) {
+			auto batch = std::make_unique<LoadBatch>();
+
+			for ( size_t end = eemin( names.size(), i + LOAD_BATCH_SIZE ); i < end; i++ ) {
+				FileInfo file( path + names[i], false );
+
+				if ( ( displayCfg.ignoreHidden && file.isHidden() ) ||
+					 !isFileVisible( file, mode, displayCfg ) )
+					continue;
+
+				auto& nodes =
+					displayCfg.foldersFirst && file.isDirectory() ? batch->folders : batch->files;
+				nodes.emplace_back( eeNew( Node, ( std::move( file ), node ) ) );
+			}
+
+			done = i == names.size();
+			batch->done = done;
+
+			auto queue = weakQueue.lock();
+
+			// The node was destroyed or traversed again, or the scene is gone
+			if ( !queue || request->cancelled )
+				return;
+
+			queue->post( [weakModel, request, batch = std::move( batch )] {
+				auto model = weakModel.lock();
+				if ( !model )
+					return;
+
+				bool inserted;
+				bool refreshed = false;
+
+				{
+					Lock l( model->resourceMutex() );
+					inserted = model->insertLoadedNodes( *request, batch->folders, batch->files,
+														 batch->done, refreshed );
+				}
+
+				// The refresh replaces the children without row notifications
+				if ( inserted )
+					model->invalidate( refreshed ? UpdateFlag::InvalidateAllIndexes
+												 : UpdateFlag::DontInvalidateIndexes );
+			} );
+		}
+	} );
+
+	return true;
+}
+
+bool FileSystemModel::insertLoadedNodes( LoadRequest& request, std::vector<Node*>& folders,
+										 std::vector<Node*>& files, bool done, bool& refreshed ) {
+	Node* node = request.node;
+
+	if ( nullptr == node || node->mLoadRequest.get() != &request )
+		return false;
+
+	ModelIndex parent = node->index( *this, 0 );
+
+	if ( !node->mChildren.empty() && node->mChildren[0]->mPlaceholder &&
+		 ( done || !folders.empty() || !files.empty() ) ) {
+		Node* placeholder = node->mChildren[0];
+
+		forEachView( [&]( UIAbstractView* view ) {
+			view->getSelection().removeAllMatching( [placeholder]( auto& selectionIndex ) {
+				return selectionIndex.internalData() == placeholder;
+			} );
+		} );
+
+		beginDeleteRows( parent, 0, 0 );
+		eeDelete( placeholder );
+		node->mChildren.erase( node->mChildren.begin() );
+		endDeleteRows();
+	}
+
+	const auto insertNodes = [&]( size_t pos, std::vector<Node*>& nodes ) {
+		if ( nodes.empty() )
+			return;
+
+		beginInsertRows( parent, pos, pos + nodes.size() - 1 );
+		node->mChildren.insert( node->mChildren.begin() + pos, nodes.begin(), nodes.end() );
+		endInsertRows();
+
+		if ( pos + nodes.size() < node->mChildren.size() ) {
+			forEachView( [&]( UIAbstractView* view ) {
+				std::vector<ModelIndex> newIndexes;
+				view->getSelection().forEachIndex( [&]( const ModelIndex& selectedIndex ) {
+					Node* curNode = static_cast<Node*>( selectedIndex.internalData() );
+					if ( curNode->getParent() == node && selectedIndex.row() >= (Int64)pos ) {
+						newIndexes.emplace_back(
+							this->index( selectedIndex.row() + nodes.size(),
+										 selectedIndex.column(), selectedIndex.parent() ) );
+					} else {
+						newIndexes.emplace_back( selectedIndex );
+					}
+				} );
+				view->getSelection().set( newIndexes, false );
+			} );
+		}
+
+		nodes.clear();
+	};
+
+	size_t foldersCount = folders.size();
+	insertNodes( request.folders, folders );
+	request.folders += foldersCount;
+	insertNodes( node->mChildren.size(), files );
+
+	if ( done ) {
+		bool dirty = node->mLoadDirty;
+		node->cancelLoad();
+		if ( dirty ) {
+			node->refresh( *this );
+			refreshed = true;
+		}
+	}
+
+	return true;
+}
+
 bool FileSystemModel::handleFileEventLocked( const FileEvent& event ) {
+	if ( mThreadPool ) {
+		// The directory listing in progress may have missed the change
+		Node* directory = getNodeFromPath( event.directory, true, false );
+		if ( directory && directory->mLoading ) {
+			directory->mLoadDirty = true;
+			return false;
+		}
+	}
+
 	switch ( event.type ) {
 		case FileSystemEventType::Add: {
 			FileInfo file( event.directory + event.filename, false );
@@ -168,6 +168,10 @@ void Model::endInsertRows() {
 	for ( auto& client : mClients ) {
 		client->modelDidInsertRows( operation.sourceParent, operation.first, operation.last );
 	}
+
+	forEachView( [&operation]( UIAbstractView* view ) {
+		view->onModelRowsInserted( operation.sourceParent, operation.first, operation.last );
+	} );
 }
 
 void Model::endInsertColumns() {
@@ -191,6 +195,8 @@ void Model::endMoveRows() {
 	for ( auto& client : mClients )
 		client->modelDidMoveRows( operation.sourceParent, operation.first, operation.last,
 								  operation.targetParent, operation.target );
+
+	forEachView( []( UIAbstractView* view ) { view->onModelRowsMoved(); } );
 }
 
 void Model::endMoveColumns() {
@@ -216,6 +222,10 @@ void Model::endDeleteRows() {
 	for ( auto& client : mClients ) {
 		client->modelDidDeleteRows( operation.sourceParent, operation.first, operation.last );
 	}
+
+	forEachView( [&operation]( UIAbstractView* view ) {
+		view->onModelRowsDeleted( operation.sourceParent, operation.first, operation.last );
+	} );
 }
 
 void Model::endDeleteColumns() {
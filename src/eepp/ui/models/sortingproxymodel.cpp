@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 #include <eepp/ui/abstract/uiabstractview.hpp>
 #include <eepp/ui/models/modelselection.hpp>
 #include <eepp/ui/models/sortingproxymodel.hpp>
@@ -8,6 +9,118 @@ using namespace EE::UI::Abstract;
 
 namespace EE { namespace UI { namespace Models {
 
+static constexpr size_t PARALLEL_SORT_MIN_ROWS = 16384;
+static constexpr size_t PARALLEL_SORT_MAX_CHUNKS = 64;
+
+template <typename F> static void parallelFor( ThreadPool* pool, size_t count, F func ) {
+	std::atomic<size_t> next{ 0 };
+	auto run = [&]() {
+		size_t i;
+		while ( ( i = next.fetch_add( 1, std::memory_order_relaxed ) ) < count )
+			func( i );
+	};
+
+	std::vector<TaskHandle> handles;
+	size_t helpers = count > 1 ? eemin<size_t>( pool->numThreads(), count - 1 ) : 0;
+	for ( size_t i = 0; i < helpers; i++ )
+		handles.emplace_back( pool->submit( run ) );
+
+	// The calling thread works too, the helpers that didn't start are cancelled
+	run();
+
+	for ( auto& handle : handles ) {
+		if ( !handle.cancel() )
+			handle.wait();
+	}
+}
+
+// The comparators are total orders (ties are broken by the source row), so the chunks can be
+// sorted and merged in any order and the result is always the same.
+template <typename Less>
+static void parallelSort( std::vector<int>& rows, const Less& less, ThreadPool* pool ) {
+	if ( !pool || pool->isWorkerThread() || pool->numThreads() == 0 ||
+		 rows.size() < PARALLEL_SORT_MIN_ROWS ) {
+		std::sort( rows.begin(), rows.end(), less );
+		return;
+	}
+
+	size_t chunks = 1;
+	while ( chunks < pool->numThreads() + 1 && chunks < PARALLEL_SORT_MAX_CHUNKS )
+		chunks <<= 1;
+	size_t chunkSize = ( rows.size() + chunks - 1 ) / chunks;
+	auto bound = [&]( size_t chunk ) {
+		return rows.begin() + eemin( rows.size(), chunk * chunkSize );
+	};
+
+	parallelFor( pool, chunks,
+				 [&]( size_t chunk ) { std::sort( bound( chunk ), bound( chunk + 1 ), less ); } );
+
+	std::vector<int> buffer( rows.size() );
+	for ( size_t width = 1; width < chunks; width *= 2 ) {
+		parallelFor( pool, chunks / ( width * 2 ), [&]( size_t merge ) {
+			size_t first = merge * width * 2;
+			std::merge( bound( first ), bound( first + width ), bound( first + width ),
+						bound( first + width * 2 ),
+						buffer.begin() + ( bound( first ) - rows.begin() ), less );
+		} );
+		rows.swap( buffer );
+	}
+}
+
+// Keeps the rows that are still in order, and merges back the sorted displaced ones. A resort
+// after a few rows changed their value only sorts those rows.
+template <typename Less>
+static void mergeSortRows( std::vector<int>& rows, const Less& less, ThreadPool* pool ) {
+	std::vector<int> kept;
+	std::vector<int> displaced;
+	kept.reserve( rows.size() );
+	for ( int row : rows ) {
+		if ( kept.empty() || less( kept.back(), row ) ) {
+			kept.push_back( row );
+		} else {
+			displaced.push_back( row );
+		}
+	}
+
+	if ( displaced.empty() )
+		return;
+
+	if ( displaced.size() * 2 > rows.size() ) {
+		parallelSort( rows, less, pool );
+		return;
+	}
+
+	parallelSort( displaced, less, pool );
+	std::merge( kept.begin(), kept.end(), displaced.begin(), displaced.end(), rows.begin(), less );
+}
+
+template <typename Key> static bool keyLessThan( const Key& key1, const Key& key2 ) {
+	return key1 < key2;
+}
+
+// NaNs sort after every number and are equal between them, < alone isn't a strict weak order
+static bool keyLessThan( const Float& key1, const Float& key2 ) {
+	if ( std::isnan( key2 ) )
+		return !std::isnan( key1 );
+	return key1 < key2;
+}
+
+template <typename Key>
+static void sortRowsByKey( std::vector<int>& rows, const std::vector<Key>& keys,
+						   SortOrder sortOrder, ThreadPool* pool ) {
+	bool ascending = sortOrder == SortOrder::Ascending;
+	mergeSortRows(
+		rows,
+		[&keys, ascending]( int row1, int row2 ) {
+			if ( keyLessThan( keys[row1], keys[row2] ) )
+				return ascending;
+			if ( keyLessThan( keys[row2], keys[row1] ) )
+				return !ascending;
+			return row1 < row2;
+		},
+		pool );
+}
+
 SortingProxyModel::SortingProxyModel( std::shared_ptr<Model> target ) :
 	mSource( target ), mKeyColumn( -1 ) {
 	mSource->registerClient( this );
@@ -19,7 +132,14 @@ SortingProxyModel::~SortingProxyModel() {
 }
 
 void SortingProxyModel::invalidate( unsigned int flags ) {
-	if ( flags == UpdateFlag::DontInvalidateIndexes ) {
+	if ( flags == UpdateFlag::DontInvalidateIndexes && mRowsPatched ) {
+		// The inserted and deleted rows are already merged, only the mappings that missed the
+		// notifications are sorted again
+		for ( auto& it : mMappings ) {
+			if ( it.second->sourceRows.size() != source().rowCount( it.second->sourceParent ) )
+				sortMapping( *it.second, mKeyColumn, mSortOrder );
+		}
+	} else if ( flags == UpdateFlag::DontInvalidateIndexes ) {
 		sort( mKeyColumn, mSortOrder );
 	} else {
 		mMappings.clear();
@@ -28,6 +148,7 @@ void SortingProxyModel::invalidate( unsigned int flags ) {
 		forEachView( []( UIAbstractView* view ) { view->getSelection().clear( false ); } );
 		forEachView( []( UIAbstractView* view ) { view->notifySelectionChange(); } );
 	}
+	mRowsPatched = false;
 	onModelUpdate( flags );
 }
 
@@ -83,10 +204,6 @@ SortingProxyModel::buildMapping( const ModelIndex& sourceParent ) {
 
 	mapping->sourceParent = sourceParent;
 
-	int rowCount = source().rowCount( sourceParent );
-	mapping->sourceRows.resize( rowCount );
-	mapping->proxyRows.resize( rowCount );
-
 	sortMapping( *mapping, mKeyColumn, mSortOrder );
 
 	if ( sourceParent.isValid() ) {
@@ -226,66 +343,276 @@ bool SortingProxyModel::lessThan( const ModelIndex& index1, const ModelIndex& in
 			return String::toLower( std::string( data1.asCStr() ) ) <
 				   String::toLower( std::string( data2.asCStr() ) );
 	}
+	if ( data1.is( Variant::Type::Float ) && data2.is( Variant::Type::Float ) )
+		return keyLessThan( data1.asFloat(), data2.asFloat() );
 	return data1 < data2;
 }
 
+bool SortingProxyModel::rowLessThan( int row1, int row2, const ModelIndex& sourceParent,
+									 int column, SortOrder sortOrder ) const {
+	auto index1 = mSource->index( row1, column, sourceParent );
+	auto index2 = mSource->index( row2, column, sourceParent );
+	if ( lessThan( index1, index2 ) )
+		return sortOrder == SortOrder::Ascending;
+	if ( lessThan( index2, index1 ) )
+		return sortOrder != SortOrder::Ascending;
+	return row1 < row2;
+}
+
+void SortingProxyModel::sortRows( std::vector<int>& rows, const ModelIndex& sourceParent,
+								  int column, SortOrder sortOrder ) const {
+	// The keys are read once, in this thread, into a typed array. When the rows don't share the
+	// same type the rows are compared as lessThan does.
+	enum class KeyKind { Int, Uint, Float, String, Generic };
+	KeyKind kind = KeyKind::Generic;
+	Variant::Type type = Variant::Type::Invalid;
+	std::vector<Int64> ints;
+	std::vector<Uint64> uints;
+	std::vector<Float> floats;
+	std::vector<std::string> strings;
+
+	size_t rowCount = rows.size();
+	for ( size_t row = 0; row < rowCount; ++row ) {
+		Variant value( mSource->data( mSource->index( row, column, sourceParent ), mSortRole ) );
+
+		if ( row == 0 ) {
+			type = value.type();
+			switch ( type ) {
+				case Variant::Type::Invalid:
+				case Variant::Type::Bool:
+				case Variant::Type::Int:
+				case Variant::Type::Int64:
+					kind = KeyKind::Int;
+					ints.reserve( rowCount );
+					break;
+				case Variant::Type::Uint:
+				case Variant::Type::Uint64:
+					kind = KeyKind::Uint;
+					uints.reserve( rowCount );
+					break;
+				case Variant::Type::Float:
+					kind = KeyKind::Float;
+					floats.reserve( rowCount );
+					break;
+				case Variant::Type::StdString:
+				case Variant::Type::String:
+				case Variant::Type::cstr:
+					kind = KeyKind::String;
+					strings.reserve( rowCount );
+					break;
+				default:
+					break;
+			}
+		} else if ( value.type() != type ) {
+			kind = KeyKind::Generic;
+		}
+
+		if ( kind == KeyKind::Generic )
+			break;
+
+		switch ( type ) {
+			case Variant::Type::Invalid:
+				ints.push_back( 0 );
+				break;
+			case Variant::Type::Bool:
+				ints.push_back( value.asBool() );
+				break;
+			case Variant::Type::Int:
+				ints.push_back( value.asInt() );
+				break;
+			case Variant::Type::Int64:
+				ints.push_back( value.asInt64() );
+				break;
+			case Variant::Type::Uint:
+				uints.push_back( value.asUint() );
+				break;
+			case Variant::Type::Uint64:
+				uints.push_back( value.asUint64() );
+				break;
+			case Variant::Type::Float:
+				floats.push_back( value.asFloat() );
+				break;
+			case Variant::Type::StdString:
+				strings.emplace_back( String::toLower( value.asStdString() ) );
+				break;
+			case Variant::Type::String:
+				strings.emplace_back( String::toLower( value.asString() ).toUtf8() );
+				break;
+			case Variant::Type::cstr:
+				strings.emplace_back( String::toLower( std::string( value.asCStr() ) ) );
+				break;
+			default:
+				break;
+		}
+	}
+
+	ThreadPool* pool = mThreadPool.get();
+
+	switch ( kind ) {
+		case KeyKind::Int:
+			sortRowsByKey( rows, ints, sortOrder, pool );
+			break;
+		case KeyKind::Uint:
+			sortRowsByKey( rows, uints, sortOrder, pool );
+			break;
+		case KeyKind::Float:
+			sortRowsByKey( rows, floats, sortOrder, pool );
+			break;
+		case KeyKind::String:
+			sortRowsByKey( rows, strings, sortOrder, pool );
+			break;
+		case KeyKind::Generic:
+			// The source model data is only read from this thread
+			mergeSortRows(
+				rows,
+				[&]( int row1, int row2 ) {
+					return rowLessThan( row1, row2, sourceParent, column, sortOrder );
+				},
+				nullptr );
+			break;
+	}
+}
+
+void SortingProxyModel::setMappingRows( Mapping& mapping, std::vector<int>&& sourceRows ) {
+	std::vector<int> proxyRows( sourceRows.size() );
+	for ( size_t i = 0; i < sourceRows.size(); ++i )
+		proxyRows[sourceRows[i]] = i;
+
+	Lock l( resourceMutex() );
+	mapping.sourceRows = std::move( sourceRows );
+	mapping.proxyRows = std::move( proxyRows );
+}
+
 void SortingProxyModel::sortMapping( SortingProxyModel::Mapping& mapping, int column,
 									 SortOrder sortOrder ) {
-	if ( column == -1 ) {
-		int rowCount = source().rowCount( mapping.sourceParent );
-		for ( int i = 0; i < rowCount; ++i ) {
-			mapping.sourceRows[i] = i;
-			mapping.proxyRows[i] = i;
-		}
-		return;
+	int rowCount = source().rowCount( mapping.sourceParent );
+	std::vector<int> sourceRows( mapping.sourceRows );
+
+	// The current order is the starting point, unless the rows changed without notice
+	if ( column == -1 || (int)sourceRows.size() != rowCount ) {
+		sourceRows.resize( rowCount );
+		for ( int i = 0; i < rowCount; ++i )
+			sourceRows[i] = i;
 	}
 
+	if ( column != -1 )
+		sortRows( sourceRows, mapping.sourceParent, column, sortOrder );
+
 	auto oldSourceRows = mapping.sourceRows;
 
-	int rowCount = source().rowCount( mapping.sourceParent );
-	for ( int i = 0; i < rowCount; ++i )
-		mapping.sourceRows[i] = i;
-
-	std::stable_sort(
-		mapping.sourceRows.begin(), mapping.sourceRows.end(), [&]( auto row1, auto row2 ) -> bool {
-			bool isLessThan =
-				this->lessThan( mSource->index( row1, column, mapping.sourceParent ),
-								mSource->index( row2, column, mapping.sourceParent ) );
-			return sortOrder == SortOrder::Ascending ? isLessThan : !isLessThan;
-		} );
+	setMappingRows( mapping, std::move( sourceRows ) );
+
+	if ( column == -1 || oldSourceRows.empty() || oldSourceRows == mapping.sourceRows )
+		return;
 
-	for ( int i = 0; i < rowCount; ++i )
-		mapping.proxyRows[mapping.sourceRows[i]] = i;
+	remapSelection( mapping, [&]( int proxyRow ) {
+		return proxyRow < (int)oldSourceRows.size() &&
+					   oldSourceRows[proxyRow] < (int)mapping.proxyRows.size()
+				   ? mapping.proxyRows[oldSourceRows[proxyRow]]
+				   : -1;
+	} );
+}
 
+void SortingProxyModel::remapSelection( const Mapping& mapping,
+										const std::function<int( int )>& proxyRowMap ) {
 	// FIXME: I really feel like this should be done at the view layer somehow.
 	forEachView( [&]( UIAbstractView* view ) {
 		// Update the view's selection.
 		view->getSelection().changeFromModel( [&]( ModelSelection& selection ) {
-			std::vector<ModelIndex> selectedIndexesInSource;
+			std::vector<ModelIndex> selectedIndexes;
 			std::vector<ModelIndex> staleIndexesInSelection;
 			selection.forEachIndex( [&]( const ModelIndex& index ) {
 				if ( index.parent() == mapping.sourceParent ) {
 					staleIndexesInSelection.push_back( index );
-					selectedIndexesInSource.push_back( source().index(
-						oldSourceRows[index.row()], index.column(), mapping.sourceParent ) );
+					selectedIndexes.push_back( index );
 				}
 			} );
 
 			for ( auto& index : staleIndexesInSelection )
 				selection.remove( index );
 
-			for ( auto& index : selectedIndexesInSource ) {
-				for ( size_t i = 0; i < mapping.sourceRows.size(); ++i ) {
-					if ( mapping.sourceRows[i] == index.row() ) {
-						auto newSourceIndex =
-							this->index( i, index.column(), mapping.sourceParent );
-						selection.add( newSourceIndex );
-						break;
-					}
-				}
+			for ( auto& index : selectedIndexes ) {
+				int proxyRow = proxyRowMap( index.row() );
+				if ( proxyRow >= 0 )
+					selection.add( this->index( proxyRow, index.column(), mapping.sourceParent ) );
 			}
 		} );
 	} );
 }
 
+void SortingProxyModel::modelDidInsertRows( const ModelIndex& parent, int first, int last ) {
+	auto it = mMappings.find( parent );
+	if ( it == mMappings.end() )
+		return;
+
+	Mapping& mapping = *it->second;
+	int count = last - first + 1;
+	std::vector<int> oldSourceRows( mapping.sourceRows );
+	for ( auto& row : oldSourceRows ) {
+		if ( row >= first )
+			row += count;
+	}
+
+	std::vector<int> sourceRows( oldSourceRows );
+	for ( int row = first; row <= last; ++row ) {
+		if ( mKeyColumn == -1 ) {
+			sourceRows.insert( sourceRows.begin() + row, row );
+		} else {
+			sourceRows.insert( std::upper_bound( sourceRows.begin(), sourceRows.end(), row,
+												 [&]( int row1, int row2 ) {
+													 return rowLessThan( row1, row2, parent,
+																		 mKeyColumn, mSortOrder );
+												 } ),
+							   row );
+		}
+	}
+
+	setMappingRows( mapping, std::move( sourceRows ) );
+	mRowsPatched = true;
+
+	remapSelection( mapping, [&]( int proxyRow ) {
+		return proxyRow < (int)oldSourceRows.size() ? mapping.proxyRows[oldSourceRows[proxyRow]]
+													: -1;
+	} );
+}
+
+void SortingProxyModel::modelDidDeleteRows( const ModelIndex& parent, int first, int last ) {
+	auto it = mMappings.find( parent );
+	if ( it == mMappings.end() )
+		return;
+
+	Mapping& mapping = *it->second;
+	int count = last - first + 1;
+	std::vector<int> oldSourceRows( mapping.sourceRows );
+	std::vector<int> sourceRows;
+	sourceRows.reserve( oldSourceRows.size() );
+	for ( int row : oldSourceRows ) {
+		if ( row < first ) {
+			sourceRows.push_back( row );
+		} else if ( row > last ) {
+			sourceRows.push_back( row - count );
+		}
+	}
+
+	setMappingRows( mapping, std::move( sourceRows ) );
+	mRowsPatched = true;
+
+	remapSelection( mapping, [&]( int proxyRow ) {
+		if ( proxyRow >= (int)oldSourceRows.size() )
+			return -1;
+		int row = oldSourceRows[proxyRow];
+		if ( row >= first && row <= last )
+			return -1;
+		return mapping.proxyRows[row > last ? row - count : row];
+	} );
+}
+
+void SortingProxyModel::setThreadPool( const std::shared_ptr<ThreadPool>& threadPool ) {
+	mThreadPool = threadPool;
+}
+
+const std::shared_ptr<ThreadPool>& SortingProxyModel::getThreadPool() const {
+	return mThreadPool;
+}
+
 }}} // namespace EE::UI::Models
@@ -171,6 +171,8 @@ UIFileDialog::UIFileDialog( Uint32 dialogFlags, const std::string& defaultFilePa
 						"be empty" );
 			return;
 		}
+		if ( node->isPlaceholder() )
+			return;
 		if ( !isSaveDialog() ) {
 			if ( allowFolderSelect() || !FileSystem::isDirectory( node->fullPath() ) )
 				setFileName( node->getName() );
@@ -340,11 +342,15 @@ void UIFileDialog::refreshFolder( bool resetScroll ) {
 				FileSystemModel::DisplayConfig( getSortAlphabetically(), getFoldersFirst(),
 												!getShowHidden(), patterns ),
 				&getUISceneNode()->getTranslator() );
+			mModel->setThreadPool( getUISceneNode()->getThreadPool() );
+			mModel->setMainThreadQueue( getUISceneNode()->getMainThreadQueue() );
 		} else {
 			mModel->setRootPath( mCurPath );
 		}
 
-		mMultiView->setModel( SortingProxyModel::New( mModel ) );
+		auto sortingModel = SortingProxyModel::New( mModel );
+		sortingModel->setThreadPool( getUISceneNode()->getThreadPool() );
+		mMultiView->setModel( sortingModel );
 
 		mMultiView->getTableView()->setColumnsVisible(
 			{ FileSystemModel::Name, FileSystemModel::Size, FileSystemModel::ModificationTime } );
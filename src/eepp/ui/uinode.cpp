@@ -1,4 +1,5 @@
 #include <eepp/graphics/font.hpp>
+#include <eepp/graphics/framebuffer.hpp>
 #include <eepp/graphics/globalbatchrenderer.hpp>
 #include <eepp/graphics/primitives.hpp>
 #include <eepp/graphics/renderer/renderer.hpp>
@@ -53,6 +54,7 @@ UINode::~UINode() {
 	eeSAFE_DELETE( mBackground );
 	eeSAFE_DELETE( mForeground );
 	eeSAFE_DELETE( mBorder );
+	eeSAFE_DELETE( mRetainedFrameBuffer );
 
 	if ( isDragging() && getEventDispatcher() )
 		getEventDispatcher()->setNodeDragging( NULL );
@@ -150,6 +152,7 @@ void UINode::setInternalSize( const Sizef& size ) {
 		mDpSize = size;
 		mSize = PixelDensity::dpToPx( s );
 		mNodeFlags |= NODE_FLAG_POLYGON_DIRTY;
+		invalidateParentChildsIndex();
 		updateCenter();
 		sendCommonEvent( Event::OnSizeChange );
 		invalidateDraw();
@@ -170,6 +173,7 @@ void UINode::setInternalPixelsSize( const Sizef& size ) {
 		mDpSize = PixelDensity::pxToDp( s ).ceil();
 		mSize = s;
 		mNodeFlags |= NODE_FLAG_POLYGON_DIRTY;
+		invalidateParentChildsIndex();
 		updateCenter();
 		sendCommonEvent( Event::OnSizeChange );
 		invalidateDraw();
@@ -1067,29 +1071,14 @@ void UINode::nodeDraw() {
 
 		smartClipStart( ClipType::BorderBox, needsClipPlanes );
 
-		bool intersected = mWorldBounds.intersect( mSceneNode->getWorldBounds() );
+		bool intersected = mWorldBounds.intersect( mSceneNode->getRedrawBounds() );
 
 		if ( intersected ) {
-			smartClipStart( ClipType::ContentBox, needsClipPlanes );
-
-			if ( 0.f != mAlpha ) {
-				drawBackground();
-
-				drawSkin();
+			if ( NULL != mRetainedFrameBuffer ) {
+				drawRetained();
+			} else {
+				drawContent( needsClipPlanes );
 			}
-
-			smartClipStart( ClipType::PaddingBox, needsClipPlanes );
-
-			draw();
-
-			drawChilds();
-
-			smartClipEnd( ClipType::PaddingBox, needsClipPlanes );
-
-			if ( 0.f != mAlpha )
-				drawForeground();
-
-			smartClipEnd( ClipType::ContentBox, needsClipPlanes );
 		} else if ( !isClipped() ) {
 			drawChilds();
 		}
@@ -1116,6 +1105,136 @@ void UINode::nodeDraw() {
 	}
 }
 
+void UINode::drawContent( bool needsClipPlanes ) {
+	smartClipStart( ClipType::ContentBox, needsClipPlanes );
+
+	if ( 0.f != mAlpha ) {
+		drawBackground();
+
+		drawSkin();
+	}
+
+	smartClipStart( ClipType::PaddingBox, needsClipPlanes );
+
+	draw();
+
+	drawChilds();
+
+	smartClipEnd( ClipType::PaddingBox, needsClipPlanes );
+
+	if ( 0.f != mAlpha )
+		drawForeground();
+
+	smartClipEnd( ClipType::ContentBox, needsClipPlanes );
+}
+
+void UINode::drawRetained() {
+	Sizei size( mSize.ceil().asInt() );
+	size.x = eemax( 1, size.x );
+	size.y = eemax( 1, size.y );
+
+	if ( mRetainedFrameBuffer->getWidth() < size.getWidth() ||
+		 mRetainedFrameBuffer->getHeight() < size.getHeight() ) {
+		mRetainedFrameBuffer->resize(
+			eemax( size.getWidth(), mRetainedFrameBuffer->getWidth() ),
+			eemax( size.getHeight(), mRetainedFrameBuffer->getHeight() ) );
+		writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 1 );
+	}
+
+	if ( invalidated() ) {
+		GlobalBatchRenderer::instance()->draw();
+
+		// The parents clipping is in screen coordinates, it's restored to draw the buffer
+		ClippingMask* clippingMask = GLi->getClippingMask();
+		std::vector<Rectf> scissors( clippingMask->getScissorsClipped() );
+		std::vector<Rectf> planes( clippingMask->getPlanesClipped() );
+
+		while ( !clippingMask->getScissorsClipped().empty() )
+			clippingMask->clipDisable();
+
+		while ( !clippingMask->getPlanesClipped().empty() )
+			clippingMask->clipPlaneDisable();
+
+		mRetainedFrameBuffer->bind();
+		mRetainedFrameBuffer->clear();
+
+		GLi->translatef( -mScreenPosi.x, -mScreenPosi.y, 0.f );
+
+		drawContent( true );
+
+		GlobalBatchRenderer::instance()->draw();
+
+		mRetainedFrameBuffer->unbind();
+
+		if ( !scissors.empty() )
+			clippingMask->setScissorsClipped( scissors );
+
+		if ( !planes.empty() )
+			clippingMask->setPlanesClipped( planes );
+
+		writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 0 );
+	}
+
+	Rect r( 0, 0, size.getWidth(), size.getHeight() );
+	TextureRegion textureRegion( mRetainedFrameBuffer->getTexture(), r, r.getSize().asFloat() );
+	textureRegion.draw( mScreenPosi.x, mScreenPosi.y );
+}
+
+void UINode::setRetainedDraw( bool retainedDraw ) {
+	// Windows have their own frame buffer
+	if ( retainedDraw == isRetainedDraw() || isWindow() )
+		return;
+
+	if ( retainedDraw ) {
+		Sizei size( mSize.ceil().asInt() );
+		mRetainedFrameBuffer =
+			FrameBuffer::New( eemax( 1, size.getWidth() ), eemax( 1, size.getHeight() ) );
+
+		// Frame buffer failed to create?
+		if ( !mRetainedFrameBuffer->created() ) {
+			eeSAFE_DELETE( mRetainedFrameBuffer );
+			return;
+		}
+	} else {
+		eeSAFE_DELETE( mRetainedFrameBuffer );
+	}
+
+	writeNodeFlag( NODE_FLAG_FRAME_BUFFER, retainedDraw ? 1 : 0 );
+	writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 1 );
+
+	updateDrawInvalidator( true );
+
+	invalidateDraw();
+}
+
+bool UINode::isRetainedDraw() const {
+	return NULL != mRetainedFrameBuffer;
+}
+
+bool UINode::isDrawInvalidator() const {
+	return NULL != mRetainedFrameBuffer;
+}
+
+void UINode::invalidate( Node* invalidator ) {
+	if ( NULL == mRetainedFrameBuffer ) {
+		Node::invalidate( invalidator );
+		return;
+	}
+
+	// Hidden nodes are redrawn once visible
+	writeNodeFlag( NODE_FLAG_VIEW_DIRTY, 1 );
+
+	if ( !mVisible || mAlpha == 0.f )
+		return;
+
+	// Without an invalidator ancestor the node is its own draw invalidator
+	if ( NULL != mNodeDrawInvalidator && mNodeDrawInvalidator != this ) {
+		mNodeDrawInvalidator->invalidate( this );
+	} else if ( NULL != mSceneNode ) {
+		mSceneNode->invalidate( this );
+	}
+}
+
 void UINode::clearForeground() {
 	eeSAFE_DELETE( mForeground );
 }
@@ -1625,6 +1744,12 @@ Float UINode::lengthFromValue( const std::string& value,
 
 Float UINode::lengthFromValue( const CSS::StyleSheetProperty& property,
 							   const Float& defaultValue ) {
+	if ( property.isParsedLength() ) {
+		return convertLength( property.getParsedLength(),
+							  getPropertyRelativeTargetContainerLength(
+								  property.getPropertyDefinition()->getRelativeTarget(),
+								  defaultValue, property.getIndex() ) );
+	}
 	return lengthFromValue( property.getValue(),
 							property.getPropertyDefinition()->getRelativeTarget(), defaultValue,
 							property.getIndex() );
@@ -1641,6 +1766,12 @@ Float UINode::lengthFromValueAsDp( const std::string& value,
 
 Float UINode::lengthFromValueAsDp( const CSS::StyleSheetProperty& property,
 								   const Float& defaultValue ) const {
+	if ( property.isParsedLength() ) {
+		return convertLengthAsDp( property.getParsedLength(),
+								  getPropertyRelativeTargetContainerLength(
+									  property.getPropertyDefinition()->getRelativeTarget(),
+									  defaultValue, property.getIndex() ) );
+	}
 	return lengthFromValueAsDp( property.getValue(),
 								property.getPropertyDefinition()->getRelativeTarget(), defaultValue,
 								property.getIndex() );
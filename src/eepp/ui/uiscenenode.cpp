@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <atomic>
 #include <eepp/core/string.hpp>
 #include <eepp/graphics/fontmanager.hpp>
 #include <eepp/graphics/fonttruetype.hpp>
@@ -40,7 +41,8 @@ UISceneNode::UISceneNode( EE::Window::Window* window ) :
 	mUpdatingLayouts( false ),
 	mUIThemeManager( UIThemeManager::New() ),
 	mUIIconThemeManager( UIIconThemeManager::New()->setFallbackThemeManager( mUIThemeManager ) ),
-	mKeyBindings( mWindow->getInput() ) {
+	mKeyBindings( mWindow->getInput() ),
+	mMainThreadQueue( TaskQueue::New() ) {
 	// Reset size since the SceneNode already set it but needs to set the size from zero to emmit
 	// the required events to its childs.
 	mSize = Sizef();
@@ -72,6 +74,9 @@ UISceneNode::~UISceneNode() {
 	// We need to ensure that the childs are destroyed before the thread pool,
 	// since its childs could be consuming it and need to uninitialize gracefully.
 	childDeleteAll();
+
+	// The pending continuations could reference the destroyed childs, their futures are cancelled
+	mMainThreadQueue->clear();
 }
 
 void UISceneNode::resizeNode( EE::Window::Window* ) {
@@ -421,6 +426,18 @@ void UISceneNode::setThreadPool( const std::shared_ptr<ThreadPool>& threadPool )
 	mThreadPool = threadPool;
 }
 
+const std::shared_ptr<TaskQueue>& UISceneNode::getMainThreadQueue() const {
+	return mMainThreadQueue;
+}
+
+void UISceneNode::setMainThreadQueueBudget( const Time& budget ) {
+	mMainThreadQueueBudget = budget;
+}
+
+const Time& UISceneNode::getMainThreadQueueBudget() const {
+	return mMainThreadQueueBudget;
+}
+
 UIWidget* UISceneNode::loadLayoutFromFile( const std::string& layoutPath, Node* parent,
 										   const Uint32& marker ) {
 	if ( FileSystem::fileExists( layoutPath ) ) {
@@ -580,6 +597,8 @@ void UISceneNode::update( const Time& elapsed ) {
 
 	SceneManager::instance()->setCurrentUISceneNode( this );
 
+	mStyleUpdateStats = StyleUpdateStats();
+
 	updateDirtyStyles();
 	updateDirtyStyleStates();
 	updateDirtyLayouts();
@@ -591,6 +610,10 @@ void UISceneNode::update( const Time& elapsed ) {
 
 	SceneNode::update( elapsed );
 
+	// Run the continuations before the dirty states are processed again, so the changes they do
+	// are drawn in this frame
+	mMainThreadQueue->process( mMainThreadQueueBudget );
+
 	if ( mFirstUpdate && mVerbose ) {
 		Log::debug( "UISceneNode::update first SceneNode::update update took: %.2f ms",
 					mClock.getElapsedTime().asMilliseconds() );
@@ -637,6 +660,11 @@ void UISceneNode::onWidgetDelete( Node* node ) {
 		mDirtyStyle.erase( widget );
 
 		mDirtyStyleState.erase( widget );
+
+		mStyleMatches.erase( widget );
+
+		for ( auto roots : mStyleRootLists )
+			std::replace( roots->begin(), roots->end(), widget, (UIWidget*)nullptr );
 	}
 }
 
@@ -664,32 +692,13 @@ UIWidget* UISceneNode::getRoot() const {
 	return mRoot;
 }
 
-void UISceneNode::invalidateStyle( UIWidget* node, bool tryReinsert ) {
+void UISceneNode::invalidateStyle( UIWidget* node, bool ) {
 	eeASSERT( NULL != node );
 
 	if ( node->isClosing() )
 		return;
 
-	if ( mDirtyStyle.count( node ) > 0 ) {
-		if ( !tryReinsert )
-			return;
-		else
-			mDirtyStyle.erase( node );
-	}
-
-	for ( auto& dirtyNode : mDirtyStyle )
-		if ( NULL != dirtyNode && dirtyNode->isParentOf( node ) )
-			return;
-
-	std::vector<UIWidget*> eraseList;
-
-	for ( auto widget : mDirtyStyle )
-		if ( NULL == widget || node->isParentOf( widget ) )
-			eraseList.push_back( widget );
-
-	for ( auto widget : eraseList )
-		mDirtyStyle.erase( widget );
-
+	// The widgets covered by a dirty ancestor are pruned when the styles are updated
 	mDirtyStyle.insert( node );
 }
 
@@ -700,27 +709,9 @@ void UISceneNode::invalidateStyleState( UIWidget* node, bool disableCSSAnimation
 	if ( node->isClosing() )
 		return;
 
-	if ( mDirtyStyleState.count( node ) > 0 ) {
-		if ( !tryReinsert )
-			return;
-		else
-			mDirtyStyleState.erase( node );
-	}
-
-	for ( auto& dirtyNode : mDirtyStyleState )
-		if ( NULL != dirtyNode && dirtyNode->isParentOf( node ) )
-			return;
-
-	std::vector<UIWidget*> eraseList;
-
-	for ( auto widget : mDirtyStyleState )
-		if ( NULL == widget || node->isParentOf( widget ) )
-			eraseList.push_back( widget );
-
-	for ( auto widget : eraseList )
-		mDirtyStyleState.erase( widget );
+	if ( !mDirtyStyleState.insert( node ).second && !tryReinsert )
+		return;
 
-	mDirtyStyleState.insert( node );
 	mDirtyStyleStateCSSAnimations[node] = disableCSSAnimations;
 }
 
@@ -773,13 +764,107 @@ void UISceneNode::updateDirtyLayouts() {
 	}
 }
 
+std::vector<UIWidget*> UISceneNode::takeDirtyRoots( UnorderedSet<UIWidget*>& dirty ) {
+	std::vector<UIWidget*> roots;
+	roots.reserve( dirty.size() );
+
+	for ( UIWidget* widget : dirty ) {
+		bool covered = false;
+
+		for ( Node* node = widget->getParent(); NULL != node && !covered;
+			  node = node->getParent() ) {
+			covered = node->isWidget() && dirty.count( node->asType<UIWidget>() ) > 0;
+		}
+
+		if ( covered ) {
+			mStyleUpdateStats.pruned++;
+		} else {
+			roots.push_back( widget );
+		}
+	}
+
+	// The widgets invalidated while the roots are processed wait for the next pass
+	dirty.clear();
+
+	return roots;
+}
+
+void UISceneNode::matchStylesInParallel( const std::vector<UIWidget*>& roots ) {
+	if ( !mThreadPool || mThreadPool->isWorkerThread() )
+		return;
+
+	std::vector<UIWidget*> widgets;
+	std::vector<Node*> stack;
+
+	for ( UIWidget* root : roots ) {
+		if ( NULL != root )
+			stack.push_back( root );
+	}
+
+	while ( !stack.empty() ) {
+		Node* node = stack.back();
+		stack.pop_back();
+
+		if ( NULL != node->asType<UIWidget>()->getUIStyle() )
+			widgets.push_back( node->asType<UIWidget>() );
+
+		for ( Node* child = node->getFirstChild(); NULL != child; child = child->getNextNode() ) {
+			if ( child->isWidget() )
+				stack.push_back( child );
+		}
+	}
+
+	if ( widgets.size() < mParallelStyleMatchThreshold )
+		return;
+
+	// Matching only reads the widgets and the style sheet, nothing is modified until the UI
+	// thread applies the styles
+	const size_t chunkSize = 64;
+	const size_t chunks = ( widgets.size() + chunkSize - 1 ) / chunkSize;
+	std::vector<CSS::StyleSheetStyleVector> matches( widgets.size() );
+	std::atomic<size_t> nextChunk{ 0 };
+
+	auto matchChunks = [&]() {
+		size_t chunk;
+		while ( ( chunk = nextChunk.fetch_add( 1, std::memory_order_relaxed ) ) < chunks ) {
+			size_t end = eemin( widgets.size(), ( chunk + 1 ) * chunkSize );
+			for ( size_t i = chunk * chunkSize; i < end; i++ )
+				mStyleSheet.matchElementStyles( widgets[i], true, matches[i] );
+		}
+	};
+
+	std::vector<TaskHandle> handles;
+	size_t helpers = eemin<size_t>( mThreadPool->numThreads(), chunks - 1 );
+	for ( size_t i = 0; i < helpers; i++ )
+		handles.emplace_back( mThreadPool->submit( matchChunks ) );
+
+	// The UI thread matches too, so busy workers never stall it: the helpers that didn't start
+	// are cancelled and only the running ones are waited
+	matchChunks();
+
+	for ( auto& handle : handles ) {
+		if ( !handle.cancel() )
+			handle.wait();
+	}
+
+	for ( size_t i = 0; i < widgets.size(); i++ )
+		mStyleMatches[widgets[i]] = std::move( matches[i] );
+
+	mStyleUpdateStats.matchedInParallel += widgets.size();
+}
+
 void UISceneNode::updateDirtyStyles() {
 	if ( !mDirtyStyle.empty() ) {
 		Clock clock;
-		for ( auto& node : mDirtyStyle ) {
-			node->reloadStyle( true, false, false );
+		std::vector<UIWidget*> roots( takeDirtyRoots( mDirtyStyle ) );
+		mStyleRootLists.push_back( &roots );
+
+		for ( UIWidget* node : roots ) {
+			if ( NULL != node )
+				node->reloadStyle( true, false, false );
 		}
-		mDirtyStyle.clear();
+
+		mStyleRootLists.pop_back();
 
 		if ( mVerbose )
 			Log::info( "CSS Styles Reloaded in %.2f ms", clock.getElapsedTime().asMilliseconds() );
@@ -789,11 +874,23 @@ void UISceneNode::updateDirtyStyles() {
 void UISceneNode::updateDirtyStyleStates() {
 	if ( !mDirtyStyleState.empty() ) {
 		Clock clock;
-		for ( auto& node : mDirtyStyleState ) {
-			node->reportStyleStateChangeRecursive( mDirtyStyleStateCSSAnimations[node] );
+		UnorderedMap<UIWidget*, bool> cssAnimations;
+		cssAnimations.swap( mDirtyStyleStateCSSAnimations );
+		std::vector<UIWidget*> roots( takeDirtyRoots( mDirtyStyleState ) );
+		mStyleRootLists.push_back( &roots );
+
+		matchStylesInParallel( roots );
+
+		for ( UIWidget* node : roots ) {
+			if ( NULL != node )
+				node->reportStyleStateChangeRecursive( cssAnimations[node] );
 		}
-		mDirtyStyleState.clear();
-		mDirtyStyleStateCSSAnimations.clear();
+
+		mStyleRootLists.pop_back();
+
+		// The matches of the widgets that didn't report a state change are stale now
+		if ( mStyleRootLists.empty() )
+			mStyleMatches.clear();
 
 		if ( mVerbose )
 			Log::debug( "CSS Style State Invalidated, reapplied state in %.2f ms",
@@ -801,6 +898,33 @@ void UISceneNode::updateDirtyStyleStates() {
 	}
 }
 
+std::shared_ptr<CSS::ElementDefinition> UISceneNode::getElementStyles( UIWidget* widget ) {
+	mStyleUpdateStats.matched++;
+
+	if ( !mStyleMatches.empty() ) {
+		auto it = mStyleMatches.find( widget );
+		if ( it != mStyleMatches.end() ) {
+			auto definition = mStyleSheet.getElementDefinition( it->second );
+			mStyleMatches.erase( it );
+			return definition;
+		}
+	}
+
+	return mStyleSheet.getElementStyles( widget, true );
+}
+
+const UISceneNode::StyleUpdateStats& UISceneNode::getStyleUpdateStats() const {
+	return mStyleUpdateStats;
+}
+
+void UISceneNode::setParallelStyleMatchThreshold( Uint32 threshold ) {
+	mParallelStyleMatchThreshold = threshold;
+}
+
+Uint32 UISceneNode::getParallelStyleMatchThreshold() const {
+	return mParallelStyleMatchThreshold;
+}
+
 const bool& UISceneNode::isUpdatingLayouts() const {
 	return mUpdatingLayouts;
 }
@@ -243,31 +243,23 @@ void UIStyle::onStateChange() {
 
 	std::shared_ptr<ElementDefinition> prevDefinition = mDefinition;
 	std::shared_ptr<ElementDefinition> newDefinition =
-		mWidget->getUISceneNode()->getStyleSheet().getElementStyles( mWidget, true );
+		mWidget->getUISceneNode()->getElementStyles( mWidget );
 
 	if ( newDefinition != mDefinition || mForceReapplyProperties ) {
 		PropertyIdSet changedProperties;
 
-		if ( mDefinition )
-			changedProperties = mDefinition->getPropertyIds();
+		mWidget->getUISceneNode()->mStyleUpdateStats.applied++;
 
-		if ( newDefinition )
-			changedProperties |= newDefinition->getPropertyIds();
+		if ( mForceReapplyProperties || nullptr == newDefinition ) {
+			if ( mDefinition )
+				changedProperties = mDefinition->getPropertyIds();
 
-		if ( !mForceReapplyProperties ) {
-			if ( nullptr != newDefinition && !newDefinition->getPropertyIds().empty() ) {
-				if ( nullptr != mDefinition ) {
-					const PropertyIdSet propertiesInBothDefinitions =
-						( mDefinition->getPropertyIds() & newDefinition->getPropertyIds() );
-
-					for ( Uint32 id : propertiesInBothDefinitions ) {
-						const StyleSheetProperty* p0 = mDefinition->getProperty( id );
-						const StyleSheetProperty* p1 = newDefinition->getProperty( id );
-						if ( nullptr != p0 && nullptr != p1 && *p0 == *p1 )
-							changedProperties.erase( id );
-					}
-				}
-			}
+			if ( newDefinition )
+				changedProperties |= newDefinition->getPropertyIds();
+		} else {
+			// The delta only depends on both definitions, so it's shared by all the widgets
+			// going through the same change
+			changedProperties = newDefinition->getDeltaFrom( mDefinition ).changed;
 		}
 
 		mDefinition = newDefinition;
@@ -277,8 +269,7 @@ void UIStyle::onStateChange() {
 		mWidget->beginAttributesTransaction();
 
 		if ( nullptr != mDefinition && !mDefinition->getTransitionProperties().empty() ) {
-			mTransitions = TransitionDefinition::parseTransitionProperties(
-				mDefinition->getTransitionProperties() );
+			mTransitions = mDefinition->getTransitions();
 		}
 
 		for ( auto prop : changedProperties ) {
@@ -528,11 +519,9 @@ void UIStyle::updateAnimations() {
 		return;
 
 	bool isDifferent = false;
-	CSS::AnimationsMap animations;
+	const CSS::AnimationsMap& animations = mDefinition->getAnimations();
 
 	if ( !mDefinition->getAnimationProperties().empty() ) {
-		animations =
-			AnimationDefinition::parseAnimationProperties( mDefinition->getAnimationProperties() );
 		if ( animations.size() == mAnimations.size() ) {
 			for ( auto& animation : animations ) {
 				auto animIt = mAnimations.find( animation.second.getName() );
@@ -8,6 +8,7 @@
 #include <eepp/ui/uiscenenode.hpp>
 #include <eepp/ui/uiscrollbar.hpp>
 #include <eepp/ui/uitreeview.hpp>
+#include <eepp/window/engine.hpp>
 #include <stack>
 
 namespace EE { namespace UI {
@@ -43,45 +44,241 @@ UITreeView::MetadataForIndex& UITreeView::getIndexMetadata( const ModelIndex& in
 	return mViewMetadata[index.internalData()];
 }
 
-void UITreeView::traverseTree( TreeViewCallback callback ) const {
+const std::vector<UITreeView::FlatRow>& UITreeView::getFlatRows() const {
+	if ( !mFlatRowsDirty )
+		return mFlatRows;
+	mFlatRowsDirty = false;
+	mFlatRows.clear();
 	if ( !getModel() )
-		return;
+		return mFlatRows;
 	Lock l( const_cast<Model*>( getModel() )->resourceMutex() );
 	auto& model = *getModel();
-	int indentLevel = 0;
-	Float yOffset = getHeaderHeight();
-	int rowIndex = -1;
+	size_t rootCount = model.rowCount();
+	for ( size_t i = 0; i < rootCount; ++i )
+		appendFlatRows( mFlatRows, 0, model.index( i, model.treeColumn(), ModelIndex() ), -1, 0 );
+	return mFlatRows;
+}
+
+void UITreeView::appendFlatRows( std::vector<FlatRow>& rows, const Int64& offset,
+								 const ModelIndex& index, const Int64& parentRow,
+								 const Uint32& depth ) const {
+	Int64 row = offset + rows.size();
+	rows.push_back( { index, parentRow, depth } );
+	if ( !isExpanded( index ) )
+		return;
+	auto& model = *getModel();
+	size_t count = model.rowCount( index );
+	for ( size_t i = 0; i < count; ++i )
+		appendFlatRows( rows, offset, model.index( i, model.treeColumn(), index ), row, depth + 1 );
+}
+
+Int64 UITreeView::getFlatRowSubtreeEnd( const Int64& row ) const {
+	Int64 count = mFlatRows.size();
+	if ( row < 0 )
+		return count;
+	Int64 end = row + 1;
+	while ( end < count && mFlatRows[end].depth > mFlatRows[row].depth )
+		++end;
+	return end;
+}
+
+void UITreeView::replaceFlatRows( const Int64& first, const Int64& last,
+								  std::vector<FlatRow>& rows ) {
+	// The replaced range always holds whole subtrees, so only the parents after it move
+	Int64 delta = (Int64)rows.size() - ( last - first );
+	if ( delta != 0 ) {
+		for ( size_t i = last; i < mFlatRows.size(); ++i ) {
+			if ( mFlatRows[i].parent >= first )
+				mFlatRows[i].parent += delta;
+		}
+	}
+	mFlatRows.erase( mFlatRows.begin() + first, mFlatRows.begin() + last );
+	mFlatRows.insert( mFlatRows.begin() + first, std::make_move_iterator( rows.begin() ),
+					  std::make_move_iterator( rows.end() ) );
+}
+
+void UITreeView::updateFlatRowChilds( const ModelIndex& index ) {
+	if ( mFlatRowsDirty )
+		return;
+	if ( !index.isValid() ) {
+		mFlatRowsDirty = true;
+		return;
+	}
+	Int64 row = getRowFromIndex( index );
+	if ( row < 0 )
+		return;
+	auto& model = *getModel();
+	const FlatRow& flatRow = mFlatRows[row];
+	std::vector<FlatRow> childs;
+	if ( isExpanded( flatRow.index ) ) {
+		size_t count = model.rowCount( flatRow.index );
+		for ( size_t i = 0; i < count; ++i )
+			appendFlatRows( childs, row + 1,
+							model.index( i, model.treeColumn(), flatRow.index ), row,
+							flatRow.depth + 1 );
+	}
+	replaceFlatRows( row + 1, getFlatRowSubtreeEnd( row ), childs );
+}
+
+void UITreeView::setIndexOpen( const ModelIndex& index, bool open ) {
+	auto& metadata = getIndexMetadata( index );
+	if ( metadata.open == open )
+		return;
+	metadata.open = open;
+	updateFlatRowChilds( index );
+}
+
+size_t UITreeView::getFirstVisibleRow() const {
+	// One row before the viewport, the rows are still tested against it while traversed
 	Float rowHeight = getRowHeight();
-	std::function<IterationDecision( const ModelIndex& )> traverseIndex =
-		[&]( const ModelIndex& index ) {
-			if ( index.isValid() ) {
-				const auto& metadata = getIndexMetadata( index );
-				rowIndex++;
-				IterationDecision decision = callback( rowIndex, index, indentLevel, yOffset );
-				if ( decision == IterationDecision::Break || decision == IterationDecision::Stop )
-					return decision;
-				yOffset += rowHeight;
-				if ( !metadata.open ) {
-					return IterationDecision::Continue;
-				}
-			}
-			if ( indentLevel >= 0 && !index.isValid() )
-				return IterationDecision::Continue;
-			++indentLevel;
-			int rowCount = model.rowCount( index );
-			for ( int i = 0; i < rowCount; ++i ) {
-				IterationDecision decision =
-					traverseIndex( model.index( i, model.treeColumn(), index ) );
-				if ( decision == IterationDecision::Break || decision == IterationDecision::Stop )
-					return decision;
+	if ( rowHeight <= 0 )
+		return 0;
+	Int64 row = eefloor( ( mScrollOffset.y - getHeaderHeight() ) / rowHeight );
+	return eemax<Int64>( 0, row - 1 );
+}
+
+size_t UITreeView::getVisibleRowCount() const {
+	return getFlatRows().size();
+}
+
+ModelIndex UITreeView::getIndexAtRow( const size_t& row ) const {
+	const auto& rows = getFlatRows();
+	return row < rows.size() ? rows[row].index : ModelIndex();
+}
+
+Int64 UITreeView::getRowFromIndex( const ModelIndex& index ) const {
+	if ( !getModel() || !index.isValid() )
+		return -1;
+	const auto& rows = getFlatRows();
+	std::vector<Int64> path;
+	for ( ModelIndex cur = index; cur.isValid(); cur = cur.parent() )
+		path.push_back( cur.row() );
+	Int64 parentRow = -1;
+	Int64 first = 0;
+	Int64 last = rows.size();
+	for ( Uint32 depth = 0; depth < path.size(); ++depth ) {
+		Int64 target = path[path.size() - 1 - depth];
+		// Lower bound of the child row. The rows after the parent subtree sort last.
+		Int64 count = last - first;
+		while ( count > 0 ) {
+			Int64 step = count / 2;
+			Int64 ancestor = first + step;
+			while ( rows[ancestor].depth > depth )
+				ancestor = rows[ancestor].parent;
+			if ( rows[ancestor].depth == depth && rows[ancestor].parent == parentRow &&
+				 rows[ancestor].index.row() < target ) {
+				first += step + 1;
+				count -= step + 1;
+			} else {
+				count = step;
 			}
-			--indentLevel;
-			return IterationDecision::Continue;
-		};
-	int rootCount = model.rowCount();
-	for ( int rootIndex = 0; rootIndex < rootCount; ++rootIndex ) {
-		IterationDecision decision =
-			traverseIndex( model.index( rootIndex, model.treeColumn(), ModelIndex() ) );
+		}
+		if ( first >= last || rows[first].depth != depth || rows[first].parent != parentRow ||
+			 rows[first].index.row() != target )
+			return -1;
+		if ( depth + 1 == path.size() )
+			return first;
+		parentRow = first++;
+	}
+	return -1;
+}
+
+void UITreeView::onModelUpdate( unsigned flags ) {
+	// An update that keeps the indexes after inserts and deletes already patched keeps the rows
+	if ( !Engine::isRunninMainThread() || ( flags & Model::InvalidateAllIndexes ) ||
+		 !mFlatRowsPatched )
+		mFlatRowsDirty = true;
+	if ( Engine::isRunninMainThread() )
+		mFlatRowsPatched = false;
+	UIAbstractTableView::onModelUpdate( flags );
+}
+
+void UITreeView::onModelRowsInserted( const ModelIndex& parent, int first, int last ) {
+	if ( !Engine::isRunninMainThread() ) {
+		mFlatRowsDirty = true;
+		return;
+	}
+	if ( mFlatRowsDirty || !getModel() )
+		return;
+	mFlatRowsPatched = true;
+	Int64 parentRow = -1;
+	if ( parent.isValid() ) {
+		parentRow = isExpanded( parent ) ? getRowFromIndex( parent ) : -1;
+		if ( parentRow < 0 )
+			return;
+	}
+	auto& model = *getModel();
+	Uint32 depth = parentRow >= 0 ? mFlatRows[parentRow].depth + 1 : 0;
+	Int64 end = getFlatRowSubtreeEnd( parentRow );
+	Int64 count = last - first + 1;
+	Int64 pos = end;
+	for ( Int64 i = parentRow + 1; i < end; ++i ) {
+		FlatRow& row = mFlatRows[i];
+		if ( row.depth == depth && row.index.row() >= first ) {
+			if ( pos == end )
+				pos = i;
+			row.index = model.index( row.index.row() + count, model.treeColumn(), parent );
+		}
+	}
+	std::vector<FlatRow> rows;
+	for ( int i = first; i <= last; ++i )
+		appendFlatRows( rows, pos, model.index( i, model.treeColumn(), parent ), parentRow, depth );
+	replaceFlatRows( pos, pos, rows );
+}
+
+void UITreeView::onModelRowsDeleted( const ModelIndex& parent, int first, int last ) {
+	if ( !Engine::isRunninMainThread() ) {
+		mFlatRowsDirty = true;
+		return;
+	}
+	if ( mFlatRowsDirty || !getModel() )
+		return;
+	mFlatRowsPatched = true;
+	Int64 parentRow = -1;
+	if ( parent.isValid() ) {
+		parentRow = isExpanded( parent ) ? getRowFromIndex( parent ) : -1;
+		if ( parentRow < 0 )
+			return;
+	}
+	auto& model = *getModel();
+	Uint32 depth = parentRow >= 0 ? mFlatRows[parentRow].depth + 1 : 0;
+	Int64 end = getFlatRowSubtreeEnd( parentRow );
+	Int64 count = last - first + 1;
+	Int64 from = end;
+	Int64 to = end;
+	for ( Int64 i = parentRow + 1; i < end; ++i ) {
+		FlatRow& row = mFlatRows[i];
+		if ( row.depth != depth || row.index.row() < first )
+			continue;
+		if ( row.index.row() <= last ) {
+			if ( from == end )
+				from = i;
+		} else {
+			if ( to == end )
+				to = i;
+			row.index = model.index( row.index.row() - count, model.treeColumn(), parent );
+		}
+	}
+	std::vector<FlatRow> rows;
+	if ( from != end )
+		replaceFlatRows( from, to, rows );
+}
+
+void UITreeView::onModelRowsMoved() {
+	mFlatRowsDirty = true;
+}
+
+void UITreeView::traverseTree( TreeViewCallback callback, const size_t& startRow ) const {
+	if ( !getModel() )
+		return;
+	Lock l( const_cast<Model*>( getModel() )->resourceMutex() );
+	const auto& rows = getFlatRows();
+	Float headerHeight = getHeaderHeight();
+	Float rowHeight = getRowHeight();
+	for ( size_t rowIndex = startRow; rowIndex < rows.size(); ++rowIndex ) {
+		const FlatRow& row = rows[rowIndex];
+		IterationDecision decision = callback( rowIndex, row.index, row.depth,
+											   headerHeight + rowIndex * rowHeight );
 		if ( decision == IterationDecision::Break || decision == IterationDecision::Stop )
 			break;
 	}
@@ -95,12 +292,7 @@ void UITreeView::createOrUpdateColumns( bool resetColumnData ) {
 }
 
 size_t UITreeView::getItemCount() const {
-	size_t count = 0;
-	traverseTree( [&count]( const int&, const ModelIndex&, const size_t&, const Float& ) {
-		count++;
-		return IterationDecision::Continue;
-	} );
-	return count;
+	return getFlatRows().size();
 }
 
 void UITreeView::onColumnSizeChange( const size_t& colIndex, bool fromUserInteraction ) {
@@ -120,10 +312,10 @@ void UITreeView::bindNavigationClick( UIWidget* widget ) {
 		ConditionalLock l( getModel() != nullptr,
 						   getModel() ? &getModel()->resourceMutex() : nullptr );
 		if ( getModel()->rowCount( idx ) ) {
-			auto& data = getIndexMetadata( idx );
-			data.open = !data.open;
+			bool open = !isExpanded( idx );
+			setIndexOpen( idx, open );
 			createOrUpdateColumns( false );
-			onOpenTreeModelIndex( idx, data.open );
+			onOpenTreeModelIndex( idx, open );
 		} else {
 			onOpenModelIndex( idx, event );
 		}
@@ -162,12 +354,11 @@ bool UITreeView::tryOpenModelIndex( const ModelIndex& index, bool forceUpdate )
 		rowCount = getModel()->rowCount( index );
 	}
 	if ( rowCount ) {
-		auto& data = getIndexMetadata( index );
-		if ( !data.open ) {
-			data.open = true;
+		if ( !isExpanded( index ) ) {
+			setIndexOpen( index, true );
 			if ( forceUpdate )
 				createOrUpdateColumns( false );
-			onOpenTreeModelIndex( index, data.open );
+			onOpenTreeModelIndex( index, true );
 		}
 		return true;
 	}
@@ -197,10 +388,10 @@ UIWidget* UITreeView::setupCell( UITableCell* widget, UIWidget* rowWidget,
 					auto idx =
 						mouseEvent->getNode()->getParent()->asType<UITableRow>()->getCurIndex();
 					if ( getModel()->rowCount( idx ) ) {
-						auto& data = getIndexMetadata( idx );
-						data.open = !data.open;
+						bool open = !isExpanded( idx );
+						setIndexOpen( idx, open );
 						createOrUpdateColumns( false );
-						onOpenTreeModelIndex( idx, data.open );
+						onOpenTreeModelIndex( idx, open );
 					}
 				}
 			}
@@ -391,7 +582,7 @@ void UITreeView::drawChilds() {
 		rowNode->nodeDraw();
 		realRowIndex++;
 		return IterationDecision::Continue;
-	} );
+	}, getFirstVisibleRow() );
 
 	if ( mHeader && mHeader->isVisible() )
 		mHeader->nodeDraw();
@@ -429,7 +620,7 @@ Node* UITreeView::overFind( const Vector2f& point ) {
 				if ( pOver )
 					return IterationDecision::Stop;
 				return IterationDecision::Continue;
-			} );
+			}, getFirstVisibleRow() );
 			if ( !pOver )
 				pOver = this;
 		}
@@ -438,7 +629,8 @@ Node* UITreeView::overFind( const Vector2f& point ) {
 }
 
 bool UITreeView::isExpanded( const ModelIndex& index ) const {
-	return getIndexMetadata( index ).open;
+	auto it = mViewMetadata.find( index.internalData() );
+	return it != mViewMetadata.end() && it->second.open;
 }
 
 void UITreeView::setExpanded( const std::vector<ModelIndex>& indexes, bool expanded ) {
@@ -450,7 +642,7 @@ void UITreeView::setExpanded( const std::vector<ModelIndex>& indexes, bool expan
 			continue;
 		size_t count = model.rowCount( index );
 		if ( count )
-			getIndexMetadata( index ).open = expanded;
+			setIndexOpen( index, expanded );
 	}
 	createOrUpdateColumns( false );
 }
@@ -474,6 +666,7 @@ void UITreeView::expandAll( const ModelIndex& index ) {
 	if ( !getModel() )
 		return;
 	setAllExpanded( index, true );
+	updateFlatRowChilds( index );
 	createOrUpdateColumns( false );
 }
 
@@ -481,6 +674,7 @@ void UITreeView::collapseAll( const ModelIndex& index ) {
 	if ( !getModel() )
 		return;
 	setAllExpanded( index, false );
+	updateFlatRowChilds( index );
 	createOrUpdateColumns( false );
 }
 
@@ -556,76 +750,41 @@ Uint32 UITreeView::onKeyDown( const KeyEvent& event ) {
 
 	switch ( event.getKeyCode() ) {
 		case KEY_PAGEUP: {
+			size_t rowCount = getItemCount();
+			if ( rowCount == 0 )
+				return 1;
 			int pageSize = eefloor( getVisibleArea().getHeight() / getRowHeight() ) - 1;
-			std::deque<std::pair<ModelIndex, Float>> deque;
-			Float curY;
-			traverseTree(
-				[&]( const int&, const ModelIndex& index, const size_t&, const Float& offsetY ) {
-					deque.push_back( { index, offsetY } );
-					if ( (int)deque.size() > pageSize )
-						deque.pop_front();
-					if ( index == curIndex )
-						return IterationDecision::Break;
-					return IterationDecision::Continue;
-				} );
-			curY = deque.front().second - getHeaderHeight();
-			getSelection().set( deque.front().first );
-			scrollToPosition(
-				{ { mScrollOffset.x, curY },
-				  { columnData( deque.front().first.column() ).width, getRowHeight() } } );
+			Int64 curRow = getRowFromIndex( curIndex );
+			if ( curRow < 0 )
+				curRow = rowCount - 1;
+			Int64 row = eemax<Int64>( 0, curRow - eemax( 1, pageSize ) + 1 );
+			ModelIndex foundIndex = getIndexAtRow( row );
+			Float curY = row * getRowHeight();
+			getSelection().set( foundIndex );
+			scrollToPosition( { { mScrollOffset.x, curY },
+								{ columnData( foundIndex.column() ).width, getRowHeight() } } );
 			return 1;
 		}
 		case KEY_PAGEDOWN: {
+			size_t rowCount = getItemCount();
+			if ( rowCount == 0 )
+				return 1;
 			int pageSize = eefloor( getVisibleArea().getHeight() / getRowHeight() ) - 1;
-			int counted = 0;
-			bool foundStart = false;
-			bool resultFound = false;
-			ModelIndex foundIndex;
-			Float curY = 0;
-			Float lastOffsetY = 0;
-			ModelIndex lastIndex;
-			traverseTree(
-				[&]( const int&, const ModelIndex& index, const size_t&, const Float& offsetY ) {
-					if ( index == curIndex ) {
-						foundStart = true;
-					} else if ( foundStart ) {
-						counted++;
-						if ( counted == pageSize ) {
-							foundIndex = index;
-							curY = offsetY;
-							resultFound = true;
-							return IterationDecision::Break;
-						}
-					}
-					lastOffsetY = offsetY;
-					lastIndex = index;
-					return IterationDecision::Continue;
-				} );
-			if ( !resultFound ) {
-				foundIndex = lastIndex;
-				curY = lastOffsetY;
-			}
-			curY += getRowHeight();
+			Int64 curRow = getRowFromIndex( curIndex );
+			Int64 row = curRow < 0 ? rowCount - 1
+								   : eemin<Int64>( rowCount - 1, curRow + pageSize );
+			ModelIndex foundIndex = getIndexAtRow( row );
+			Float curY = getHeaderHeight() + row * getRowHeight() + getRowHeight();
 			getSelection().set( foundIndex );
 			scrollToPosition( { { mScrollOffset.x, curY },
 								{ columnData( foundIndex.column() ).width, getRowHeight() } } );
 			return 1;
 		}
 		case KEY_UP: {
-			ModelIndex prevIndex;
-			ModelIndex foundIndex;
-			Float curY = 0;
-			traverseTree(
-				[&]( const int&, const ModelIndex& index, const size_t&, const Float& offsetY ) {
-					if ( index == curIndex ) {
-						foundIndex = prevIndex;
-						curY = offsetY;
-						return IterationDecision::Break;
-					}
-					prevIndex = index;
-					return IterationDecision::Continue;
-				} );
-			if ( foundIndex.isValid() ) {
+			Int64 curRow = getRowFromIndex( curIndex );
+			if ( curRow > 0 ) {
+				ModelIndex foundIndex = getIndexAtRow( curRow - 1 );
+				Float curY = getHeaderHeight() + curRow * getRowHeight();
 				getSelection().set( foundIndex );
 				if ( curY < mScrollOffset.y + getHeaderHeight() + getRowHeight() ||
 					 curY > mScrollOffset.y + getPixelsSize().getHeight() - mPaddingPx.Top -
@@ -638,20 +797,14 @@ Uint32 UITreeView::onKeyDown( const KeyEvent& event ) {
 			return 1;
 		}
 		case KEY_DOWN: {
-			ModelIndex prevIndex;
-			ModelIndex foundIndex;
-			Float curY = 0;
-			traverseTree(
-				[&]( const int&, const ModelIndex& index, const size_t&, const Float& offsetY ) {
-					if ( prevIndex == curIndex ) {
-						foundIndex = index;
-						curY = offsetY;
-						return IterationDecision::Break;
-					}
-					prevIndex = index;
-					return IterationDecision::Continue;
-				} );
-			if ( foundIndex.isValid() ) {
+			// Without a selection the first row is selected
+			Int64 row = curIndex.isValid() ? getRowFromIndex( curIndex ) : -1;
+			if ( curIndex.isValid() && row < 0 )
+				return 1;
+			row++;
+			if ( row < (Int64)getItemCount() ) {
+				ModelIndex foundIndex = getIndexAtRow( row );
+				Float curY = getHeaderHeight() + row * getRowHeight();
 				getSelection().set( foundIndex );
 				if ( curY < mScrollOffset.y ||
 					 curY > mScrollOffset.y + getPixelsSize().getHeight() - mPaddingPx.Top -
@@ -667,12 +820,8 @@ Uint32 UITreeView::onKeyDown( const KeyEvent& event ) {
 		}
 		case KEY_END: {
 			scrollToBottom();
-			ModelIndex lastIndex;
-			traverseTree( [&]( const int&, const ModelIndex& index, const size_t&, const Float& ) {
-				lastIndex = index;
-				return IterationDecision::Continue;
-			} );
-			getSelection().set( lastIndex );
+			size_t rowCount = getItemCount();
+			getSelection().set( rowCount ? getIndexAtRow( rowCount - 1 ) : ModelIndex() );
 			return 1;
 		}
 		case KEY_HOME: {
@@ -682,9 +831,8 @@ Uint32 UITreeView::onKeyDown( const KeyEvent& event ) {
 		}
 		case KEY_RIGHT: {
 			if ( curIndex.isValid() && getModel()->rowCount( curIndex ) ) {
-				auto& metadata = getIndexMetadata( curIndex );
-				if ( !metadata.open ) {
-					metadata.open = true;
+				if ( !isExpanded( curIndex ) ) {
+					setIndexOpen( curIndex, true );
 					createOrUpdateColumns( false );
 					return 0;
 				}
@@ -694,9 +842,8 @@ Uint32 UITreeView::onKeyDown( const KeyEvent& event ) {
 		}
 		case KEY_LEFT: {
 			if ( curIndex.isValid() && getModel()->rowCount( curIndex ) ) {
-				auto& metadata = getIndexMetadata( curIndex );
-				if ( metadata.open ) {
-					metadata.open = false;
+				if ( isExpanded( curIndex ) ) {
+					setIndexOpen( curIndex, false );
 					createOrUpdateColumns( false );
 					return 0;
 				}
@@ -711,8 +858,7 @@ Uint32 UITreeView::onKeyDown( const KeyEvent& event ) {
 		case KEY_KP_ENTER: {
 			if ( curIndex.isValid() ) {
 				if ( getModel()->rowCount( curIndex ) ) {
-					auto& metadata = getIndexMetadata( curIndex );
-					metadata.open = !metadata.open;
+					setIndexOpen( curIndex, !isExpanded( curIndex ) );
 					createOrUpdateColumns( false );
 				} else {
 					onOpenModelIndex( curIndex, &event );
@@ -823,21 +969,10 @@ void UITreeView::setSelection( const ModelIndex& index, bool scrollToSelection,
 		if ( !scrollToSelection )
 			return;
 
-		ModelIndex prevIndex;
-		ModelIndex foundIndex;
-		Float curY = 0;
-		traverseTree(
-			[&]( const int&, const ModelIndex& _index, const size_t&, const Float& offsetY ) {
-				if ( index == _index ) {
-					foundIndex = prevIndex;
-					curY = offsetY;
-					return IterationDecision::Break;
-				}
-				prevIndex = index;
-				return IterationDecision::Continue;
-			} );
+		Int64 row = getRowFromIndex( index );
 
-		if ( foundIndex.isValid() ) {
+		if ( row >= 0 ) {
+			Float curY = getHeaderHeight() + row * getRowHeight();
 			if ( curY < mScrollOffset.y + getHeaderHeight() + getRowHeight() ||
 				 curY > mScrollOffset.y + getPixelsSize().getHeight() - mPaddingPx.Top -
 							mPaddingPx.Bottom - getRowHeight() ) {
@@ -2,6 +2,7 @@
 #include <eepp/scene/actions/actions.hpp>
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/ui/css/shorthanddefinition.hpp>
+#include <eepp/ui/css/stylesheetancestorfilter.hpp>
 #include <eepp/ui/css/stylesheetproperty.hpp>
 #include <eepp/ui/css/stylesheetselector.hpp>
 #include <eepp/ui/css/stylesheetspecification.hpp>
@@ -1078,6 +1079,7 @@ void UIWidget::reloadStyle( const bool& reloadChilds, const bool& disableAnimati
 		mStyle->load();
 
 		if ( NULL != getFirstChild() && reloadChilds ) {
+			CSS::StyleSheetAncestorFilter::Scope ancestorFilterScope( this );
 			Node* child = getFirstChild();
 
 			while ( NULL != child ) {
@@ -1289,12 +1291,15 @@ bool UIWidget::checkPropertyDefinition( const StyleSheetProperty& property ) {
 }
 
 void UIWidget::reportStyleStateChangeRecursive( bool disableAnimations, bool forceReApplyStyles ) {
-	Node* childLoop = getFirstChild();
-	while ( childLoop != NULL ) {
-		if ( childLoop->isWidget() )
-			childLoop->asType<UIWidget>()->reportStyleStateChangeRecursive( disableAnimations,
-																			forceReApplyStyles );
-		childLoop = childLoop->getNextNode();
+	if ( NULL != getFirstChild() ) {
+		CSS::StyleSheetAncestorFilter::Scope ancestorFilterScope( this );
+		Node* childLoop = getFirstChild();
+		while ( childLoop != NULL ) {
+			if ( childLoop->isWidget() )
+				childLoop->asType<UIWidget>()->reportStyleStateChangeRecursive(
+					disableAnimations, forceReApplyStyles );
+			childLoop = childLoop->getNextNode();
+		}
 	}
 	reportStyleStateChange( disableAnimations, forceReApplyStyles );
 }
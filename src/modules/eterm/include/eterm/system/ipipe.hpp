@@ -21,8 +21,10 @@
 //  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
 //  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 //  DEALINGS IN THE SOFTWARE.
+#include <chrono>
 #include <stdint.h>
 #include <stdlib.h>
+#include <thread>
 
 namespace eterm { namespace System {
 
@@ -45,6 +47,11 @@ class IPipe {
 	virtual int write( const char* s, size_t n ) = 0;
 
 	virtual int read( char* buf, size_t n, bool block = false ) = 0;
+
+	/** Waits until there is data to read or the timeout expires. */
+	virtual void waitForData( int timeoutMs ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( timeoutMs ) );
+	}
 };
 
 }} // namespace EE::System
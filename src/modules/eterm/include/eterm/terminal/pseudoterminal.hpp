@@ -57,6 +57,9 @@ class PseudoTerminal final : public IPseudoTerminal {
 	virtual bool resize( int columns, int rows ) override;
 	virtual int write( const char* s, size_t n ) override;
 	virtual int read( char* buf, size_t n, bool block = false ) override;
+#ifndef _WIN32
+	virtual void waitForData( int timeoutMs ) override;
+#endif
 
 	static std::unique_ptr<PseudoTerminal> create( int columns, int rows );
 
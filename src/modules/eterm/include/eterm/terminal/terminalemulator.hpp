@@ -36,10 +36,14 @@
 //  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 //  DEALINGS IN THE SOFTWARE.
 #include <eepp/math/vector2.hpp>
+#include <eepp/system/clock.hpp>
 #include <eepp/window/keycodes.hpp>
 #include <eterm/system/iprocess.hpp>
 #include <eterm/terminal/ipseudoterminal.hpp>
 #include <eterm/terminal/iterminaldisplay.hpp>
+#include <eterm/terminal/terminalhistory.hpp>
+#include <eterm/terminal/terminalreader.hpp>
+#include <eterm/terminal/terminalsearch.hpp>
 #include <eterm/terminal/terminaltypes.hpp>
 #include <memory>
 #include <stdint.h>
@@ -47,6 +51,7 @@
 
 using namespace EE;
 using namespace EE::Math;
+using namespace EE::System;
 using namespace EE::Window;
 using namespace eterm::System;
 
@@ -63,10 +68,7 @@ struct Term {
 	int col{ 0 };				   /* nb col */
 	Line* line{ nullptr };		   /* screen */
 	Line* alt{ nullptr };		   /* alternate screen */
-	Line* hist{ nullptr };		   /* history buffer */
-	int histcursize{ 0 };		   /* history current size */
 	int histsize{ 0 };			   /* history max size */
-	int histi{ 0 };				   /* history index */
 	int scr{ 0 };				   /* scroll back */
 	int* dirty{ nullptr };		   /* dirtyness of lines */
 	TerminalCursor c{};			   /* cursor */
@@ -227,6 +229,31 @@ class TerminalEmulator final {
 
 	Vector2i getSize() const;
 
+	/** @return The absolute id of the line displayed at `row` (see TerminalHistory) */
+	Uint64 getLineId( int row ) const;
+
+	/** Copies what's needed to search the history and the screen from another thread. */
+	TerminalSearchSnapshot getSearchSnapshot() const;
+
+	/** Searches the history and the screen on the calling thread. */
+	TerminalSearch::Result search( const TerminalSearchQuery& query ) const;
+
+	/** @return If the line of the hit is still stored */
+	bool isSearchHitValid( const TerminalSearchHit& hit ) const;
+
+	/** Scrolls the hit into view, if it's not visible, and selects it. */
+	bool showSearchHit( const TerminalSearchHit& hit );
+
+	/** Reads the pty from a dedicated thread (see TerminalReader) instead of polling it. */
+	void setThreadedRead( bool threaded );
+
+	bool isThreadedRead() const;
+
+	/** Maximum time update() spends parsing output before drawing the screen. */
+	void setParseBudget( const Time& budget );
+
+	const Time& getParseBudget() const;
+
   private:
 	DpyPtr mDpy;
 	PtyPtr mPty;
@@ -241,8 +268,14 @@ class TerminalEmulator final {
 
 	char mBuf[8192];
 	int mBuflen;
+	std::unique_ptr<TerminalReader> mReader;
+	Time mParseBudget{ Milliseconds( 8 ) };
+	Clock mDrawClock;
+	Clock mSyncClock;
+	bool mPendingDraw{ false };
 
 	Term mTerm;
+	mutable TerminalHistory mHistory;
 	TerminalSelection mSel;
 	CSIEscape mCsiescseq;
 	STREscape mStrescseq;
@@ -255,7 +288,6 @@ class TerminalEmulator final {
 	int mAllowAltScreen;
 	int mAllowWindowOps;
 
-	void resizeHistory();
 	void setClipboard( const char* str );
 
 	void loadColors();
@@ -292,6 +324,7 @@ class TerminalEmulator final {
 	void tnewline( int );
 	void tputtab( int );
 	void tputc( Rune );
+	void tputascii( const char*, int );
 	void treset();
 	void tscrollup( int, int, int );
 	void tscrolldown( int, int, int );
@@ -322,6 +355,7 @@ class TerminalEmulator final {
 	int tattrset( int );
 	void tnew( int, int, size_t );
 	void tresize( int, int );
+	void treflow( int );
 	void tsetdirtattr( int );
 
 	void ttyhangup();
@@ -0,0 +1,253 @@
+#ifndef ETERM_TERMINALHISTORY_HPP
+#define ETERM_TERMINALHISTORY_HPP
+
+#include <array>
+#include <deque>
+#include <eepp/config.hpp>
+#include <eterm/terminal/terminaltypes.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace EE;
+
+namespace eterm { namespace Terminal {
+
+/**
+ * Scrollback store of the terminal.
+ *
+ * The most recent lines are kept as cells (the hot tier). Older lines are encoded as UTF-8
+ * text plus run-length attribute spans and packed in blocks that can be compressed once full
+ * (the cold tier). Cold lines are decoded on demand into a small cache when they are accessed.
+ *
+ * Every line has an absolute id (the number of lines pushed before it) that doesn't change while
+ * the line is stored. Lines keep the width they had when they were pushed, and the history is
+ * displayed as rows of the width set with setColumns: lines stored at another width are joined
+ * with the lines they wrap into and re-wrapped, lazily, as their rows are requested. Rows are
+ * addressed by index, where 0 is the newest row.
+ */
+class TerminalHistory {
+  public:
+	static constexpr size_t DEFAULT_HOT_LINES = 2048;
+
+	static constexpr size_t LINES_PER_BLOCK = 256;
+
+	/** A sealed block of encoded lines. Immutable once sealed, so it can be shared. */
+	struct Block {
+		Uint64 firstId{ 0 };
+		Uint32 count{ 0 };
+		Uint32 rawSize{ 0 };
+		bool compressed{ false };
+		std::string data;
+		/** Bloom filter of the byte pairs found in the text of the lines, ASCII case folded */
+		std::array<Uint64, 64> bigrams{};
+
+		/** @return False if no line of the block can contain `text` (ASCII case folded) */
+		bool mayContain( std::string_view text ) const;
+	};
+
+	TerminalHistory( size_t capacity = 0, size_t hotLines = DEFAULT_HOT_LINES,
+					 bool compressBlocks = true );
+
+	~TerminalHistory();
+
+	TerminalHistory( const TerminalHistory& ) = delete;
+
+	TerminalHistory& operator=( const TerminalHistory& ) = delete;
+
+	/** Sets the maximum number of lines stored, older lines are discarded. */
+	void setCapacity( size_t capacity );
+
+	size_t getCapacity() const { return mCapacity; }
+
+	/**
+	 * @return The number of rows at the current width. The lines that weren't re-wrapped yet
+	 * count as one row each.
+	 */
+	size_t size() const;
+
+	/** @return The number of lines stored */
+	size_t getLineCount() const { return mNextId - mFirstId; }
+
+	bool empty() const { return mNextId == mFirstId; }
+
+	/** @return The absolute id of the oldest line stored */
+	Uint64 getFirstId() const { return mFirstId; }
+
+	/** @return The absolute id that the next pushed line will have */
+	Uint64 getNextId() const { return mNextId; }
+
+	/**
+	 * Stores a line that scrolled out of the screen. The history takes ownership of `line`.
+	 * @return A line buffer of `columns` cells the screen can reuse, its contents are undefined.
+	 */
+	Line push( Line line, int columns );
+
+	/**
+	 * @return The row `index` rows before the newest one, with `columns` cells. The pointer is
+	 * valid until the history is modified or more than getCacheSize() other rows are requested.
+	 */
+	Line getLine( size_t index, int columns );
+
+	/** @return The id of the line where the row `index` starts */
+	Uint64 getRowLineId( size_t index );
+
+	/**
+	 * Finds the row that displays the cell `column` of the line `id`.
+	 * @return False if the line is not stored
+	 */
+	bool getRowPosition( Uint64 id, int column, size_t& index, int& rowColumn );
+
+	/**
+	 * @return The text of the line `id`, encoded as UTF-8. With `placeholders` the wide
+	 * characters are followed by a NUL byte, so every code point maps to a single cell.
+	 */
+	std::string getLineText( Uint64 id, bool placeholders = false ) const;
+
+	/** @return If the line `id` continues in the next line */
+	bool isLineWrapped( Uint64 id ) const;
+
+	/**
+	 * Sets the width of the rows. Only the lines pushed from now on are stored at this width,
+	 * the previous ones are re-wrapped when their rows are requested, so it doesn't depend on
+	 * the history size.
+	 */
+	void setColumns( int columns );
+
+	int getColumns() const { return mColumns; }
+
+	void clear();
+
+	void setCompression( bool compress );
+
+	bool getCompression() const { return mCompress; }
+
+	size_t getCacheSize() const { return mCacheSize; }
+
+	void setCacheSize( size_t lines );
+
+	/** @return Approximate number of bytes used by the stored lines */
+	size_t getMemoryUsage() const;
+
+	/** @return The sealed blocks, oldest first. Lines below getFirstId() must be skipped. */
+	std::vector<std::shared_ptr<const Block>> getBlocks() const;
+
+	/** Decodes the text of every line in a block, in order. See getLineText. */
+	static std::vector<std::string> getBlockText( const Block& block, bool placeholders = false );
+
+	/** @return The text of `columns` cells without the trailing blanks. See getLineText. */
+	static std::string getCellsText( const TerminalGlyph* line, int columns,
+									 bool placeholders = false );
+
+  protected:
+	struct HotLine {
+		Line line{ nullptr };
+		int columns{ 0 };
+	};
+
+	static constexpr Uint32 NATIVE_ROW = 0xFFFFFFFF;
+
+	struct CachedLine {
+		Uint64 id{ 0 };
+		/* first cell of a re-wrapped row, or NATIVE_ROW for a line as stored */
+		Uint32 start{ NATIVE_ROW };
+		int columns{ 0 };
+		Line line{ nullptr };
+	};
+
+	/* A row of a line stored at another width, re-wrapped to the current one */
+	struct Row {
+		/* first line of the wrapped line the row belongs to */
+		Uint64 firstId{ 0 };
+		/* line where the row starts */
+		Uint64 id{ 0 };
+		/* first cell of the row, counted from the start of the wrapped line */
+		Uint32 start{ 0 };
+		/* number of lines of the wrapped line */
+		Uint32 lines{ 0 };
+	};
+
+	struct OpenBlock {
+		Uint64 firstId{ 0 };
+		std::string data;
+		std::vector<Uint32> offsets;
+	};
+
+	struct DecodedBlock {
+		std::shared_ptr<const Block> block;
+		std::string data;
+		std::vector<Uint32> offsets;
+	};
+
+	size_t mCapacity;
+	size_t mHotLines;
+	bool mCompress;
+	size_t mCacheSize{ 512 };
+	Uint64 mFirstId{ 0 };
+	Uint64 mNextId{ 0 };
+	std::deque<HotLine> mHot;
+	std::deque<std::shared_ptr<const Block>> mBlocks;
+	OpenBlock mOpen;
+	std::vector<CachedLine> mCache;
+	size_t mCacheNext{ 0 };
+	size_t mCacheLast{ 0 };
+	mutable DecodedBlock mDecoded;
+	int mColumns{ 0 };
+	/* lines below this id were pushed at another width */
+	Uint64 mReflowEndId{ 0 };
+	/* lines from this id up to mReflowEndId have their rows in mRows, newest first */
+	Uint64 mMappedId{ 0 };
+	std::deque<Row> mRows;
+	std::vector<TerminalGlyph> mCells;
+
+	Line allocLine( int columns );
+
+	void sealOpenBlock();
+
+	void evict();
+
+	void invalidateCache();
+
+	Line getCachedLine( Uint64 id, Uint32 start, int columns, bool& found );
+
+	Line getNativeLine( Uint64 id, int columns );
+
+	Line getReflowedRow( size_t row, int columns );
+
+	size_t getNativeRows() const;
+
+	/** Maps the rows of the next wrapped line, older than the ones mapped. */
+	bool mapRows();
+
+	int getLineColumns( Uint64 id ) const;
+
+	/** @return The cells used by the line: all of them if it wraps, up to the text otherwise */
+	int getLineLength( Uint64 id ) const;
+
+	/**
+	 * Appends the cells of the lines [firstId, firstId + lines) wrapped together, and the
+	 * position where each line starts to `starts` if provided.
+	 */
+	void getWrappedCells( Uint64 firstId, Uint32 lines, std::vector<TerminalGlyph>& cells,
+						  std::vector<Uint32>* starts = nullptr );
+
+	void pruneRows();
+
+	std::string_view getEncodedLine( Uint64 id ) const;
+
+	static void encodeLine( std::string& out, const TerminalGlyph* line, int columns );
+
+	static void decodeLine( std::string_view in, Line line, int columns );
+
+	static std::string decodeLineText( std::string_view in, bool placeholders = false );
+
+	static void indexBigrams( Block& block, std::string_view data,
+							  const std::vector<Uint32>& offsets );
+
+	static std::vector<Uint32> indexBlock( std::string_view data, size_t count );
+};
+
+}} // namespace eterm::Terminal
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef ETERM_TERMINALREADER_HPP
+#define ETERM_TERMINALREADER_HPP
+
+#include <atomic>
+#include <eterm/terminal/ipseudoterminal.hpp>
+#include <thread>
+#include <vector>
+
+namespace eterm { namespace Terminal {
+
+/**
+ * Reads a pseudo terminal from a dedicated thread into a single producer / single consumer
+ * lock-free byte ring. The thread that owns the emulator drains the ring at its own pace. When
+ * the ring is full the reader stops reading, so the kernel buffer fills up and the program
+ * writing to the terminal is throttled.
+ */
+class TerminalReader {
+  public:
+	static constexpr size_t DEFAULT_CAPACITY = 1024 * 1024;
+
+	/** `capacity` is rounded up to a power of two */
+	explicit TerminalReader( IPseudoTerminal* pty, size_t capacity = DEFAULT_CAPACITY );
+
+	~TerminalReader();
+
+	TerminalReader( const TerminalReader& ) = delete;
+
+	TerminalReader& operator=( const TerminalReader& ) = delete;
+
+	void start();
+
+	/** Stops and joins the reader thread, the pending bytes are kept. */
+	void stop();
+
+	bool isRunning() const { return mRunning; }
+
+	/**
+	 * Moves up to `n` pending bytes into `buf`. Must be called from a single thread.
+	 * @return The number of bytes read, or -1 if the pseudo terminal failed and there's nothing
+	 * left to read (errno is set to the error of the failed read).
+	 */
+	int read( char* buf, size_t n );
+
+	size_t available() const;
+
+	size_t getCapacity() const { return mBuffer.size(); }
+
+	bool isFull() const { return available() == mBuffer.size(); }
+
+  protected:
+	IPseudoTerminal* mPty;
+	std::vector<char> mBuffer;
+	size_t mMask;
+	/* mHead is only written by the reader thread and mTail by the consumer, both grow forever */
+	std::atomic<size_t> mHead{ 0 };
+	std::atomic<size_t> mTail{ 0 };
+	std::atomic<bool> mRunning{ false };
+	std::atomic<bool> mFailed{ false };
+	int mError{ 0 };
+	std::thread mThread;
+
+	void run();
+};
+
+}} // namespace eterm::Terminal
+
+#endif
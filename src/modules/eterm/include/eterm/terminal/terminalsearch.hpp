@@ -0,0 +1,70 @@
+#ifndef ETERM_TERMINALSEARCH_HPP
+#define ETERM_TERMINALSEARCH_HPP
+
+#include <atomic>
+#include <eterm/terminal/terminalhistory.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eterm { namespace Terminal {
+
+struct TerminalSearchQuery {
+	std::string text;
+	bool regex{ false };
+	/** Literal queries fold ASCII letters only, regex queries use std::regex_constants::icase */
+	bool caseSensitive{ false };
+};
+
+/**
+ * A match in the terminal. Lines are identified by their absolute id (see
+ * TerminalHistory::getFirstId), so a hit keeps pointing to the same text while new output
+ * scrolls in, until the line is discarded from the history.
+ */
+struct TerminalSearchHit {
+	Uint64 lineId{ 0 };
+	int column{ 0 };
+	/** Number of cells covered by the match */
+	int length{ 0 };
+
+	bool operator==( const TerminalSearchHit& other ) const {
+		return lineId == other.lineId && column == other.column && length == other.length;
+	}
+
+	bool operator<( const TerminalSearchHit& other ) const {
+		return lineId < other.lineId || ( lineId == other.lineId && column < other.column );
+	}
+};
+
+/**
+ * Text of the terminal taken on the thread that owns the emulator. The sealed history blocks
+ * are immutable and shared, so only the most recent lines are copied and the snapshot can be
+ * searched from any thread.
+ */
+struct TerminalSearchSnapshot {
+	/** Lines of the blocks below this id were discarded */
+	Uint64 firstId{ 0 };
+	std::vector<std::shared_ptr<const TerminalHistory::Block>> blocks;
+	/** Absolute id of lines[0] */
+	Uint64 linesFirstId{ 0 };
+	/** Text of the lines after the last block (including the screen), with placeholders */
+	std::vector<std::string> lines;
+};
+
+class TerminalSearch {
+  public:
+	struct Result {
+		/** Sorted from the oldest to the newest line */
+		std::vector<TerminalSearchHit> hits;
+		/** Set when the query is not a valid regular expression */
+		std::string error;
+		bool cancelled{ false };
+	};
+
+	static Result search( const TerminalSearchSnapshot& snapshot, const TerminalSearchQuery& query,
+						  const std::atomic<bool>* cancel = nullptr );
+};
+
+}} // namespace eterm::Terminal
+
+#endif
@@ -131,6 +131,7 @@ enum TermMode {
 	MODE_ECHO = 1 << 4,
 	MODE_PRINT = 1 << 5,
 	MODE_UTF8 = 1 << 6,
+	MODE_SYNC = 1 << 7,
 };
 
 enum TerminalCursorMovement { CURSOR_SAVE, CURSOR_LOAD };
@@ -1,6 +1,7 @@
 #ifndef ETERM_UI_UITERMINAL_HPP
 #define ETERM_UI_UITERMINAL_HPP
 
+#include <atomic>
 #include <eepp/ui/keyboardshortcut.hpp>
 #include <eepp/ui/uipopupmenu.hpp>
 #include <eepp/ui/uiscrollbar.hpp>
@@ -111,6 +112,30 @@ class UITerminal : public UIWidget {
 
 	void setColorScheme( const TerminalColorScheme& colorScheme );
 
+	typedef std::function<void( const TerminalSearch::Result& )> SearchCallback;
+
+	/**
+	 * Searches the history and the screen in a worker thread (if the scene node has a thread
+	 * pool) and selects the newest hit that is not below the view. A new search cancels the
+	 * previous one.
+	 */
+	void find( const TerminalSearchQuery& query, const SearchCallback& onDone = nullptr );
+
+	/** Selects the next newer hit, wrapping around. */
+	bool findNext();
+
+	/** Selects the next older hit, wrapping around. */
+	bool findPrev();
+
+	void clearSearch();
+
+	bool isSearching() const;
+
+	const TerminalSearchQuery& getSearchQuery() const;
+
+	/** @return The hits of the last search, from the oldest to the newest */
+	const std::vector<TerminalSearchHit>& getSearchHits() const;
+
   protected:
 	std::string mTitle;
 	bool mIsCustomTitle{ false };
@@ -126,6 +151,12 @@ class UITerminal : public UIWidget {
 	int mScrollOffset;
 	bool mScrollByBar{ false };
 	Clock mMouseClock;
+	TerminalSearchQuery mSearchQuery;
+	std::vector<TerminalSearchHit> mSearchHits;
+	size_t mSearchHitIndex{ 0 };
+	Uint64 mSearchId{ 0 };
+	std::shared_ptr<std::atomic<bool>> mSearchCancel;
+	std::atomic<int> mSearchProcessing{ 0 };
 
 	UITerminal( const std::shared_ptr<TerminalDisplay>& terminalDisplay );
 
@@ -181,6 +212,13 @@ class UITerminal : public UIWidget {
 	virtual void updateScrollPosition();
 
 	virtual void onScrollChange();
+
+	void onSearchDone( Uint64 searchId, TerminalSearch::Result&& result,
+					   const SearchCallback& onDone );
+
+	void pruneSearchHits();
+
+	bool showSearchHit( size_t index );
 };
 
 }} // namespace eterm::UI
@@ -160,6 +160,16 @@ int PseudoTerminal::read( char* s, size_t n, bool block ) {
 	return (int)r;
 }
 
+void PseudoTerminal::waitForData( int timeoutMs ) {
+	struct pollfd pfd;
+	pfd.fd = mMaster.handle();
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	/* on hang up poll returns right away, don't let the caller spin */
+	if ( poll( &pfd, 1, timeoutMs ) > 0 && !( pfd.revents & POLLIN ) )
+		usleep( timeoutMs * 1000 );
+}
+
 std::unique_ptr<PseudoTerminal> PseudoTerminal::create( int columns, int rows ) {
 	AutoHandle master;
 	AutoHandle slave;
@@ -443,6 +443,8 @@ TerminalDisplay::create( EE::Window::Window* window, Font* font, const Float& fo
 
 	terminal->mTerminal = TerminalEmulator::create( std::move( pseudoTerminal ),
 													std::move( process ), terminal, historySize );
+	if ( terminal->mTerminal )
+		terminal->mTerminal->setThreadedRead( true );
 	terminal->mProgram = program;
 	terminal->mArgs = args;
 	terminal->mWorkingDir = workingDir;
@@ -117,9 +117,9 @@ static const unsigned int tabspaces = 4;
 #define ISCONTROLC1( c ) ( BETWEEN( c, 0x80, 0x9f ) )
 #define ISCONTROL( c ) ( ISCONTROLC0( c ) || ISCONTROLC1( c ) )
 #define ISDELIM( u ) ( u && _wcschr( worddelimiters, u ) )
-#define TLINE( y )                                                                                \
-	( ( y ) < mTerm.scr && mTerm.histsize > 0                                                     \
-		  ? mTerm.hist[( ( y ) + mTerm.histi - mTerm.scr + mTerm.histsize + 1 ) % mTerm.histsize] \
+#define TLINE( y )                                                 \
+	( ( y ) < mTerm.scr && mTerm.histsize > 0                      \
+		  ? mHistory.getLine( mTerm.scr - 1 - ( y ), mTerm.col ) \
 		  : mTerm.line[( y ) - mTerm.scr] )
 
 typedef struct emoji_range {
@@ -622,7 +622,8 @@ size_t TerminalEmulator::ttyread( void ) {
 	int ret, written;
 
 	/* append read bytes to unprocessed bytes */
-	ret = mPty->read( mBuf + mBuflen, LEN( mBuf ) - mBuflen );
+	ret = mReader ? mReader->read( mBuf + mBuflen, LEN( mBuf ) - mBuflen )
+				  : mPty->read( mBuf + mBuflen, LEN( mBuf ) - mBuflen );
 
 	switch ( ret ) {
 		case 0:
@@ -668,19 +669,21 @@ void TerminalEmulator::kscrolldown( const TerminalArg* a ) {
 void TerminalEmulator::kscrollup( const TerminalArg* a ) {
 	int n = a->i;
 
+	int histi = (int)mHistory.size();
+
 	if ( n == INT_MAX )
-		n = mTerm.histi - mTerm.scr;
+		n = histi - mTerm.scr;
 
 	if ( n < 0 )
 		n = mTerm.row + n;
 
-	if ( mTerm.scr + n > mTerm.histi )
-		n = mTerm.histi - mTerm.scr;
+	if ( mTerm.scr + n > histi )
+		n = histi - mTerm.scr;
 
 	if ( n == 0 )
 		return;
 
-	if ( mTerm.scr <= mTerm.histsize - n && mTerm.scr + n <= mTerm.histi ) {
+	if ( mTerm.scr <= mTerm.histsize - n && mTerm.scr + n <= histi ) {
 		mTerm.scr += n;
 		selmove( n );
 		tfulldirt();
@@ -690,7 +693,7 @@ void TerminalEmulator::kscrollup( const TerminalArg* a ) {
 void TerminalEmulator::kscrollto( const TerminalArg* a ) {
 	int n = a->i;
 
-	if ( 0 <= n && n <= mTerm.histi ) {
+	if ( 0 <= n && n <= (int)mHistory.size() ) {
 		mTerm.scr = n;
 		selscroll( 0, n );
 		tfulldirt();
@@ -702,7 +705,7 @@ int TerminalEmulator::tisaltscr() {
 }
 
 int TerminalEmulator::scrollSize() const {
-	return mTerm.histi;
+	return (int)mHistory.size();
 }
 
 int TerminalEmulator::rowCount() const {
@@ -718,11 +721,8 @@ void TerminalEmulator::trimMemory() {
 }
 
 void TerminalEmulator::clearHistory() {
-	for ( int i = 0; i < mTerm.histcursize; ++i )
-		eeSAFE_FREE( mTerm.hist[i] );
-	eeSAFE_FREE( mTerm.hist );
-	mTerm.histcursize = 0;
-	mTerm.histi = 0;
+	mHistory.clear();
+	mTerm.scr = 0;
 	trimMemory();
 }
 
@@ -742,6 +742,79 @@ Vector2i TerminalEmulator::getSize() const {
 	return { mTerm.col, mTerm.row };
 }
 
+Uint64 TerminalEmulator::getLineId( int row ) const {
+	if ( row < mTerm.scr )
+		return mHistory.getRowLineId( mTerm.scr - 1 - row );
+	return mHistory.getNextId() + row - mTerm.scr;
+}
+
+TerminalSearchSnapshot TerminalEmulator::getSearchSnapshot() const {
+	TerminalSearchSnapshot snapshot;
+	snapshot.firstId = mHistory.getFirstId();
+	snapshot.blocks = mHistory.getBlocks();
+	snapshot.linesFirstId = snapshot.firstId;
+	if ( !snapshot.blocks.empty() )
+		snapshot.linesFirstId = MAX( snapshot.linesFirstId, snapshot.blocks.back()->firstId +
+																 snapshot.blocks.back()->count );
+
+	Uint64 nextId = mHistory.getNextId();
+	snapshot.lines.reserve( nextId - snapshot.linesFirstId + mTerm.row );
+	for ( Uint64 id = snapshot.linesFirstId; id < nextId; id++ )
+		snapshot.lines.emplace_back( mHistory.getLineText( id, true ) );
+	for ( int y = 0; y < mTerm.row; y++ )
+		snapshot.lines.emplace_back(
+			TerminalHistory::getCellsText( mTerm.line[y], mTerm.col, true ) );
+	return snapshot;
+}
+
+TerminalSearch::Result TerminalEmulator::search( const TerminalSearchQuery& query ) const {
+	return TerminalSearch::search( getSearchSnapshot(), query );
+}
+
+bool TerminalEmulator::isSearchHitValid( const TerminalSearchHit& hit ) const {
+	return hit.lineId >= mHistory.getFirstId() && hit.lineId < mHistory.getNextId() + mTerm.row;
+}
+
+bool TerminalEmulator::showSearchHit( const TerminalSearchHit& hit ) {
+	if ( !isSearchHitValid( hit ) )
+		return false;
+
+	/* rows are counted from the newest history row, the screen rows are negative */
+	int last = hit.column + MAX( hit.length, 1 ) - 1;
+	Int64 index, endIndex;
+	int column = hit.column, endColumn = last;
+	if ( hit.lineId >= mHistory.getNextId() ) {
+		index = endIndex = (Int64)mHistory.getNextId() - 1 - (Int64)hit.lineId;
+	} else {
+		/* the history line may have been re-wrapped to the current width */
+		size_t rowIndex, endRowIndex;
+		if ( !mHistory.getRowPosition( hit.lineId, hit.column, rowIndex, column ) ||
+			 !mHistory.getRowPosition( hit.lineId, last, endRowIndex, endColumn ) )
+			return false;
+		index = rowIndex;
+		endIndex = endRowIndex;
+	}
+
+	Int64 row = mTerm.scr - 1 - index;
+
+	if ( row < 0 || row >= mTerm.row ) {
+		/* center the line when possible */
+		Int64 scr = index + 1 + mTerm.row / 2;
+		LIMIT( scr, 0, (Int64)mHistory.size() );
+		TerminalArg arg = { (int)scr };
+		kscrollto( &arg );
+		row = mTerm.scr - 1 - index;
+	}
+
+	if ( row < 0 || row >= mTerm.row || column >= mTerm.col )
+		return false;
+
+	selstart( column, row, 0 );
+	selextend( MIN( endColumn, mTerm.col - 1 ), MIN( row + index - endIndex, mTerm.row - 1 ),
+			   SEL_REGULAR, 0 );
+	return true;
+}
+
 bool TerminalEmulator::isScrolling() const {
 	return mTerm.scr != 0;
 }
@@ -874,6 +947,7 @@ void TerminalEmulator::tnew( int col, int row, size_t historySize ) {
 	mTerm.c.attr.fg = mDefaultFg;
 	mTerm.c.attr.bg = mDefaultBg;
 	mTerm.histsize = historySize;
+	mHistory.setCapacity( historySize );
 
 	tresize( col, row );
 	treset();
@@ -888,35 +962,12 @@ void TerminalEmulator::tswapscreen( void ) {
 	tfulldirt();
 }
 
-void TerminalEmulator::resizeHistory() {
-	size_t oriSize = mTerm.histcursize;
-	if ( mTerm.histi >= (int)mTerm.histcursize ) {
-		int newSize = eemin( mTerm.histi + mTerm.row, mTerm.histsize );
-		mTerm.hist = (Line*)xrealloc( mTerm.hist, newSize * sizeof( Line ) );
-		mTerm.histcursize = newSize;
-
-		for ( int i = oriSize; i < mTerm.histcursize; i++ ) {
-			mTerm.hist[i] = (TerminalGlyph*)xmalloc( mTerm.col * sizeof( TerminalGlyph ) );
-			for ( int j = 0; j < mTerm.col; j++ ) {
-				mTerm.hist[i][j] = mTerm.c.attr;
-				mTerm.hist[i][j].u = ' ';
-			}
-		}
-	}
-}
-
-void TerminalEmulator::tscrolldown( int top, int n, int copyhist ) {
+void TerminalEmulator::tscrolldown( int top, int n, int /*copyhist*/ ) {
 	int i;
 	Line temp;
 
+	/* lines scrolled out of the bottom are not kept in the history */
 	LIMIT( n, 0, mTerm.bot - top + 1 );
-	if ( copyhist && mTerm.histsize > 0 ) {
-		mTerm.histi = ( mTerm.histi - 1 + mTerm.histsize ) % mTerm.histsize;
-		resizeHistory();
-		temp = mTerm.hist[mTerm.histi];
-		mTerm.hist[mTerm.histi] = mTerm.line[mTerm.bot];
-		mTerm.line[mTerm.bot] = temp;
-	}
 
 	tsetdirt( top, mTerm.bot - n );
 	tclearregion( 0, mTerm.bot - n + 1, mTerm.col - 1, mTerm.bot );
@@ -938,15 +989,12 @@ void TerminalEmulator::tscrollup( int top, int n, int copyhist ) {
 	LIMIT( n, 0, mTerm.bot - top + 1 );
 
 	if ( copyhist && mTerm.histsize > 0 ) {
-		mTerm.histi = ( mTerm.histi + 1 ) % mTerm.histsize;
-		resizeHistory();
-		temp = mTerm.hist[mTerm.histi];
-		mTerm.hist[mTerm.histi] = mTerm.line[top];
-		mTerm.line[top] = temp;
+		for ( i = top; i < top + n; i++ )
+			mTerm.line[i] = mHistory.push( mTerm.line[i], mTerm.col );
 	}
 
 	if ( mTerm.scr > 0 && mTerm.scr < mTerm.histsize )
-		mTerm.scr = MIN( mTerm.scr + n, mTerm.histsize - 1 );
+		mTerm.scr = MIN( mTerm.scr + n, (int)mHistory.size() );
 
 	tclearregion( 0, top, mTerm.col - 1, top + n - 1 );
 	tsetdirt( top + n, mTerm.bot );
@@ -1381,6 +1429,11 @@ void TerminalEmulator::tsetmode( int priv, int set, int* args, int narg ) {
 				case 2004: /* 2004: bracketed paste mode */
 					xsetmode( set, MODE_BRCKTPASTE );
 					break;
+				case 2026: /* 2026: synchronized output, hold the drawing until reset */
+					MODBIT( mTerm.mode, set, MODE_SYNC );
+					if ( set )
+						mSyncClock.restart();
+					break;
 				/* Not implemented mouse modes. See comments there. */
 				case 1001: /* mouse highlight mode; can hang the
 						  terminal by design when implemented. */
@@ -1391,9 +1444,6 @@ void TerminalEmulator::tsetmode( int priv, int set, int* args, int narg ) {
 						  and can be mistaken for other control
 						  codes. */
 					break;
-				case 2026: // IGNORE DECSET/DECRST 2026 for sync updates
-						   // (https://codeberg.org/dnkl/foot/pulls/461/files)
-					break;
 				default:
 					fprintf( stderr, "erresc: unknown private set/reset mode %d\n", *args );
 					break;
@@ -2272,12 +2322,108 @@ check_control_code:
 	}
 }
 
+/* length of the leading run of printable ASCII (0x20 - 0x7e), scanned a word at a time */
+static size_t asciiprintablelen( const char* s, size_t n ) {
+	static const uint64_t ones = 0x0101010101010101ULL;
+	static const uint64_t highs = 0x8080808080808080ULL;
+	size_t i = 0;
+	uint64_t v, del;
+
+	for ( ; i + sizeof( v ) <= n; i += sizeof( v ) ) {
+		memcpy( &v, s + i, sizeof( v ) );
+		del = v ^ ( ones * 0x7f );
+		/* any byte >= 0x80, < 0x20 or == 0x7f ends the run */
+		if ( ( v & highs ) | ( ( v - ones * 0x20 ) & ~v & highs ) | ( ( del - ones ) & ~del & highs ) )
+			break;
+	}
+	while ( i < n && BETWEEN( (uchar)s[i], 0x20, 0x7e ) )
+		i++;
+	return i;
+}
+
+void TerminalEmulator::tputascii( const char* s, int len ) {
+	int x, y, i, n;
+	Line line;
+	TerminalGlyph* gp;
+
+	while ( len > 0 ) {
+		if ( mTerm.c.state & CURSOR_WRAPNEXT ) {
+			if ( IS_SET( MODE_WRAP ) ) {
+				mTerm.line[mTerm.c.y][mTerm.c.x].mode |= ATTR_WRAP;
+				tnewline( 1 );
+			} else if ( mTerm.c.x == mTerm.col - 1 ) {
+				/* without autowrap every character lands on the last column */
+				if ( selected( mTerm.c.x, mTerm.c.y ) )
+					selclear();
+				tsetchar( (uchar)s[len - 1], &mTerm.c.attr, mTerm.c.x, mTerm.c.y );
+				mTerm.lastc = (uchar)s[len - 1];
+				return;
+			}
+		}
+
+		x = mTerm.c.x;
+		y = mTerm.c.y;
+		n = MIN( len, mTerm.col - x );
+
+		if ( mSel.ob.x != -1 ) {
+			for ( i = 0; i < n; i++ ) {
+				if ( selected( x + i, y ) ) {
+					selclear();
+					break;
+				}
+			}
+		}
+
+		line = TLINE( y );
+
+		for ( i = 0; i < n; i++ ) {
+			gp = &line[x + i];
+			/* same wide character bookkeeping as tsetchar */
+			if ( gp->mode & ATTR_WIDE ) {
+				if ( x + i + 1 < mTerm.col ) {
+					gp[1].u = ' ';
+					gp[1].mode &= ~ATTR_WDUMMY;
+				}
+			} else if ( ( gp->mode & ATTR_WDUMMY ) && x + i > 0 ) {
+				gp[-1].u = ' ';
+				gp[-1].mode &= ~ATTR_WIDE;
+			}
+			*gp = mTerm.c.attr;
+			gp->u = (uchar)s[i];
+		}
+
+		mTerm.dirty[y] = 1;
+		mDirty = true;
+		mTerm.lastc = (uchar)s[n - 1];
+		s += n;
+		len -= n;
+
+		if ( x + n < mTerm.col ) {
+			tmoveto( x + n, y );
+		} else {
+			tmoveto( mTerm.col - 1, y );
+			mTerm.c.state |= CURSOR_WRAPNEXT;
+		}
+	}
+}
+
 int TerminalEmulator::twrite( const char* buf, int buflen, int show_ctrl ) {
 	size_t charsize;
 	Rune u;
 	int n;
 
 	for ( n = 0; n < buflen; n += charsize ) {
+		/*
+		 * Runs of printable ASCII outside of any sequence are written straight
+		 * into the line cells, skipping the per rune decoding and checks.
+		 */
+		if ( !mTerm.esc && BETWEEN( (uchar)buf[n], 0x20, 0x7e ) &&
+			 !IS_SET( MODE_PRINT | MODE_INSERT ) && mTerm.trantbl[mTerm.charset] != CS_GRAPHIC0 ) {
+			charsize = asciiprintablelen( buf + n, buflen - n );
+			tputascii( buf + n, (int)charsize );
+			continue;
+		}
+
 		if ( IS_SET( MODE_UTF8 ) ) {
 			/* process a complete utf8 char */
 			charsize = utf8decode( buf + n, &u, buflen - n );
@@ -2303,7 +2449,7 @@ int TerminalEmulator::twrite( const char* buf, int buflen, int show_ctrl ) {
 }
 
 void TerminalEmulator::tresize( int col, int row ) {
-	int i, j;
+	int i;
 	int minrow = MIN( row, mTerm.row );
 	int mincol = MIN( col, mTerm.col );
 	int* bp;
@@ -2314,13 +2460,25 @@ void TerminalEmulator::tresize( int col, int row ) {
 		return;
 	}
 
+	/* the scrolled view is meaningless after a resize */
+	mTerm.scr = 0;
+	mHistory.setColumns( col );
+
+	/* re-wrap the main screen, the alternate screen is redrawn by its program */
+	int reflowed = col != mTerm.col && mTerm.col > 0 && !IS_SET( MODE_ALTSCREEN );
+	if ( reflowed )
+		treflow( col );
+
 	/*
 	 * slide screen to keep cursor where we expect it -
 	 * tscrollup would work here, but we can optimize to
 	 * memmove because we're freeing the earlier lines
 	 */
 	for ( i = 0; i <= mTerm.c.y - row; i++ ) {
-		xfree( mTerm.line[i] );
+		if ( !IS_SET( MODE_ALTSCREEN ) && mTerm.histsize > 0 && ( reflowed || col == mTerm.col ) )
+			xfree( mHistory.push( mTerm.line[i], col ) );
+		else
+			xfree( mTerm.line[i] );
 		xfree( mTerm.alt[i] );
 	}
 	/* ensure that both src and dst are not NULL */
@@ -2351,15 +2509,6 @@ void TerminalEmulator::tresize( int col, int row ) {
 		mTerm.alt[i] = (Line)xmalloc( col * sizeof( TerminalGlyph ) );
 	}
 
-	/* add new columns to history */
-	for ( int i = 0; i < mTerm.histcursize; i++ ) {
-		mTerm.hist[i] = (TerminalGlyph*)xrealloc( mTerm.hist[i], col * sizeof( TerminalGlyph ) );
-		for ( j = mincol; j < col; j++ ) {
-			mTerm.hist[i][j] = mTerm.c.attr;
-			mTerm.hist[i][j].u = ' ';
-		}
-	}
-
 	if ( col > mTerm.col ) {
 		bp = mTerm.tabs + mTerm.col;
 
@@ -2380,7 +2529,7 @@ void TerminalEmulator::tresize( int col, int row ) {
 	/* Clearing both screens (it makes dirty all lines) */
 	c = mTerm.c;
 	for ( i = 0; i < 2; i++ ) {
-		if ( mincol < col && 0 < minrow ) {
+		if ( mincol < col && 0 < minrow && !( reflowed && !IS_SET( MODE_ALTSCREEN ) ) ) {
 			tclearregion( mincol, 0, col - 1, minrow - 1 );
 		}
 		if ( 0 < col && minrow < row ) {
@@ -2393,6 +2542,102 @@ void TerminalEmulator::tresize( int col, int row ) {
 	mDirty = true;
 }
 
+void TerminalEmulator::treflow( int col ) {
+	std::vector<TerminalGlyph> cells;
+	std::vector<Line> rows;
+	TerminalGlyph blank = mTerm.c.attr;
+	int y, x, last, cx = 0, cy = 0;
+	size_t i, start;
+
+	blank.mode = 0;
+	blank.u = ' ';
+
+	selclear();
+
+	auto newRow = [&]() {
+		Line line = (Line)xmalloc( col * sizeof( TerminalGlyph ) );
+		for ( x = 0; x < col; x++ )
+			line[x] = blank;
+		return line;
+	};
+
+	/* the lines below the cursor are usually empty */
+	for ( last = mTerm.row - 1; last > mTerm.c.y; last-- ) {
+		Line line = mTerm.line[last];
+		for ( x = 0; x < mTerm.col && line[x].u == ' '; x++ )
+			;
+		if ( x < mTerm.col )
+			break;
+	}
+
+	for ( y = 0; y <= last; ) {
+		/* join the lines wrapped together */
+		long cursor = -1;
+		int wrapped;
+		cells.clear();
+		do {
+			Line line = mTerm.line[y];
+			int len = mTerm.col;
+			wrapped = ( line[mTerm.col - 1].mode & ATTR_WRAP ) != 0;
+			if ( !wrapped ) {
+				while ( len > 0 && line[len - 1].u == ' ' )
+					len--;
+			}
+			if ( y == mTerm.c.y ) {
+				cursor = cells.size() + mTerm.c.x;
+				len = MAX( len, mTerm.c.x + 1 );
+			}
+			cells.insert( cells.end(), line, line + len );
+			if ( !cells.empty() )
+				cells.back().mode &= ~ATTR_WRAP;
+			y++;
+		} while ( wrapped && y <= last );
+
+		/* and split them at the new width */
+		Line row = newRow();
+		x = 0;
+		for ( i = 0; i < cells.size(); i++ ) {
+			int width = ( cells[i].mode & ATTR_WIDE ) && col > 1 ? 2 : 1;
+			if ( x > 0 && x + width > col ) {
+				row[col - 1].mode |= ATTR_WRAP;
+				rows.push_back( row );
+				row = newRow();
+				x = 0;
+			}
+			if ( (long)i == cursor || ( width == 2 && (long)i + 1 == cursor ) ) {
+				cy = rows.size();
+				cx = x;
+			}
+			row[x++] = cells[i];
+			if ( width == 2 && i + 1 < cells.size() )
+				row[x++] = cells[++i];
+		}
+		rows.push_back( row );
+	}
+
+	/* keep the cursor on the screen, the rows above go to the history */
+	start = rows.size() > (size_t)mTerm.row ? MIN( rows.size() - mTerm.row, (size_t)cy ) : 0;
+	for ( i = 0; i < start; i++ ) {
+		if ( mTerm.histsize > 0 )
+			xfree( mHistory.push( rows[i], col ) );
+		else
+			xfree( rows[i] );
+	}
+
+	for ( y = 0; y < mTerm.row; y++ ) {
+		xfree( mTerm.line[y] );
+		mTerm.line[y] = start + y < rows.size() ? rows[start + y] : newRow();
+		mTerm.alt[y] = (Line)xrealloc( mTerm.alt[y], col * sizeof( TerminalGlyph ) );
+	}
+	for ( i = start + mTerm.row; i < rows.size(); i++ )
+		xfree( rows[i] );
+
+	mTerm.c.x = cx;
+	mTerm.c.y = cy - start;
+	mTerm.c.state &= ~CURSOR_WRAPNEXT;
+	tfulldirt();
+}
+
 void TerminalEmulator::resettitle( void ) {
 	auto dpy = mDpy.lock();
 	if ( dpy )
@@ -2566,10 +2811,46 @@ void TerminalEmulator::mousereport( const TerminalMouseEventType& type, const Ve
 }
 
 void TerminalEmulator::setPtyAndProcess( PtyPtr&& pty, ProcPtr&& process ) {
+	bool threaded = isThreadedRead();
+	mReader.reset();
 	mStatus = STARTING;
 	mExitCode = 1;
 	mPty = std::move( pty );
 	mProcess = std::move( process );
+	setThreadedRead( threaded );
+}
+
+void TerminalEmulator::setThreadedRead( bool threaded ) {
+	if ( threaded == isThreadedRead() )
+		return;
+
+	if ( threaded ) {
+		mReader = std::make_unique<TerminalReader>( mPty.get() );
+		mReader->start();
+	} else {
+		/* keep the bytes already read from the pty */
+		mReader->stop();
+		int ret;
+		while ( ( ret = mReader->read( mBuf + mBuflen, LEN( mBuf ) - mBuflen ) ) > 0 ) {
+			int written = twrite( mBuf, mBuflen + ret, 0 );
+			mBuflen += ret - written;
+			if ( mBuflen > 0 )
+				memmove( mBuf, mBuf + written, mBuflen );
+		}
+		mReader.reset();
+	}
+}
+
+bool TerminalEmulator::isThreadedRead() const {
+	return mReader != nullptr;
+}
+
+void TerminalEmulator::setParseBudget( const Time& budget ) {
+	mParseBudget = budget;
+}
+
+const Time& TerminalEmulator::getParseBudget() const {
+	return mParseBudget;
 }
 
 void TerminalEmulator::xsetpointermotion( int ) {
@@ -2624,6 +2905,8 @@ TerminalEmulator::TerminalEmulator( PtyPtr&& pty, ProcPtr&& process,
 }
 
 TerminalEmulator::~TerminalEmulator() {
+	mReader.reset();
+
 	for ( int i = 0; i < mTerm.row; i++ ) {
 		eeSAFE_FREE( mTerm.line[i] );
 		eeSAFE_FREE( mTerm.alt[i] );
@@ -2697,7 +2980,7 @@ int TerminalEmulator::getExitCode() const {
 }
 
 int TerminalEmulator::getHistorySize() const {
-	return mTerm.histi;
+	return (int)mHistory.size();
 }
 
 int TerminalEmulator::write( const char* buf, size_t buflen ) {
@@ -2714,6 +2997,10 @@ void TerminalEmulator::resize( int columns, int rows ) {
 }
 
 #define MAX_TTY_READS ( 1024 )
+/* longest time a synchronized update (mode 2026) can hold the drawing */
+#define SYNC_TIMEOUT ( Milliseconds( 150 ) )
+/* longest time the drawing is skipped while there's output left to parse */
+#define MAX_DRAW_DELAY ( Milliseconds( 33 ) )
 
 bool TerminalEmulator::update() {
 	if ( mStatus == TerminalEmulator::STARTING ) {
@@ -2722,22 +3009,40 @@ bool TerminalEmulator::update() {
 		return true;
 	}
 
-	int read = MAX_TTY_READS;
-	while ( ttyread() > 0 && --read )
-		;
+	/* parse until the frame budget runs out, the screen is drawn once per update */
+	Clock clock;
+	int reads = 0;
+	bool completed = true;
+	while ( ttyread() > 0 ) {
+		if ( ++reads == MAX_TTY_READS || clock.getElapsedTime() >= mParseBudget ) {
+			completed = false;
+			break;
+		}
+	}
 
-	if ( read != MAX_TTY_READS || mDirty )
-		draw();
+	if ( reads > 0 || mDirty || mPendingDraw ) {
+		/* skip the states that the pending output will overwrite anyway */
+		if ( ( IS_SET( MODE_SYNC ) && mSyncClock.getElapsedTime() < SYNC_TIMEOUT ) ||
+			 ( !completed && mDrawClock.getElapsedTime() < MAX_DRAW_DELAY ) ) {
+			mPendingDraw = true;
+		} else {
+			mPendingDraw = false;
+			mDrawClock.restart();
+			draw();
+		}
+	}
 
 	mProcess->checkExitStatus();
 
 	if ( mProcess->hasExited() ) {
 		mExitCode = mProcess->getExitCode();
 		mStatus = TERMINATED;
+		if ( mReader )
+			mReader->stop();
 		onProcessExit( mExitCode );
 	}
 
-	return read != 0;
+	return completed;
 }
 
 Term::~Term() {
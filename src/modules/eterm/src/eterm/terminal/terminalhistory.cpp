@@ -0,0 +1,751 @@
+#include <algorithm>
+#include <cstring>
+#include <eepp/core/memorymanager.hpp>
+#include <eepp/system/compression.hpp>
+#include <eepp/system/iostreammemory.hpp>
+#include <eepp/system/iostreamstring.hpp>
+#include <eterm/terminal/terminalhistory.hpp>
+
+using namespace EE::System;
+
+namespace eterm { namespace Terminal {
+
+/*
+ * Encoded line layout (all integers are LEB128 varints):
+ *   columns, flags, text cells, text bytes, UTF-8 text, runs count,
+ *   runs of ( length, mode, fg, bg )
+ * The text only covers up to the last non blank cell, the attribute runs cover every column.
+ */
+
+enum { LINE_WRAPPED = 1 << 0 };
+
+static void writeVarint( std::string& out, Uint64 val ) {
+	while ( val >= 0x80 ) {
+		out.push_back( (char)( ( val & 0x7F ) | 0x80 ) );
+		val >>= 7;
+	}
+	out.push_back( (char)val );
+}
+
+static Uint64 readVarint( std::string_view in, size_t& pos ) {
+	Uint64 val = 0;
+	int shift = 0;
+	while ( pos < in.size() ) {
+		Uint8 byte = (Uint8)in[pos++];
+		val |= (Uint64)( byte & 0x7F ) << shift;
+		if ( !( byte & 0x80 ) )
+			break;
+		shift += 7;
+	}
+	return val;
+}
+
+static inline Uint8 foldAscii( char c ) {
+	return c >= 'A' && c <= 'Z' ? c + ( 'a' - 'A' ) : (Uint8)c;
+}
+
+static inline Uint32 bigramBit( Uint8 a, Uint8 b ) {
+	return ( ( ( (Uint32)a << 8 ) | b ) * 2654435761u ) >> 20;
+}
+
+static void writeUtf8( std::string& out, Rune u ) {
+	if ( u < 0x80 ) {
+		out.push_back( (char)u );
+	} else if ( u < 0x800 ) {
+		out.push_back( (char)( 0xC0 | ( u >> 6 ) ) );
+		out.push_back( (char)( 0x80 | ( u & 0x3F ) ) );
+	} else if ( u < 0x10000 ) {
+		out.push_back( (char)( 0xE0 | ( u >> 12 ) ) );
+		out.push_back( (char)( 0x80 | ( ( u >> 6 ) & 0x3F ) ) );
+		out.push_back( (char)( 0x80 | ( u & 0x3F ) ) );
+	} else {
+		u = std::min<Rune>( u, 0x10FFFF );
+		out.push_back( (char)( 0xF0 | ( u >> 18 ) ) );
+		out.push_back( (char)( 0x80 | ( ( u >> 12 ) & 0x3F ) ) );
+		out.push_back( (char)( 0x80 | ( ( u >> 6 ) & 0x3F ) ) );
+		out.push_back( (char)( 0x80 | ( u & 0x3F ) ) );
+	}
+}
+
+static Rune readUtf8( std::string_view in, size_t& pos ) {
+	Uint8 c = (Uint8)in[pos++];
+	int len = c < 0x80 ? 0 : c < 0xE0 ? 1 : c < 0xF0 ? 2 : 3;
+	Rune u = len == 0 ? c : len == 1 ? ( c & 0x1F ) : len == 2 ? ( c & 0x0F ) : ( c & 0x07 );
+	while ( len-- > 0 && pos < in.size() )
+		u = ( u << 6 ) | ( (Uint8)in[pos++] & 0x3F );
+	return u;
+}
+
+TerminalHistory::TerminalHistory( size_t capacity, size_t hotLines, bool compressBlocks ) :
+	mCapacity( capacity ), mHotLines( hotLines ), mCompress( compressBlocks ) {}
+
+TerminalHistory::~TerminalHistory() {
+	clear();
+}
+
+void TerminalHistory::setCapacity( size_t capacity ) {
+	mCapacity = capacity;
+	while ( getLineCount() > mCapacity )
+		evict();
+}
+
+Line TerminalHistory::allocLine( int columns ) {
+	return (Line)eeMalloc( columns * sizeof( TerminalGlyph ) );
+}
+
+Line TerminalHistory::push( Line line, int columns ) {
+	Line freeLine = nullptr;
+	int freeColumns = 0;
+
+	mHot.push_back( { line, columns } );
+	mNextId++;
+
+	if ( getLineCount() > mCapacity ) {
+		if ( mFirstId >= mNextId - mHot.size() ) {
+			// The oldest line is still hot, reuse it
+			freeLine = mHot.front().line;
+			freeColumns = mHot.front().columns;
+			mHot.pop_front();
+			mFirstId++;
+			pruneRows();
+		} else {
+			evict();
+		}
+	}
+
+	if ( mHot.size() > mHotLines ) {
+		HotLine& hot = mHot.front();
+		if ( mOpen.offsets.empty() )
+			mOpen.firstId = mNextId - mHot.size();
+		mOpen.offsets.push_back( mOpen.data.size() );
+		encodeLine( mOpen.data, hot.line, hot.columns );
+		if ( mOpen.offsets.size() >= LINES_PER_BLOCK )
+			sealOpenBlock();
+		if ( freeLine ) {
+			eeFree( hot.line );
+		} else {
+			freeLine = hot.line;
+			freeColumns = hot.columns;
+		}
+		mHot.pop_front();
+	}
+
+	if ( !freeLine )
+		return allocLine( columns );
+
+	if ( freeColumns != columns )
+		freeLine = (Line)eeRealloc( freeLine, columns * sizeof( TerminalGlyph ) );
+
+	return freeLine;
+}
+
+void TerminalHistory::sealOpenBlock() {
+	auto block = std::make_shared<Block>();
+	block->firstId = mOpen.firstId;
+	block->count = mOpen.offsets.size();
+	block->rawSize = mOpen.data.size();
+
+	if ( mCompress ) {
+		// Favor speed, blocks are sealed while the terminal is receiving output
+		Compression::Config config;
+		config.zlib.level = 1;
+		IOStreamMemory src( mOpen.data.data(), mOpen.data.size() );
+		IOStreamString dst;
+		if ( Compression::compress( dst, src, Compression::MODE_DEFLATE, config ) ==
+				 Compression::OK &&
+			 dst.getStream().size() < mOpen.data.size() ) {
+			block->data = dst.getStream();
+			block->compressed = true;
+		}
+	}
+
+	indexBigrams( *block, mOpen.data, mOpen.offsets );
+
+	if ( !block->compressed )
+		block->data = std::move( mOpen.data );
+
+	mBlocks.emplace_back( std::move( block ) );
+	mOpen.data = std::string();
+	mOpen.offsets.clear();
+}
+
+void TerminalHistory::evict() {
+	if ( empty() )
+		return;
+
+	if ( mFirstId >= mNextId - mHot.size() ) {
+		eeFree( mHot.front().line );
+		mHot.pop_front();
+		mFirstId++;
+		pruneRows();
+		return;
+	}
+
+	mFirstId++;
+	pruneRows();
+
+	while ( !mBlocks.empty() && mBlocks.front()->firstId + mBlocks.front()->count <= mFirstId ) {
+		if ( mDecoded.block == mBlocks.front() )
+			mDecoded = DecodedBlock{};
+		mBlocks.pop_front();
+	}
+
+	if ( !mOpen.offsets.empty() && mOpen.firstId + mOpen.offsets.size() <= mFirstId ) {
+		mOpen.data.clear();
+		mOpen.offsets.clear();
+	}
+}
+
+void TerminalHistory::pruneRows() {
+	// Drop the rows of the wrapped lines that lost their first line, the lines left will be
+	// mapped again as a wrapped line of their own
+	while ( !mRows.empty() && mRows.back().firstId < mFirstId ) {
+		mMappedId = std::max<Uint64>( mMappedId, mRows.back().firstId + mRows.back().lines );
+		mRows.pop_back();
+	}
+}
+
+void TerminalHistory::invalidateCache() {
+	for ( auto& cached : mCache )
+		eeFree( cached.line );
+	mCache.clear();
+	mCacheNext = 0;
+	mCacheLast = 0;
+}
+
+void TerminalHistory::setCacheSize( size_t lines ) {
+	invalidateCache();
+	mCacheSize = std::max<size_t>( 1, lines );
+}
+
+void TerminalHistory::clear() {
+	for ( auto& hot : mHot )
+		eeFree( hot.line );
+	mHot.clear();
+	mBlocks.clear();
+	mOpen = OpenBlock{};
+	mDecoded = DecodedBlock{};
+	invalidateCache();
+	mFirstId = mNextId;
+	mRows.clear();
+	mReflowEndId = mMappedId = mNextId;
+}
+
+void TerminalHistory::setCompression( bool compress ) {
+	mCompress = compress;
+}
+
+void TerminalHistory::setColumns( int columns ) {
+	if ( columns == mColumns )
+		return;
+	mColumns = columns;
+	mReflowEndId = mMappedId = mNextId;
+	mRows.clear();
+	invalidateCache();
+}
+
+size_t TerminalHistory::getNativeRows() const {
+	return mNextId - std::max( mReflowEndId, mFirstId );
+}
+
+size_t TerminalHistory::size() const {
+	return getNativeRows() + mRows.size() + ( mMappedId > mFirstId ? mMappedId - mFirstId : 0 );
+}
+
+std::string_view TerminalHistory::getEncodedLine( Uint64 id ) const {
+	if ( !mOpen.offsets.empty() && id >= mOpen.firstId ) {
+		size_t i = id - mOpen.firstId;
+		size_t end = i + 1 < mOpen.offsets.size() ? mOpen.offsets[i + 1] : mOpen.data.size();
+		return std::string_view( mOpen.data ).substr( mOpen.offsets[i], end - mOpen.offsets[i] );
+	}
+
+	auto it = std::upper_bound(
+		mBlocks.begin(), mBlocks.end(), id,
+		[]( const Uint64& id, const std::shared_ptr<const Block>& block ) {
+			return id < block->firstId;
+		} );
+	if ( it == mBlocks.begin() )
+		return {};
+	const auto& block = *( --it );
+	if ( id >= block->firstId + block->count )
+		return {};
+
+	if ( mDecoded.block != block ) {
+		mDecoded.block = block;
+		if ( block->compressed ) {
+			mDecoded.data.resize( block->rawSize );
+			Compression::decompress( (Uint8*)mDecoded.data.data(), mDecoded.data.size(),
+									 (const Uint8*)block->data.data(), block->data.size() );
+		} else {
+			mDecoded.data = block->data;
+		}
+		mDecoded.offsets = indexBlock( mDecoded.data, block->count );
+	}
+
+	size_t i = id - block->firstId;
+	size_t end = i + 1 < mDecoded.offsets.size() ? mDecoded.offsets[i + 1] : mDecoded.data.size();
+	return std::string_view( mDecoded.data )
+		.substr( mDecoded.offsets[i], end - mDecoded.offsets[i] );
+}
+
+Line TerminalHistory::getCachedLine( Uint64 id, Uint32 start, int columns, bool& found ) {
+	found = true;
+
+	if ( mCacheLast < mCache.size() && mCache[mCacheLast].id == id &&
+		 mCache[mCacheLast].start == start && mCache[mCacheLast].columns == columns )
+		return mCache[mCacheLast].line;
+
+	for ( size_t i = 0; i < mCache.size(); i++ ) {
+		if ( mCache[i].id == id && mCache[i].start == start && mCache[i].columns == columns ) {
+			mCacheLast = i;
+			return mCache[i].line;
+		}
+	}
+
+	found = false;
+
+	if ( mCache.size() < mCacheSize ) {
+		mCache.push_back( { id, start, columns, allocLine( columns ) } );
+		mCacheNext = mCache.size() % mCacheSize;
+		mCacheLast = mCache.size() - 1;
+		return mCache.back().line;
+	}
+
+	CachedLine& cached = mCache[mCacheNext];
+	mCacheLast = mCacheNext;
+	mCacheNext = ( mCacheNext + 1 ) % mCache.size();
+	if ( cached.columns != columns )
+		cached.line = (Line)eeRealloc( cached.line, columns * sizeof( TerminalGlyph ) );
+	cached.id = id;
+	cached.start = start;
+	cached.columns = columns;
+	return cached.line;
+}
+
+Line TerminalHistory::getNativeLine( Uint64 id, int columns ) {
+	Uint64 hotFirstId = mNextId - mHot.size();
+	bool found;
+
+	if ( id >= hotFirstId ) {
+		HotLine& hot = mHot[id - hotFirstId];
+		if ( hot.columns == columns )
+			return hot.line;
+
+		Line line = getCachedLine( id, NATIVE_ROW, columns, found );
+		if ( !found ) {
+			int x = std::min( hot.columns, columns );
+			memcpy( line, hot.line, x * sizeof( TerminalGlyph ) );
+			TerminalGlyph blank = hot.line[hot.columns - 1];
+			blank.mode &= ~ATTR_WRAP;
+			blank.u = ' ';
+			for ( ; x < columns; x++ )
+				line[x] = blank;
+		}
+		return line;
+	}
+
+	Line line = getCachedLine( id, NATIVE_ROW, columns, found );
+	if ( !found )
+		decodeLine( getEncodedLine( id ), line, columns );
+	return line;
+}
+
+Line TerminalHistory::getReflowedRow( size_t k, int columns ) {
+	const Row& row = mRows[k];
+	bool last = k == 0 || mRows[k - 1].firstId != row.firstId;
+
+	if ( row.lines == 1 && row.start == 0 && last )
+		return getNativeLine( row.id, columns );
+
+	bool found;
+	Line line = getCachedLine( row.firstId, row.start, columns, found );
+	if ( found )
+		return line;
+
+	mCells.clear();
+	getWrappedCells( row.firstId, row.lines, mCells );
+
+	size_t end = last ? mCells.size() : mRows[k - 1].start;
+	int x = 0;
+	for ( size_t i = row.start; i < end && x < columns; i++, x++ ) {
+		line[x] = mCells[i];
+		line[x].mode &= ~ATTR_WRAP;
+	}
+
+	TerminalGlyph blank = x > 0 ? line[x - 1] : TerminalGlyph{};
+	blank.mode &= ~( ATTR_WRAP | ATTR_WIDE | ATTR_WDUMMY );
+	blank.u = ' ';
+	for ( ; x < columns; x++ )
+		line[x] = blank;
+
+	if ( !last || isLineWrapped( row.firstId + row.lines - 1 ) )
+		line[columns - 1].mode |= ATTR_WRAP;
+
+	return line;
+}
+
+Line TerminalHistory::getLine( size_t index, int columns ) {
+	size_t native = getNativeRows();
+	if ( index < native )
+		return getNativeLine( mNextId - 1 - index, columns );
+
+	size_t k = index - native;
+	while ( k >= mRows.size() && mapRows() )
+		;
+
+	if ( k < mRows.size() )
+		return getReflowedRow( k, columns );
+
+	// Less rows than estimated before the lines were re-wrapped
+	bool found;
+	Line line = getCachedLine( ~(Uint64)0, 0, columns, found );
+	if ( !found ) {
+		for ( int x = 0; x < columns; x++ ) {
+			line[x] = TerminalGlyph{};
+			line[x].u = ' ';
+		}
+	}
+	return line;
+}
+
+Uint64 TerminalHistory::getRowLineId( size_t index ) {
+	size_t native = getNativeRows();
+	if ( index < native )
+		return mNextId - 1 - index;
+
+	size_t k = index - native;
+	while ( k >= mRows.size() && mapRows() )
+		;
+	return k < mRows.size() ? mRows[k].id : mFirstId;
+}
+
+bool TerminalHistory::getRowPosition( Uint64 id, int column, size_t& index, int& rowColumn ) {
+	if ( id < mFirstId || id >= mNextId )
+		return false;
+
+	size_t native = getNativeRows();
+	if ( id >= std::max( mReflowEndId, mFirstId ) ) {
+		index = mNextId - 1 - id;
+		rowColumn = column;
+		return true;
+	}
+
+	while ( mMappedId > id && mapRows() )
+		;
+
+	// Rows are sorted from the newest to the oldest
+	auto it = std::partition_point( mRows.begin(), mRows.end(),
+									[id]( const Row& row ) { return row.firstId > id; } );
+	if ( it == mRows.end() )
+		return false;
+
+	Uint64 firstId = it->firstId;
+	Uint32 offset = column;
+	for ( Uint64 line = firstId; line < id; line++ )
+		offset += getLineColumns( line );
+
+	while ( it + 1 != mRows.end() && ( it + 1 )->firstId == firstId && it->start > offset )
+		++it;
+
+	index = native + ( it - mRows.begin() );
+	rowColumn = offset - it->start;
+	return true;
+}
+
+bool TerminalHistory::mapRows() {
+	if ( mMappedId <= mFirstId )
+		return false;
+
+	Uint64 lastId = mMappedId - 1;
+	Uint64 firstId = lastId;
+	while ( firstId > mFirstId && isLineWrapped( firstId - 1 ) )
+		firstId--;
+
+	Uint32 lines = lastId - firstId + 1;
+	int columns = std::max( 1, mColumns );
+
+	if ( lines == 1 && getLineLength( firstId ) <= columns ) {
+		mRows.push_back( { firstId, firstId, 0, 1 } );
+	} else {
+		std::vector<Uint32> starts;
+		mCells.clear();
+		getWrappedCells( firstId, lines, mCells, &starts );
+
+		std::vector<Row> rows;
+		rows.push_back( { firstId, firstId, 0, lines } );
+		size_t line = 0;
+		int x = 0;
+		for ( size_t i = 0; i < mCells.size(); i++ ) {
+			if ( mCells[i].mode & ATTR_WDUMMY )
+				continue;
+			int width = ( mCells[i].mode & ATTR_WIDE ) ? 2 : 1;
+			if ( x > 0 && x + width > columns ) {
+				while ( line + 1 < starts.size() && starts[line + 1] <= i )
+					line++;
+				rows.push_back( { firstId, firstId + line, (Uint32)i, lines } );
+				x = 0;
+			}
+			x += width;
+		}
+
+		for ( auto row = rows.rbegin(); row != rows.rend(); ++row )
+			mRows.push_back( *row );
+	}
+
+	mMappedId = firstId;
+	return true;
+}
+
+int TerminalHistory::getLineColumns( Uint64 id ) const {
+	Uint64 hotFirstId = mNextId - mHot.size();
+	if ( id >= hotFirstId )
+		return mHot[id - hotFirstId].columns;
+
+	std::string_view in( getEncodedLine( id ) );
+	size_t pos = 0;
+	return readVarint( in, pos );
+}
+
+int TerminalHistory::getLineLength( Uint64 id ) const {
+	Uint64 hotFirstId = mNextId - mHot.size();
+	if ( id >= hotFirstId ) {
+		const HotLine& hot = mHot[id - hotFirstId];
+		if ( hot.columns > 0 && ( hot.line[hot.columns - 1].mode & ATTR_WRAP ) )
+			return hot.columns;
+		int len = hot.columns;
+		while ( len > 0 && hot.line[len - 1].u == ' ' )
+			len--;
+		return len;
+	}
+
+	std::string_view in( getEncodedLine( id ) );
+	size_t pos = 0;
+	int columns = readVarint( in, pos );
+	if ( readVarint( in, pos ) & LINE_WRAPPED )
+		return columns;
+	return readVarint( in, pos );
+}
+
+void TerminalHistory::getWrappedCells( Uint64 firstId, Uint32 lines,
+									   std::vector<TerminalGlyph>& cells,
+									   std::vector<Uint32>* starts ) {
+	Uint64 hotFirstId = mNextId - mHot.size();
+
+	for ( Uint64 id = firstId; id < firstId + lines; id++ ) {
+		size_t offset = cells.size();
+		if ( starts )
+			starts->push_back( offset );
+
+		int length = getLineLength( id );
+
+		if ( id >= hotFirstId ) {
+			const HotLine& hot = mHot[id - hotFirstId];
+			cells.insert( cells.end(), hot.line, hot.line + length );
+		} else {
+			std::string_view in( getEncodedLine( id ) );
+			size_t pos = 0;
+			int columns = readVarint( in, pos );
+			cells.resize( offset + columns );
+			decodeLine( in, &cells[offset], columns );
+			cells.resize( offset + length );
+		}
+	}
+}
+
+std::string TerminalHistory::getLineText( Uint64 id, bool placeholders ) const {
+	Uint64 hotFirstId = mNextId - mHot.size();
+
+	if ( id >= hotFirstId ) {
+		const HotLine& hot = mHot[id - hotFirstId];
+		return getCellsText( hot.line, hot.columns, placeholders );
+	}
+
+	return decodeLineText( getEncodedLine( id ), placeholders );
+}
+
+std::string TerminalHistory::getCellsText( const TerminalGlyph* line, int columns,
+										   bool placeholders ) {
+	std::string text;
+	int len = columns;
+	while ( len > 0 && line[len - 1].u == ' ' )
+		len--;
+	for ( int i = 0; i < len; i++ )
+		if ( line[i].u || placeholders )
+			writeUtf8( text, line[i].u );
+	return text;
+}
+
+bool TerminalHistory::isLineWrapped( Uint64 id ) const {
+	Uint64 hotFirstId = mNextId - mHot.size();
+
+	if ( id >= hotFirstId ) {
+		const HotLine& hot = mHot[id - hotFirstId];
+		return hot.columns > 0 && ( hot.line[hot.columns - 1].mode & ATTR_WRAP );
+	}
+
+	std::string_view in( getEncodedLine( id ) );
+	size_t pos = 0;
+	readVarint( in, pos );
+	return readVarint( in, pos ) & LINE_WRAPPED;
+}
+
+size_t TerminalHistory::getMemoryUsage() const {
+	size_t usage = mOpen.data.capacity() + mOpen.offsets.capacity() * sizeof( Uint32 ) +
+				   mDecoded.data.capacity() + mDecoded.offsets.capacity() * sizeof( Uint32 );
+	for ( const auto& hot : mHot )
+		usage += hot.columns * sizeof( TerminalGlyph );
+	for ( const auto& cached : mCache )
+		usage += cached.columns * sizeof( TerminalGlyph );
+	for ( const auto& block : mBlocks )
+		usage += sizeof( Block ) + block->data.capacity();
+	usage += mRows.size() * sizeof( Row ) + mCells.capacity() * sizeof( TerminalGlyph );
+	return usage;
+}
+
+std::vector<std::shared_ptr<const TerminalHistory::Block>> TerminalHistory::getBlocks() const {
+	return { mBlocks.begin(), mBlocks.end() };
+}
+
+std::vector<std::string> TerminalHistory::getBlockText( const Block& block, bool placeholders ) {
+	std::string raw;
+	std::string_view data( block.data );
+	if ( block.compressed ) {
+		raw.resize( block.rawSize );
+		Compression::decompress( (Uint8*)raw.data(), raw.size(), (const Uint8*)block.data.data(),
+								 block.data.size() );
+		data = raw;
+	}
+	std::vector<Uint32> offsets( indexBlock( data, block.count ) );
+	std::vector<std::string> lines;
+	lines.reserve( offsets.size() );
+	for ( size_t i = 0; i < offsets.size(); i++ ) {
+		size_t end = i + 1 < offsets.size() ? offsets[i + 1] : data.size();
+		lines.emplace_back(
+			decodeLineText( data.substr( offsets[i], end - offsets[i] ), placeholders ) );
+	}
+	return lines;
+}
+
+void TerminalHistory::encodeLine( std::string& out, const TerminalGlyph* line, int columns ) {
+	int textCells = columns;
+	while ( textCells > 0 && line[textCells - 1].u == ' ' )
+		textCells--;
+
+	writeVarint( out, columns );
+	writeVarint( out, columns > 0 && ( line[columns - 1].mode & ATTR_WRAP ) ? LINE_WRAPPED : 0 );
+	writeVarint( out, textCells );
+
+	std::string text;
+	for ( int i = 0; i < textCells; i++ )
+		writeUtf8( text, line[i].u );
+	writeVarint( out, text.size() );
+	out += text;
+
+	std::string runs;
+	size_t runsCount = 0;
+	for ( int i = 0; i < columns; ) {
+		int start = i;
+		while ( i < columns && line[i].mode == line[start].mode && line[i].fg == line[start].fg &&
+				line[i].bg == line[start].bg )
+			i++;
+		writeVarint( runs, i - start );
+		writeVarint( runs, line[start].mode );
+		writeVarint( runs, line[start].fg );
+		writeVarint( runs, line[start].bg );
+		runsCount++;
+	}
+	writeVarint( out, runsCount );
+	out += runs;
+}
+
+void TerminalHistory::decodeLine( std::string_view in, Line line, int columns ) {
+	size_t pos = 0;
+	int storedColumns = readVarint( in, pos );
+	readVarint( in, pos );
+	int textCells = readVarint( in, pos );
+	size_t textBytes = readVarint( in, pos );
+	std::string_view text( in.substr( pos, textBytes ) );
+	pos += textBytes;
+
+	size_t textPos = 0;
+	for ( int i = 0; i < columns; i++ )
+		line[i].u = i < textCells && textPos < text.size() ? readUtf8( text, textPos ) : ' ';
+
+	TerminalGlyph attr;
+	size_t runsCount = readVarint( in, pos );
+	int x = 0;
+	for ( size_t r = 0; r < runsCount; r++ ) {
+		int length = readVarint( in, pos );
+		attr.mode = readVarint( in, pos );
+		attr.fg = readVarint( in, pos );
+		attr.bg = readVarint( in, pos );
+		for ( int end = std::min( x + length, columns ); x < end; x++ ) {
+			line[x].mode = attr.mode;
+			line[x].fg = attr.fg;
+			line[x].bg = attr.bg;
+		}
+	}
+
+	attr.mode &= ~ATTR_WRAP;
+	for ( x = std::min( storedColumns, x ); x < columns; x++ ) {
+		line[x].mode = attr.mode;
+		line[x].fg = attr.fg;
+		line[x].bg = attr.bg;
+	}
+}
+
+std::string TerminalHistory::decodeLineText( std::string_view in, bool placeholders ) {
+	size_t pos = 0;
+	readVarint( in, pos );
+	readVarint( in, pos );
+	readVarint( in, pos );
+	size_t textBytes = readVarint( in, pos );
+	if ( placeholders )
+		return std::string( in.substr( pos, textBytes ) );
+	std::string text;
+	text.reserve( textBytes );
+	for ( char c : in.substr( pos, textBytes ) )
+		if ( c )
+			text.push_back( c );
+	return text;
+}
+
+void TerminalHistory::indexBigrams( Block& block, std::string_view data,
+									const std::vector<Uint32>& offsets ) {
+	for ( size_t i = 0; i < offsets.size(); i++ ) {
+		size_t end = i + 1 < offsets.size() ? offsets[i + 1] : data.size();
+		std::string text( decodeLineText( data.substr( offsets[i], end - offsets[i] ) ) );
+		for ( size_t c = 1; c < text.size(); c++ ) {
+			Uint32 bit = bigramBit( foldAscii( text[c - 1] ), foldAscii( text[c] ) );
+			block.bigrams[bit >> 6] |= (Uint64)1 << ( bit & 63 );
+		}
+	}
+}
+
+bool TerminalHistory::Block::mayContain( std::string_view text ) const {
+	for ( size_t c = 1; c < text.size(); c++ ) {
+		Uint32 bit = bigramBit( foldAscii( text[c - 1] ), foldAscii( text[c] ) );
+		if ( !( bigrams[bit >> 6] & ( (Uint64)1 << ( bit & 63 ) ) ) )
+			return false;
+	}
+	return true;
+}
+
+std::vector<Uint32> TerminalHistory::indexBlock( std::string_view data, size_t count ) {
+	std::vector<Uint32> offsets;
+	offsets.reserve( count );
+	size_t pos = 0;
+	while ( offsets.size() < count && pos < data.size() ) {
+		offsets.push_back( pos );
+		readVarint( data, pos );
+		readVarint( data, pos );
+		readVarint( data, pos );
+		pos += readVarint( data, pos );
+		size_t runsCount = readVarint( data, pos );
+		for ( size_t r = 0; r < runsCount * 4; r++ )
+			readVarint( data, pos );
+	}
+	return offsets;
+}
+
+}} // namespace eterm::Terminal
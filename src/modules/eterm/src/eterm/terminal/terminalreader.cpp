@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <eterm/terminal/terminalreader.hpp>
+
+namespace eterm { namespace Terminal {
+
+/* How long the reader sleeps when the ring is full or the pty has nothing to read */
+static constexpr int FULL_WAIT_MS = 1;
+static constexpr int IDLE_WAIT_MS = 10;
+
+static size_t nextPowerOfTwo( size_t n ) {
+	size_t p = 1;
+	while ( p < n )
+		p <<= 1;
+	return p;
+}
+
+TerminalReader::TerminalReader( IPseudoTerminal* pty, size_t capacity ) :
+	mPty( pty ), mBuffer( nextPowerOfTwo( std::max<size_t>( capacity, 4096 ) ) ) {
+	mMask = mBuffer.size() - 1;
+}
+
+TerminalReader::~TerminalReader() {
+	stop();
+}
+
+void TerminalReader::start() {
+	if ( mRunning || mFailed )
+		return;
+	mRunning = true;
+	mThread = std::thread( &TerminalReader::run, this );
+}
+
+void TerminalReader::stop() {
+	mRunning = false;
+	if ( mThread.joinable() )
+		mThread.join();
+}
+
+size_t TerminalReader::available() const {
+	return mHead.load( std::memory_order_acquire ) - mTail.load( std::memory_order_relaxed );
+}
+
+int TerminalReader::read( char* buf, size_t n ) {
+	size_t tail = mTail.load( std::memory_order_relaxed );
+	size_t len = std::min( n, mHead.load( std::memory_order_acquire ) - tail );
+
+	if ( len == 0 ) {
+		if ( mFailed.load( std::memory_order_acquire ) ) {
+			errno = mError;
+			return -1;
+		}
+		return 0;
+	}
+
+	size_t pos = tail & mMask;
+	size_t first = std::min( len, mBuffer.size() - pos );
+	memcpy( buf, mBuffer.data() + pos, first );
+	if ( first < len )
+		memcpy( buf + first, mBuffer.data(), len - first );
+
+	mTail.store( tail + len, std::memory_order_release );
+	return (int)len;
+}
+
+void TerminalReader::run() {
+	while ( mRunning ) {
+		size_t head = mHead.load( std::memory_order_relaxed );
+		size_t used = head - mTail.load( std::memory_order_acquire );
+
+		if ( used == mBuffer.size() ) {
+			// Backpressure: leave the data in the kernel until the consumer catches up
+			std::this_thread::sleep_for( std::chrono::milliseconds( FULL_WAIT_MS ) );
+			continue;
+		}
+
+		size_t pos = head & mMask;
+		size_t space = std::min( mBuffer.size() - used, mBuffer.size() - pos );
+		int ret = mPty->read( mBuffer.data() + pos, space, false );
+
+		if ( ret > 0 ) {
+			mHead.store( head + ret, std::memory_order_release );
+		} else if ( ret == 0 ) {
+			mPty->waitForData( IDLE_WAIT_MS );
+		} else {
+			mError = errno;
+			mFailed.store( true, std::memory_order_release );
+			mRunning = false;
+		}
+	}
+}
+
+}} // namespace eterm::Terminal
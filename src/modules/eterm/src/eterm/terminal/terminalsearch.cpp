@@ -0,0 +1,148 @@
+#include <eterm/terminal/terminalsearch.hpp>
+#include <regex>
+#include <string_view>
+
+namespace eterm { namespace Terminal {
+
+static void foldAscii( std::string& str ) {
+	for ( char& c : str )
+		if ( c >= 'A' && c <= 'Z' )
+			c += 'a' - 'A';
+}
+
+static int countCodePoints( const char* str, size_t len ) {
+	int count = 0;
+	for ( size_t i = 0; i < len; i++ )
+		if ( ( str[i] & 0xC0 ) != 0x80 )
+			count++;
+	return count;
+}
+
+namespace {
+
+// Matches the query against the text of a line. The line text has a placeholder after every
+// wide character, so a code point is a cell. The placeholders are removed before matching,
+// the positions of the matches are then mapped back to cells.
+class LineMatcher {
+  public:
+	explicit LineMatcher( const TerminalSearchQuery& query ) : mQuery( query ) {
+		if ( mQuery.regex ) {
+			auto flags = std::regex_constants::ECMAScript | std::regex_constants::optimize;
+			if ( !mQuery.caseSensitive )
+				flags |= std::regex_constants::icase;
+			mRegex = std::regex( mQuery.text, flags );
+		} else {
+			mNeedle = mQuery.text;
+			if ( !mQuery.caseSensitive )
+				foldAscii( mNeedle );
+		}
+	}
+
+	void match( Uint64 id, const std::string& line, std::vector<TerminalSearchHit>& hits ) {
+		const std::string* text = &line;
+		bool hasPlaceholders = line.find( '\0' ) != std::string::npos;
+
+		if ( hasPlaceholders ) {
+			mStripped.clear();
+			mMap.clear();
+			for ( size_t i = 0; i < line.size(); i++ ) {
+				if ( line[i] ) {
+					mStripped.push_back( line[i] );
+					mMap.push_back( i );
+				}
+			}
+			text = &mStripped;
+		}
+
+		auto addHit = [&]( size_t start, size_t end ) {
+			size_t cellStart = start;
+			size_t cellEnd = end;
+			if ( hasPlaceholders ) {
+				cellStart = mMap[start];
+				cellEnd = mMap[end - 1] + 1;
+				if ( cellEnd < line.size() && line[cellEnd] == '\0' )
+					cellEnd++;
+			}
+			hits.push_back( { id, countCodePoints( line.data(), cellStart ),
+							  countCodePoints( line.data() + cellStart, cellEnd - cellStart ) } );
+		};
+
+		if ( mQuery.regex ) {
+			std::cregex_iterator it( text->data(), text->data() + text->size(), mRegex );
+			for ( ; it != std::cregex_iterator(); ++it ) {
+				if ( it->length( 0 ) > 0 )
+					addHit( it->position( 0 ), it->position( 0 ) + it->length( 0 ) );
+			}
+			return;
+		}
+
+		std::string_view haystack( *text );
+		if ( !mQuery.caseSensitive ) {
+			mFolded.assign( *text );
+			foldAscii( mFolded );
+			haystack = mFolded;
+		}
+
+		for ( size_t pos = haystack.find( mNeedle ); pos != std::string_view::npos;
+			  pos = haystack.find( mNeedle, pos + mNeedle.size() ) )
+			addHit( pos, pos + mNeedle.size() );
+	}
+
+  protected:
+	const TerminalSearchQuery& mQuery;
+	std::regex mRegex;
+	std::string mNeedle;
+	std::string mStripped;
+	std::string mFolded;
+	std::vector<size_t> mMap;
+};
+
+} // namespace
+
+TerminalSearch::Result TerminalSearch::search( const TerminalSearchSnapshot& snapshot,
+											   const TerminalSearchQuery& query,
+											   const std::atomic<bool>* cancel ) {
+	Result result;
+
+	if ( query.text.empty() )
+		return result;
+
+	auto isCancelled = [&]() {
+		if ( cancel && *cancel )
+			result.cancelled = true;
+		return result.cancelled;
+	};
+
+	try {
+		LineMatcher matcher( query );
+
+		for ( const auto& block : snapshot.blocks ) {
+			if ( isCancelled() )
+				return result;
+
+			if ( block->firstId + block->count <= snapshot.firstId ||
+				 ( !query.regex && !block->mayContain( query.text ) ) )
+				continue;
+
+			auto lines( TerminalHistory::getBlockText( *block, true ) );
+			for ( size_t i = 0; i < lines.size(); i++ ) {
+				Uint64 id = block->firstId + i;
+				if ( id >= snapshot.firstId )
+					matcher.match( id, lines[i], result.hits );
+			}
+		}
+
+		for ( size_t i = 0; i < snapshot.lines.size(); i++ ) {
+			if ( ( i % 1024 ) == 0 && isCancelled() )
+				return result;
+			matcher.match( snapshot.linesFirstId + i, snapshot.lines[i], result.hits );
+		}
+	} catch ( const std::regex_error& err ) {
+		result.hits.clear();
+		result.error = err.what();
+	}
+
+	return result;
+}
+
+}} // namespace eterm::Terminal
@@ -1,5 +1,7 @@
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/system/luapattern.hpp>
+#include <eepp/system/sys.hpp>
+#include <eepp/system/threadpool.hpp>
 #include <eepp/ui/uieventdispatcher.hpp>
 #include <eepp/ui/uiicon.hpp>
 #include <eepp/ui/uiscenenode.hpp>
@@ -8,6 +10,7 @@
 #include <eepp/window/engine.hpp>
 #include <eepp/window/input.hpp>
 #include <eterm/ui/uiterminal.hpp>
+#include <limits>
 
 using namespace EE::Scene;
 
@@ -28,7 +31,17 @@ UITerminal* UITerminal::New( const std::shared_ptr<TerminalDisplay>& terminalDis
 	return eeNew( UITerminal, ( terminalDisplay ) );
 }
 
-UITerminal::~UITerminal() {}
+UITerminal::~UITerminal() {
+	if ( mSearchCancel )
+		*mSearchCancel = true;
+
+	if ( getUISceneNode()->hasThreadPool() )
+		getUISceneNode()->getThreadPool()->removeWithTag( reinterpret_cast<Uint64>( this ) );
+
+	// Wait for the search running in the thread pool, if any
+	while ( mSearchProcessing )
+		Sys::sleep( Milliseconds( 0.1 ) );
+}
 
 Uint32 UITerminal::getType() const {
 	return UI_TYPE_TERMINAL;
@@ -99,6 +112,8 @@ UITerminal::UITerminal( const std::shared_ptr<TerminalDisplay>& terminalDisplay
 	setCommand( "terminal-copy", [this] { mTerm->action( TerminalShortcutAction::COPY ); } );
 	setCommand( "terminal-open-link",
 				[this] { Engine::instance()->openURI( mTerm->getTerminal()->getSelection() ); } );
+	setCommand( "terminal-find-next", [this] { findNext(); } );
+	setCommand( "terminal-find-prev", [this] { findPrev(); } );
 	subscribeScheduledUpdate();
 }
 
@@ -597,4 +612,128 @@ bool UITerminal::onCreateContextMenu( const Vector2i& position, const Uint32& fl
 	return true;
 }
 
+void UITerminal::find( const TerminalSearchQuery& query, const SearchCallback& onDone ) {
+	if ( !mTerm || !mTerm->getTerminal() )
+		return;
+
+	if ( mSearchCancel )
+		*mSearchCancel = true;
+
+	mSearchQuery = query;
+	mSearchId++;
+
+	if ( !getUISceneNode()->hasThreadPool() ) {
+		onSearchDone( mSearchId, mTerm->getTerminal()->search( query ), onDone );
+		return;
+	}
+
+	Uint64 searchId = mSearchId;
+	auto cancel = std::make_shared<std::atomic<bool>>( false );
+	auto snapshot =
+		std::make_shared<TerminalSearchSnapshot>( mTerm->getTerminal()->getSearchSnapshot() );
+	mSearchCancel = cancel;
+	mSearchProcessing++;
+
+	getUISceneNode()->getThreadPool()->run(
+		[this, searchId, cancel, snapshot, query, onDone] {
+			auto result = std::make_shared<TerminalSearch::Result>(
+				TerminalSearch::search( *snapshot, query, cancel.get() ) );
+			if ( !result->cancelled ) {
+				runOnMainThread( [this, searchId, result, onDone] {
+					onSearchDone( searchId, std::move( *result ), onDone );
+				} );
+			}
+		},
+		[this]( const Uint64& ) { mSearchProcessing--; }, reinterpret_cast<Uint64>( this ) );
+}
+
+void UITerminal::onSearchDone( Uint64 searchId, TerminalSearch::Result&& result,
+							   const SearchCallback& onDone ) {
+	if ( searchId != mSearchId )
+		return;
+
+	mSearchCancel.reset();
+	mSearchHits = std::move( result.hits );
+	pruneSearchHits();
+
+	if ( !mSearchHits.empty() ) {
+		// Start from the newest hit that is not below the view
+		const auto& terminal = mTerm->getTerminal();
+		TerminalSearchHit lastVisible{ terminal->getLineId( terminal->rowCount() - 1 ),
+									   std::numeric_limits<int>::max(), 0 };
+		auto it = std::upper_bound( mSearchHits.begin(), mSearchHits.end(), lastVisible );
+		mSearchHitIndex = it == mSearchHits.begin() ? 0 : it - mSearchHits.begin() - 1;
+		showSearchHit( mSearchHitIndex );
+	}
+
+	result.hits = mSearchHits;
+	if ( onDone )
+		onDone( result );
+}
+
+void UITerminal::pruneSearchHits() {
+	size_t invalid = 0;
+	while ( invalid < mSearchHits.size() &&
+			!mTerm->getTerminal()->isSearchHitValid( mSearchHits[invalid] ) )
+		invalid++;
+
+	if ( invalid == 0 )
+		return;
+
+	mSearchHits.erase( mSearchHits.begin(), mSearchHits.begin() + invalid );
+	mSearchHitIndex = mSearchHitIndex >= invalid ? mSearchHitIndex - invalid : 0;
+}
+
+bool UITerminal::showSearchHit( size_t index ) {
+	if ( index >= mSearchHits.size() ||
+		 !mTerm->getTerminal()->showSearchHit( mSearchHits[index] ) )
+		return false;
+	mTerm->invalidate();
+	updateScrollPosition();
+	invalidateDraw();
+	return true;
+}
+
+bool UITerminal::findNext() {
+	if ( !mTerm || !mTerm->getTerminal() )
+		return false;
+	pruneSearchHits();
+	if ( mSearchHits.empty() )
+		return false;
+	mSearchHitIndex = ( mSearchHitIndex + 1 ) % mSearchHits.size();
+	return showSearchHit( mSearchHitIndex );
+}
+
+bool UITerminal::findPrev() {
+	if ( !mTerm || !mTerm->getTerminal() )
+		return false;
+	pruneSearchHits();
+	if ( mSearchHits.empty() )
+		return false;
+	mSearchHitIndex = mSearchHitIndex == 0 ? mSearchHits.size() - 1 : mSearchHitIndex - 1;
+	return showSearchHit( mSearchHitIndex );
+}
+
+void UITerminal::clearSearch() {
+	if ( mSearchCancel )
+		*mSearchCancel = true;
+	mSearchCancel.reset();
+	mSearchId++;
+	mSearchHits.clear();
+	mSearchHitIndex = 0;
+	mSearchQuery = {};
+}
+
+bool UITerminal::isSearching() const {
+	return mSearchCancel != nullptr;
+}
+
+const TerminalSearchQuery& UITerminal::getSearchQuery() const {
+	return mSearchQuery;
+}
+
+const std::vector<TerminalSearchHit>& UITerminal::getSearchHits() const {
+	return mSearchHits;
+}
+
 }} // namespace eterm::UI
@@ -0,0 +1,413 @@
+#include <args/args.hxx>
+#include <atomic>
+#include <eepp/ee.hpp>
+#include <eterm/system/iprocess.hpp>
+#include <eterm/terminal/ipseudoterminal.hpp>
+#include <eterm/terminal/iterminaldisplay.hpp>
+#include <eterm/terminal/terminalemulator.hpp>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+
+using namespace eterm::Terminal;
+
+// Counts the heap allocations done through operator new. The screen and history lines are
+// allocated with malloc, so they are not counted.
+static std::atomic<size_t> sAllocations{ 0 };
+static std::atomic<size_t> sAllocatedBytes{ 0 };
+
+void* operator new( std::size_t size ) {
+	sAllocations.fetch_add( 1, std::memory_order_relaxed );
+	sAllocatedBytes.fetch_add( size, std::memory_order_relaxed );
+	if ( void* ptr = malloc( size ? size : 1 ) )
+		return ptr;
+	throw std::bad_alloc();
+}
+
+#if defined( __GNUC__ ) && !defined( __clang__ ) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete( void* ptr ) noexcept {
+	free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept {
+	free( ptr );
+}
+
+// Feeds a recorded PTY stream to the emulator in the chunk sizes a real PTY would deliver
+class ReplayPseudoTerminal : public IPseudoTerminal {
+  public:
+	ReplayPseudoTerminal( const std::string& data, int columns, int rows ) :
+		mData( data ), mColumns( columns ), mRows( rows ) {}
+
+	virtual int getNumColumns() const { return mColumns; }
+
+	virtual int getNumRows() const { return mRows; }
+
+	virtual bool resize( int columns, int rows ) {
+		mColumns = columns;
+		mRows = rows;
+		return true;
+	}
+
+	virtual bool isTTY() const { return true; }
+
+	virtual int write( const char*, size_t n ) { return (int)n; }
+
+	virtual int read( char* buf, size_t n, bool ) {
+		size_t len = eemin( n, mData.size() - mPos );
+		memcpy( buf, mData.data() + mPos, len );
+		mPos += len;
+		return (int)len;
+	}
+
+	bool eof() const { return mPos >= mData.size(); }
+
+	void rewind() { mPos = 0; }
+
+  protected:
+	const std::string& mData;
+	size_t mPos{ 0 };
+	int mColumns;
+	int mRows;
+};
+
+class NullProcess : public eterm::System::IProcess {
+  public:
+	virtual void checkExitStatus() {}
+
+	virtual bool hasExited() const { return false; }
+
+	virtual int getExitCode() const { return 0; }
+
+	virtual void terminate() {}
+
+	virtual void waitForExit() {}
+};
+
+// Discards the frames, unless it's asked to hash the next one: the hash covers every cell of
+// the screen, the cursor and the window title, so two emulators that end in the same state
+// produce the same hash.
+class NullTerminalDisplay : public ITerminalDisplay {
+  public:
+	void hashNextFrame() {
+		mHashing = true;
+		mHash = FNV_OFFSET;
+	}
+
+	Uint64 getHash() const { return mHash; }
+
+	virtual void setTitle( const char* title ) { mTitle = title ? title : ""; }
+
+	virtual bool drawBegin( Uint32 columns, Uint32 rows ) {
+		if ( mHashing ) {
+			hash( columns );
+			hash( rows );
+			hash( mTitle.data(), mTitle.size() );
+		}
+		return true;
+	}
+
+	virtual void drawLine( Line line, int x1, int y, int x2 ) {
+		if ( !mHashing )
+			return;
+		hash( y );
+		for ( int x = x1; x < x2; x++ ) {
+			hash( line[x].u );
+			hash( line[x].mode );
+			hash( line[x].fg );
+			hash( line[x].bg );
+		}
+	}
+
+	virtual void drawCursor( int cx, int cy, TerminalGlyph, int, int, TerminalGlyph ) {
+		if ( mHashing ) {
+			hash( cx );
+			hash( cy );
+		}
+	}
+
+	virtual void drawEnd() { mHashing = false; }
+
+  protected:
+	static constexpr Uint64 FNV_OFFSET = 14695981039346656037ULL;
+	static constexpr Uint64 FNV_PRIME = 1099511628211ULL;
+	bool mHashing{ false };
+	Uint64 mHash{ FNV_OFFSET };
+	std::string mTitle;
+
+	void hash( const void* data, size_t size ) {
+		const Uint8* bytes = static_cast<const Uint8*>( data );
+		for ( size_t i = 0; i < size; i++ )
+			mHash = ( mHash ^ bytes[i] ) * FNV_PRIME;
+	}
+
+	template <typename T> void hash( T value ) {
+		Uint64 v = static_cast<Uint64>( value );
+		hash( &v, sizeof( v ) );
+	}
+};
+
+// The generated workloads only use the raw output of the engine, so they are the same on every
+// platform and their hashes can be kept as a baseline.
+static std::string generateBuildLog( size_t size ) {
+	static const char* lines[] = {
+		"[ 42%] Building CXX object src/CMakeFiles/eepp.dir/eepp/ui/uinode.cpp.o\r\n",
+		"src/eepp/ui/uinode.cpp:128:9: warning: unused variable 'size' [-Wunused-variable]\r\n",
+		"  128 |         Sizef size = getPixelsSize();\r\n",
+		"      |         ^~~~\r\n",
+		"\033[1m\033[32m[ 43%] Linking CXX static library libeepp.a\033[0m\r\n",
+	};
+	std::string data;
+	data.reserve( size );
+	for ( size_t i = 0; data.size() < size; ++i )
+		data += lines[i % eeARRAY_SIZE( lines )];
+	return data;
+}
+
+// A large `cat` of UTF-8 text: long lines that wrap, tabs and wide characters
+static std::string generateCat( size_t size ) {
+	static const char* words[] = { "terminal", "emulator", "scrollback", "\xc3\xa9l\xc3\xa8ve",
+								   "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", "glyph", "\t",
+								   "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82" };
+	std::mt19937 rng( 1 );
+	std::string data;
+	data.reserve( size );
+	while ( data.size() < size ) {
+		size_t count = 1 + rng() % 48;
+		for ( size_t i = 0; i < count; i++ ) {
+			data += words[rng() % eeARRAY_SIZE( words )];
+			data += ' ';
+		}
+		data += "\r\n";
+	}
+	return data;
+}
+
+// Full screen frames of a process monitor: cursor addressing, colors and line erasing
+static std::string generateTopFrames( size_t size, int columns, int rows ) {
+	std::mt19937 rng( 2 );
+	std::string data( "\033[?1049h\033[?25l" );
+	data.reserve( size );
+	for ( Uint64 frame = 0; data.size() < size; frame++ ) {
+		data += "\033[H\033[1;37;44m";
+		data += String::format( "%-*s", columns,
+								"  PID USER      PRI  NI  VIRT   RES S CPU% MEM%" );
+		data += "\033[0m";
+		for ( int y = 2; y <= rows; y++ ) {
+			Uint32 cpu = rng() % 1000;
+			data += String::format( "\033[%d;1H\033[%dm%5u\033[0m user       20   0 %5uM %4uM "
+									"\033[1;32mR\033[0m %3u.%u %4.1f \033[36mproc-%llu\033[K",
+									y, cpu > 500 ? 31 : 39, (unsigned)( rng() % 99999 ),
+									(unsigned)( rng() % 8192 ), (unsigned)( rng() % 4096 ),
+									cpu / 10, cpu % 10, ( rng() % 1000 ) / 10.,
+									(unsigned long long)( frame + y ) );
+		}
+	}
+	data += "\033[?25h\033[?1049l";
+	return data;
+}
+
+// Control sequences exercised by vttest: scrolling regions, line and character insertion and
+// deletion, erasing, saved cursors, tab stops, origin mode and the line drawing charset
+static std::string generateControlSequences( size_t size ) {
+	static const char* sequences[] = {
+		"\033[5;20r", "\033[r", "\033[3L", "\033[2M", "\033[4@", "\033[3P", "\033[7X", "\0337",
+		"\0338", "\033[?6h", "\033[?6l", "\033D", "\033M", "\033E", "\033H", "\033[3g", "\033[J",
+		"\033[1K", "\033(0", "\033(B", "\033[?7l", "\033[?7h", "\033[4h", "\033[4l", "\033[2b",
+		"\033[7m", "\033[0m", "\033]0;title\a", "\t", "\b", "\r\n", "lqqqk", "x  x", "mqqqj",
+		"0123456789", "\033[3S", "\033[2T", "\033[10G", "\033[5d", "\033[2A", "\033[3B", "\033[4C",
+		"\033[2D", "\033[38;5;196m", "\033[48;2;10;20;30m", "\033[1;4;9m", "\033#8",
+	};
+	std::mt19937 rng( 3 );
+	std::string data;
+	data.reserve( size );
+	while ( data.size() < size ) {
+		data += String::format( "\033[%u;%uH", (unsigned)( 1 + rng() % 40 ),
+								(unsigned)( 1 + rng() % 120 ) );
+		for ( size_t i = 0; i < 8; i++ )
+			data += sequences[rng() % eeARRAY_SIZE( sequences )];
+	}
+	return data;
+}
+
+struct Workload {
+	std::string name;
+	std::string data;
+};
+
+struct Report {
+	double megabytes{ 0 };
+	double seconds{ 0 };
+	size_t allocations{ 0 };
+	size_t allocatedBytes{ 0 };
+	Uint64 hash{ 0 };
+};
+
+static Report replay( const Workload& workload, int columns, int rows, int iterations ) {
+	auto pty = std::make_unique<ReplayPseudoTerminal>( workload.data, columns, rows );
+	auto replay = pty.get();
+	auto display = std::make_shared<NullTerminalDisplay>();
+	auto emulator =
+		TerminalEmulator::create( std::move( pty ), std::make_unique<NullProcess>(), display );
+	Report report;
+	Time elapsed;
+
+	for ( int i = 0; i < iterations; ++i ) {
+		size_t allocations = sAllocations;
+		size_t allocatedBytes = sAllocatedBytes;
+		Clock clock;
+
+		replay->rewind();
+		while ( !replay->eof() )
+			emulator->update();
+
+		elapsed += clock.getElapsedTime();
+		report.allocations += sAllocations - allocations;
+		report.allocatedBytes += sAllocatedBytes - allocatedBytes;
+
+		// The screen of the first pass is the one that matches a replay in a fresh terminal
+		if ( i == 0 ) {
+			display->hashNextFrame();
+			emulator->redraw();
+			report.hash = display->getHash();
+		}
+	}
+
+	report.megabytes = (double)workload.data.size() * iterations / ( 1024. * 1024. );
+	report.seconds = elapsed.asSeconds();
+	report.allocations /= iterations;
+	report.allocatedBytes /= iterations;
+	return report;
+}
+
+static std::map<std::string, std::string> loadBaseline( const std::string& path ) {
+	std::map<std::string, std::string> baseline;
+	std::string data;
+	if ( !FileSystem::fileGet( path, data ) )
+		return baseline;
+	for ( const auto& line : String::split( data, '\n' ) ) {
+		auto parts = String::split( line, ' ' );
+		if ( parts.size() == 2 )
+			baseline[parts[0]] = parts[1];
+	}
+	return baseline;
+}
+
+EE_MAIN_FUNC int main( int argc, char* argv[] ) {
+	args::ArgumentParser parser( "eterm-perf-test",
+								 "Replays terminal output through the emulator without a window "
+								 "and reports the throughput, allocations and final screen hash of "
+								 "each capture. Without captures it replays generated workloads." );
+	args::HelpFlag help( parser, "help", "Display this help menu", { 'h', "help" } );
+	args::ValueFlag<int> iterationsFlag( parser, "iterations", "Replays of each capture",
+										 { 'i', "iterations" }, 5 );
+	args::ValueFlag<int> columnsFlag( parser, "columns", "Terminal columns", { "columns" }, 160 );
+	args::ValueFlag<int> rowsFlag( parser, "rows", "Terminal rows", { "rows" }, 50 );
+	args::ValueFlag<size_t> sizeFlag( parser, "size", "Size of each generated workload (MiB)",
+									  { "size" }, 16 );
+	args::ValueFlag<std::string> baselineFlag(
+		parser, "baseline",
+		"File with the expected screen hashes, the run fails if a hash doesn't match",
+		{ 'b', "baseline" } );
+	args::Flag updateBaselineFlag( parser, "update-baseline",
+								   "Write the screen hashes to the baseline file",
+								   { "update-baseline" } );
+	args::PositionalList<std::string> captures( parser, "captures",
+												"Files with the raw output of a program" );
+
+	try {
+		parser.ParseCLI( argc, argv );
+	} catch ( const args::Help& ) {
+		std::cout << parser;
+		return EXIT_SUCCESS;
+	} catch ( const args::ParseError& e ) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return EXIT_FAILURE;
+	} catch ( args::ValidationError& e ) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return EXIT_FAILURE;
+	}
+
+	int iterations = eemax( 1, iterationsFlag.Get() );
+	int columns = eemax( 2, columnsFlag.Get() );
+	int rows = eemax( 2, rowsFlag.Get() );
+	size_t size = eemax<size_t>( 1, sizeFlag.Get() ) * 1024 * 1024;
+	std::vector<Workload> workloads;
+
+	if ( captures ) {
+		for ( const auto& path : args::get( captures ) ) {
+			Workload workload{ FileSystem::fileNameFromPath( path ), "" };
+			if ( !FileSystem::fileGet( path, workload.data ) ) {
+				std::cerr << "Couldn't read " << path << std::endl;
+				return EXIT_FAILURE;
+			}
+			workloads.emplace_back( std::move( workload ) );
+		}
+	} else {
+		workloads.push_back( { "build-log", generateBuildLog( size ) } );
+		workloads.push_back( { "cat", generateCat( size ) } );
+		workloads.push_back( { "top", generateTopFrames( size, columns, rows ) } );
+		workloads.push_back( { "control-sequences", generateControlSequences( size ) } );
+	}
+
+	// Hashes depend on the terminal size, so it's part of the key
+	std::string sizeKey( String::format( "@%dx%d", columns, rows ) );
+	auto baseline( baselineFlag ? loadBaseline( baselineFlag.Get() )
+								: std::map<std::string, std::string>() );
+	std::string newBaseline;
+	int mismatches = 0;
+
+	std::cout << String::format( "%-24s %10s %10s %12s %14s  %-16s", "capture", "MB", "MB/s",
+								 "allocs/MB", "alloc KB/MB", "screen hash" )
+			  << std::endl;
+
+	for ( const auto& workload : workloads ) {
+		Report report( replay( workload, columns, rows, iterations ) );
+		double megabytes = report.megabytes / iterations;
+		std::string hash( String::format( "%016llx", (unsigned long long)report.hash ) );
+		std::string key( workload.name + sizeKey );
+		std::string status;
+
+		auto expected = baseline.find( key );
+		if ( expected != baseline.end() && !updateBaselineFlag ) {
+			if ( expected->second == hash ) {
+				status = "ok";
+			} else {
+				status = "MISMATCH (expected " + expected->second + ")";
+				mismatches++;
+			}
+		}
+		newBaseline += key + " " + hash + "\n";
+
+		std::cout << String::format( "%-24s %10.2f %10.2f %12.1f %14.1f  %s %s",
+									 workload.name.c_str(), report.megabytes,
+									 report.megabytes / report.seconds,
+									 report.allocations / megabytes,
+									 report.allocatedBytes / 1024. / megabytes, hash.c_str(),
+									 status.c_str() )
+				  << std::endl;
+	}
+
+	if ( updateBaselineFlag ) {
+		if ( !baselineFlag ) {
+			std::cerr << "--update-baseline requires --baseline" << std::endl;
+			return EXIT_FAILURE;
+		}
+		// Keep the entries of the captures and sizes that were not replayed this time
+		for ( const auto& entry : baseline )
+			if ( newBaseline.find( entry.first + " " ) == std::string::npos )
+				newBaseline += entry.first + " " + entry.second + "\n";
+		if ( !FileSystem::fileWrite( baselineFlag.Get(), newBaseline ) ) {
+			std::cerr << "Couldn't write " << baselineFlag.Get() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
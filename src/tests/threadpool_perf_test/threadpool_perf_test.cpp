@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <args/args.hxx>
+#include <atomic>
+#include <eepp/ee.hpp>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Counts the heap allocations done through operator new
+static std::atomic<size_t> sAllocations{ 0 };
+
+void* operator new( std::size_t size ) {
+	sAllocations.fetch_add( 1, std::memory_order_relaxed );
+	if ( void* ptr = malloc( size ? size : 1 ) )
+		return ptr;
+	throw std::bad_alloc();
+}
+
+#if defined( __GNUC__ ) && !defined( __clang__ ) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete( void* ptr ) noexcept {
+	free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept {
+	free( ptr );
+}
+
+struct Report {
+	std::string name;
+	size_t tasks{ 0 };
+	double seconds{ 0 };
+	size_t allocations{ 0 };
+	std::string extra;
+	bool ok{ true };
+};
+
+static std::atomic<Uint64> sSink{ 0 };
+
+static void spin( int iterations ) {
+	Uint64 value = 0;
+	for ( int i = 0; i < iterations; ++i )
+		value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+	sSink.fetch_add( value, std::memory_order_relaxed );
+}
+
+static void waitFor( const std::atomic<size_t>& counter, size_t value ) {
+	while ( counter.load( std::memory_order_acquire ) < value )
+		std::this_thread::yield();
+}
+
+// Many threads queueing tiny tasks at the same time, the worst case for a single queue
+static Report runExternal( ThreadPool& pool, int producers, size_t tasks, int work,
+						   bool handles ) {
+	Report report{ handles ? "external-submit" : "external-run", tasks, 0, 0, "", true };
+	std::atomic<size_t> done{ 0 };
+	size_t perProducer = tasks / producers;
+	report.tasks = perProducer * producers;
+
+	size_t allocations = sAllocations;
+	Clock clock;
+	std::vector<std::thread> threads;
+	for ( int p = 0; p < producers; ++p ) {
+		threads.emplace_back( [&]() {
+			for ( size_t i = 0; i < perProducer; ++i ) {
+				if ( handles ) {
+					pool.submit( [&done, work]() {
+						spin( work );
+						done.fetch_add( 1, std::memory_order_release );
+					} );
+				} else {
+					pool.run(
+						[&done, work]() {
+							spin( work );
+							done.fetch_add( 1, std::memory_order_release );
+						},
+						nullptr );
+				}
+			}
+		} );
+	}
+	for ( auto& thread : threads )
+		thread.join();
+	waitFor( done, report.tasks );
+	report.seconds = clock.getElapsedTime().asSeconds();
+	report.allocations = sAllocations - allocations;
+	report.ok = done == report.tasks;
+	return report;
+}
+
+// Tasks that queue more tasks from the workers, they are taken from the own queue or stolen
+static Report runNested( ThreadPool& pool, size_t tasks, int work ) {
+	Report report{ "nested", tasks, 0, 0, "", true };
+	std::atomic<size_t> done{ 0 };
+	const size_t fanout = 8;
+	size_t roots = eemax<size_t>( 1, tasks / ( fanout + 1 ) );
+	report.tasks = roots * ( fanout + 1 );
+
+	size_t allocations = sAllocations;
+	Clock clock;
+	for ( size_t r = 0; r < roots; ++r ) {
+		pool.run(
+			[&pool, &done, work, fanout]() {
+				for ( size_t i = 0; i < fanout; ++i ) {
+					pool.run(
+						[&done, work]() {
+							spin( work );
+							done.fetch_add( 1, std::memory_order_release );
+						},
+						nullptr );
+				}
+				spin( work );
+				done.fetch_add( 1, std::memory_order_release );
+			},
+			nullptr );
+	}
+	waitFor( done, report.tasks );
+	report.seconds = clock.getElapsedTime().asSeconds();
+	report.allocations = sAllocations - allocations;
+	report.ok = done == report.tasks;
+	return report;
+}
+
+// Latency of interactive tasks queued while the pool is busy with background work
+static Report runPriority( ThreadPool& pool, size_t tasks, int work ) {
+	Report report{ "priority", tasks, 0, 0, "", true };
+	std::atomic<size_t> background{ 0 };
+	std::atomic<size_t> interactive{ 0 };
+	const size_t samples = 200;
+	std::vector<double> latencies( samples );
+	int backgroundWork = eemax( 200000, work );
+
+	size_t allocations = sAllocations;
+	Clock clock;
+	for ( size_t i = 0; i < tasks; ++i ) {
+		pool.run(
+			[&background, backgroundWork]() {
+				spin( backgroundWork );
+				background.fetch_add( 1, std::memory_order_release );
+			},
+			nullptr, 0, ThreadPool::Priority::Background );
+	}
+	for ( size_t i = 0; i < samples; ++i ) {
+		Int64 queued = clock.getElapsedTime().asMicroseconds();
+		pool.submit( [&, i, queued]() {
+			latencies[i] = clock.getElapsedTime().asMicroseconds() - queued;
+			interactive.fetch_add( 1, std::memory_order_release );
+		} );
+		waitFor( interactive, i + 1 );
+	}
+	size_t backgroundDone = background;
+	waitFor( background, tasks );
+	report.seconds = clock.getElapsedTime().asSeconds();
+	report.allocations = sAllocations - allocations;
+	report.tasks = tasks + samples;
+
+	std::sort( latencies.begin(), latencies.end() );
+	double average = 0;
+	for ( double latency : latencies )
+		average += latency;
+	average /= samples;
+	report.extra = String::format( "latency avg %.0fus p99 %.0fus, %zu/%zu background done before",
+								   average, latencies[samples * 99 / 100], backgroundDone, tasks );
+	return report;
+}
+
+// Cancelling queued tasks by tag and through their handles
+static Report runCancel( ThreadPool& pool, size_t tasks ) {
+	Report report{ "cancel", tasks, 0, 0, "", true };
+	std::atomic<bool> release{ false };
+	std::atomic<size_t> ran{ 0 };
+	std::atomic<size_t> blocked{ 0 };
+	const Uint64 tag = 1;
+
+	// Keep every worker busy so nothing else runs
+	for ( Uint32 i = 0; i < pool.numThreads(); ++i ) {
+		pool.run( [&]() {
+			blocked++;
+			while ( !release )
+				std::this_thread::yield();
+		} );
+	}
+	waitFor( blocked, pool.numThreads() );
+
+	std::vector<TaskHandle> handles;
+	handles.reserve( tasks / 2 );
+	for ( size_t i = 0; i < tasks; ++i ) {
+		if ( i % 2 == 0 ) {
+			pool.run( [&ran]() { ran++; }, nullptr, tag );
+		} else {
+			handles.emplace_back( pool.submit( [&ran]() { ran++; } ) );
+		}
+	}
+
+	size_t allocations = sAllocations;
+	Clock clock;
+	bool removed = pool.removeWithTag( tag );
+	size_t cancelled = 0;
+	for ( auto& handle : handles )
+		cancelled += handle.cancel() ? 1 : 0;
+	report.seconds = clock.getElapsedTime().asSeconds();
+	report.allocations = sAllocations - allocations;
+
+	release = true;
+	for ( auto& handle : handles )
+		handle.wait();
+	report.ok = removed && cancelled == handles.size() && !pool.existsTagInQueue( tag );
+	// The cancelled tasks are dropped by the workers, wait for the queue to be empty
+	TaskHandle last( pool.submit( []() {}, ThreadPool::Priority::Background ) );
+	last.wait();
+	report.ok = report.ok && ran == 0;
+	return report;
+}
+
+EE_MAIN_FUNC int main( int argc, char* argv[] ) {
+	args::ArgumentParser parser( "threadpool-perf-test",
+								 "Measures the ThreadPool throughput when many threads queue "
+								 "small tasks, the latency of interactive tasks while it's busy "
+								 "and the allocations done per task." );
+	args::HelpFlag help( parser, "help", "Display this help menu", { 'h', "help" } );
+	args::ValueFlag<int> threadsFlag( parser, "threads", "Worker threads (0 = CPU count)",
+									  { 't', "threads" }, 0 );
+	args::ValueFlag<int> producersFlag( parser, "producers", "Threads queueing tasks",
+										{ 'p', "producers" }, 4 );
+	args::ValueFlag<size_t> tasksFlag( parser, "tasks", "Tasks of each benchmark",
+									   { 'n', "tasks" }, 200000 );
+	args::ValueFlag<int> workFlag( parser, "work", "Iterations of busy work done by each task",
+								   { 'w', "work" }, 0 );
+
+	try {
+		parser.ParseCLI( argc, argv );
+	} catch ( const args::Help& ) {
+		std::cout << parser;
+		return EXIT_SUCCESS;
+	} catch ( const args::ParseError& e ) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return EXIT_FAILURE;
+	} catch ( args::ValidationError& e ) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return EXIT_FAILURE;
+	}
+
+	int threads = threadsFlag.Get() > 0 ? threadsFlag.Get() : Sys::getCPUCount();
+	int producers = eemax( 1, producersFlag.Get() );
+	size_t tasks = eemax<size_t>( 1, tasksFlag.Get() );
+	int work = eemax( 0, workFlag.Get() );
+	auto pool = ThreadPool::createUnique( eemax( 1, threads ) );
+
+	std::vector<Report> reports;
+	reports.emplace_back( runExternal( *pool, producers, tasks, work, false ) );
+	reports.emplace_back( runExternal( *pool, producers, tasks, work, true ) );
+	reports.emplace_back( runNested( *pool, tasks, work ) );
+	reports.emplace_back( runPriority( *pool, eemin<size_t>( tasks, 1000 ), work ) );
+	reports.emplace_back( runCancel( *pool, eemin<size_t>( tasks, 100000 ) ) );
+
+	std::cout << String::format( "%d workers, %d producers", threads, producers ) << std::endl;
+	std::cout << String::format( "%-18s %10s %10s %14s %12s", "benchmark", "tasks", "ms",
+								 "tasks/s", "allocs/task" )
+			  << std::endl;
+
+	bool ok = true;
+	for ( const auto& report : reports ) {
+		std::cout << String::format( "%-18s %10zu %10.2f %14.0f %12.2f  %s%s",
+									 report.name.c_str(), report.tasks, report.seconds * 1000,
+									 report.tasks / eemax( report.seconds, 1e-9 ),
+									 (double)report.allocations / report.tasks,
+									 report.extra.c_str(), report.ok ? "" : " FAILED" )
+				  << std::endl;
+		ok = ok && report.ok;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
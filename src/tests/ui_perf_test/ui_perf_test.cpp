@@ -7,15 +7,13 @@ class TestModel : public Model {
 	struct NodeT {
 		std::vector<NodeT*> children;
 		NodeT* parent{ nullptr };
+		// Position in the parent children, the nodes are never moved
+		int row{ 0 };
 
 		ModelIndex index( const TestModel& model, int column ) const {
 			if ( !parent )
 				return {};
-			for ( size_t row = 0; row < parent->children.size(); ++row ) {
-				if ( parent->children[row] == this )
-					return model.createIndex( row, column, const_cast<NodeT*>( this ) );
-			}
-			return {};
+			return model.createIndex( row, column, const_cast<NodeT*>( this ) );
 		}
 	};
 
@@ -27,9 +25,11 @@ class TestModel : public Model {
 		for ( size_t row = 0; row < getRows(); ++row ) {
 			NodeT* n = new NodeT();
 			n->parent = &mRoot;
+			n->row = row;
 			for ( size_t i = 0; i < getChilds(); i++ ) {
 				NodeT* c = new NodeT();
 				c->parent = n;
+				c->row = i;
 				n->children.push_back( c );
 			}
 			mRoot.children.push_back( n );
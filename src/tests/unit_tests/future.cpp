@@ -0,0 +1,110 @@
+#include "utest.h"
+#include <atomic>
+#include <eepp/system/future.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace EE::System;
+
+UTEST( Future, thenChainsOnThePool ) {
+	auto pool = ThreadPool::createShared( 2 );
+	auto future = runAsync( pool, [] { return 20; } )
+					  .then( pool, []( const int& value ) { return value + 1; } )
+					  .then( pool, []( const int& value ) { return std::to_string( value * 2 ); } );
+	ASSERT_STREQ( future.get().c_str(), "42" );
+}
+
+UTEST( Future, thenFlattensFutures ) {
+	auto pool = ThreadPool::createShared( 2 );
+	auto other = ThreadPool::createShared( 1 );
+	// A task can own other pool, but not the one running it
+	auto future = runAsync( pool, [] { return 2; } ).then( pool, [other]( const int& value ) {
+		return runAsync( other, [value] { return value * 3; } );
+	} );
+	ASSERT_EQ( future.get(), 6 );
+}
+
+UTEST( Future, onMainThreadRunsWhenTheQueueIsProcessed ) {
+	auto pool = ThreadPool::createShared( 2 );
+	auto queue = TaskQueue::New();
+	std::atomic<bool> ran{ false };
+	auto future = runAsync( pool, [] { return 7; } ).onMainThread( queue, [&]( const int& value ) {
+		ran = true;
+		return value;
+	} );
+	while ( queue->empty() )
+		std::this_thread::yield();
+	ASSERT_FALSE( ran );
+	ASSERT_EQ( queue->process(), 1UL );
+	ASSERT_TRUE( ran );
+	ASSERT_EQ( future.get(), 7 );
+}
+
+UTEST( Future, thenCancelsWhenItReturnsAnInvalidFuture ) {
+	auto pool = ThreadPool::createShared( 2 );
+	auto future =
+		runAsync( pool, [] { return 1; } ).then( pool, []( const int& ) { return Future<int>(); } );
+	future.wait();
+	ASSERT_TRUE( future.isCancelled() );
+}
+
+UTEST( Future, whenAllCollectsTheValuesInOrder ) {
+	auto pool = ThreadPool::createShared( 4 );
+	std::vector<Future<int>> futures;
+	for ( int i = 0; i < 32; ++i )
+		futures.emplace_back( runAsync( pool, [i] { return i * i; } ) );
+	auto all = whenAll( futures );
+	const auto& values = all.get();
+	ASSERT_EQ( values.size(), 32UL );
+	for ( int i = 0; i < 32; ++i )
+		ASSERT_EQ( values[i], i * i );
+
+	auto mixed = whenAll( runAsync( pool, [] { return 1; } ), runAsync( pool, [] {} ),
+						  makeReadyFuture( std::string( "ready" ) ) );
+	mixed.wait();
+	ASSERT_TRUE( mixed.isReady() );
+}
+
+UTEST( Future, cancellationPropagates ) {
+	auto pool = ThreadPool::createShared( 1 );
+	auto queue = TaskQueue::New();
+	Promise<int> promise;
+	std::atomic<bool> ran{ false };
+	auto chained = promise.getFuture()
+					   .then( pool, []( const int& value ) { return value; } )
+					   .onMainThread( queue, [&]( const int& ) { ran = true; } );
+	auto all = whenAll( promise.getFuture(), makeReadyFuture() );
+	promise.getFuture().cancel();
+	ASSERT_TRUE( chained.isCancelled() );
+	ASSERT_TRUE( all.isCancelled() );
+	ASSERT_EQ( queue->process(), 0UL );
+	ASSERT_FALSE( ran );
+
+	// A continuation whose queue is gone is cancelled
+	auto orphan = makeReadyFuture( 1 ).onMainThread( TaskQueue::New(), []( const int& ) {} );
+	ASSERT_TRUE( orphan.isCancelled() );
+
+	// A dropped promise cancels its future
+	Future<void> broken;
+	{
+		Promise<void> dropped;
+		broken = dropped.getFuture();
+	}
+	ASSERT_TRUE( broken.isCancelled() );
+}
+
+UTEST( TaskQueue, processRespectsTheBudget ) {
+	auto queue = TaskQueue::New();
+	int count = 0;
+	for ( int i = 0; i < 10; ++i ) {
+		queue->post( [&count] {
+			count++;
+			std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+		} );
+	}
+	ASSERT_EQ( queue->process( Milliseconds( 1 ) ), 1UL );
+	ASSERT_EQ( count, 1 );
+	ASSERT_EQ( queue->process(), 9UL );
+	ASSERT_EQ( count, 10 );
+}
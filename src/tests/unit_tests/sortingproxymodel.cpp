@@ -0,0 +1,228 @@
+#include "utest.h"
+#include <algorithm>
+#include <cmath>
+#include <eepp/core/string.hpp>
+#include <eepp/system/threadpool.hpp>
+#include <eepp/ui/models/model.hpp>
+#include <eepp/ui/models/sortingproxymodel.hpp>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace EE;
+using namespace EE::System;
+using namespace EE::UI::Models;
+
+namespace {
+
+// More rows than the threshold of the parallel sort
+static constexpr int LARGE_ROW_COUNT = 20000;
+
+// Variant can't be copied, the values are kept by type and the variant is created on demand
+struct Value {
+	Variant::Type type{ Variant::Type::Int };
+	int number{ 0 };
+	Float real{ 0 };
+	std::string text;
+};
+
+class ListModel : public Model {
+  public:
+	std::vector<Value> values;
+
+	void insert( size_t row, std::vector<Value>&& rows ) {
+		beginInsertRows( {}, row, row + rows.size() - 1 );
+		values.insert( values.begin() + row, rows.begin(), rows.end() );
+		endInsertRows();
+	}
+
+	size_t rowCount( const ModelIndex& index ) const { return index.isValid() ? 0 : values.size(); }
+
+	size_t columnCount( const ModelIndex& ) const { return 1; }
+
+	Variant data( const ModelIndex& index, ModelRole ) const {
+		const Value& value = values[index.row()];
+		switch ( value.type ) {
+			case Variant::Type::Bool:
+				return Variant( value.number != 0 );
+			case Variant::Type::Float:
+				return Variant( value.real );
+			case Variant::Type::StdString:
+				return Variant( value.text );
+			case Variant::Type::String:
+				return Variant( String( value.text ) );
+			default:
+				return Variant( value.number );
+		}
+	}
+};
+
+using ValueLess = std::function<bool( const Value&, const Value& )>;
+
+Value intValue( int number ) {
+	Value value;
+	value.number = number;
+	return value;
+}
+
+Value floatValue( Float real ) {
+	Value value;
+	value.type = Variant::Type::Float;
+	value.real = real;
+	return value;
+}
+
+Value stringValue( const std::string& text ) {
+	Value value;
+	value.type = Variant::Type::StdString;
+	value.text = text;
+	return value;
+}
+
+std::vector<int> getSourceRows( SortingProxyModel& proxy ) {
+	std::vector<int> rows;
+	for ( size_t row = 0; row < proxy.rowCount(); ++row )
+		rows.push_back( proxy.mapToSource( proxy.index( row, 0 ) ).row() );
+	return rows;
+}
+
+std::vector<int> getStableSortedRows( const ListModel& model, const ValueLess& less,
+									  SortOrder sortOrder ) {
+	std::vector<int> rows( model.values.size() );
+	for ( size_t row = 0; row < rows.size(); ++row )
+		rows[row] = row;
+	std::stable_sort( rows.begin(), rows.end(), [&]( int row1, int row2 ) {
+		return sortOrder == SortOrder::Ascending
+				   ? less( model.values[row1], model.values[row2] )
+				   : less( model.values[row2], model.values[row1] );
+	} );
+	return rows;
+}
+
+// Sorts ascending, then descending from the previous order, and back, with and without a pool.
+// The ties must keep the source order in both directions, as std::stable_sort does.
+bool sortsAsStableSort( const std::shared_ptr<ListModel>& model, const ValueLess& less ) {
+	auto pool = ThreadPool::createShared( 3 );
+	for ( bool parallel : { false, true } ) {
+		auto proxy = SortingProxyModel::New( model );
+		if ( parallel )
+			proxy->setThreadPool( pool );
+		for ( SortOrder sortOrder :
+			  { SortOrder::Ascending, SortOrder::Descending, SortOrder::Ascending } ) {
+			proxy->sort( 0, sortOrder );
+			if ( getSourceRows( *proxy ) != getStableSortedRows( *model, less, sortOrder ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+bool intLess( const Value& value1, const Value& value2 ) {
+	return value1.number < value2.number;
+}
+
+bool floatLess( const Value& value1, const Value& value2 ) {
+	if ( std::isnan( value2.real ) )
+		return !std::isnan( value1.real );
+	return value1.real < value2.real;
+}
+
+bool stringLess( const Value& value1, const Value& value2 ) {
+	return String::toLower( value1.text ) < String::toLower( value2.text );
+}
+
+} // namespace
+
+UTEST( SortingProxyModel, sortsIntsAsStableSort ) {
+	for ( int rowCount : { 100, LARGE_ROW_COUNT } ) {
+		auto model = std::make_shared<ListModel>();
+		for ( int row = 0; row < rowCount; ++row )
+			model->values.emplace_back( intValue( ( row * 7919 ) % 97 - 48 ) );
+		ASSERT_TRUE( sortsAsStableSort( model, intLess ) );
+	}
+}
+
+UTEST( SortingProxyModel, sortsFloatsWithNaNsAsStableSort ) {
+	for ( int rowCount : { 100, LARGE_ROW_COUNT } ) {
+		auto model = std::make_shared<ListModel>();
+		for ( int row = 0; row < rowCount; ++row ) {
+			Float real = row % 7 == 3 ? std::numeric_limits<Float>::quiet_NaN()
+									  : ( ( row * 7919 ) % 89 ) * 0.5f - 20.f;
+			model->values.emplace_back( floatValue( real ) );
+		}
+		ASSERT_TRUE( sortsAsStableSort( model, floatLess ) );
+		// The NaNs sort last in the ascending order
+		auto proxy = SortingProxyModel::New( model );
+		proxy->sort( 0, SortOrder::Ascending );
+		ASSERT_TRUE( std::isnan( proxy->data( proxy->index( rowCount - 1, 0 ) ).asFloat() ) );
+		ASSERT_FALSE( std::isnan( proxy->data( proxy->index( 0, 0 ) ).asFloat() ) );
+	}
+}
+
+UTEST( SortingProxyModel, sortsStringsAsStableSort ) {
+	const std::vector<std::string> words{ "delta", "Alpha", "charlie", "BRAVO", "alpha",
+										  "Delta", "echo",	"bravo",   "",		"Charlie" };
+	for ( int rowCount : { 100, LARGE_ROW_COUNT } ) {
+		auto model = std::make_shared<ListModel>();
+		for ( int row = 0; row < rowCount; ++row )
+			model->values.emplace_back(
+				stringValue( words[( row * 7919 ) % words.size()] + std::to_string( row % 3 ) ) );
+		ASSERT_TRUE( sortsAsStableSort( model, stringLess ) );
+	}
+}
+
+UTEST( SortingProxyModel, sortsMixedTypesAsStableSort ) {
+	// Different types compare by their string form. The values are single digits and lower case
+	// words, so the comparisons between the same types agree with it and the order is total.
+	const std::vector<std::string> words{ "delta", "alpha", "7", "charlie", "bravo", "3" };
+	for ( int rowCount : { 100, LARGE_ROW_COUNT } ) {
+		auto model = std::make_shared<ListModel>();
+		for ( int row = 0; row < rowCount; ++row ) {
+			Value value;
+			value.number = ( row * 7919 ) % 10;
+			value.text = words[( row * 31 ) % words.size()];
+			switch ( row % 4 ) {
+				case 0:
+					value.type = Variant::Type::Int;
+					value.text = std::to_string( value.number );
+					break;
+				case 1:
+					value.type = Variant::Type::StdString;
+					break;
+				case 2:
+					value.type = Variant::Type::Bool;
+					value.number %= 2;
+					value.text = value.number ? "true" : "false";
+					break;
+				default:
+					value.type = Variant::Type::String;
+					break;
+			}
+			model->values.emplace_back( std::move( value ) );
+		}
+		ASSERT_TRUE( sortsAsStableSort( model, []( const Value& value1, const Value& value2 ) {
+			return value1.text < value2.text;
+		} ) );
+	}
+}
+
+UTEST( SortingProxyModel, insertsRowsInTheSortedOrder ) {
+	const Float nan = std::numeric_limits<Float>::quiet_NaN();
+	auto model = std::make_shared<ListModel>();
+	for ( int row = 0; row < LARGE_ROW_COUNT; ++row )
+		model->values.emplace_back( floatValue( row % 11 == 5 ? nan : ( row * 7919 ) % 101 ) );
+	auto proxy = SortingProxyModel::New( model );
+	proxy->setThreadPool( ThreadPool::createShared( 3 ) );
+	for ( SortOrder sortOrder : { SortOrder::Ascending, SortOrder::Descending } ) {
+		proxy->sort( 0, sortOrder );
+		// Builds the mapping, the inserts are merged into it
+		ASSERT_TRUE( getSourceRows( *proxy ) ==
+					 getStableSortedRows( *model, floatLess, sortOrder ) );
+		model->insert( 0, { floatValue( 50 ), floatValue( nan ), floatValue( -1 ) } );
+		model->insert( model->values.size() / 2, { floatValue( 50 ), floatValue( 101 ) } );
+		model->insert( model->values.size(), { floatValue( 0 ) } );
+		ASSERT_TRUE( getSourceRows( *proxy ) ==
+					 getStableSortedRows( *model, floatLess, sortOrder ) );
+	}
+}
@@ -0,0 +1,211 @@
+#include "utest.h"
+#include <cstring>
+#include <eepp/core/string.hpp>
+#include <eterm/system/iprocess.hpp>
+#include <eterm/terminal/ipseudoterminal.hpp>
+#include <eterm/terminal/iterminaldisplay.hpp>
+#include <eterm/terminal/terminalemulator.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace EE;
+using namespace eterm::Terminal;
+
+namespace {
+
+// Feeds the text appended to `data` to the emulator
+class StringPseudoTerminal : public IPseudoTerminal {
+  public:
+	StringPseudoTerminal( const std::string& data, int columns, int rows ) :
+		mData( data ), mColumns( columns ), mRows( rows ) {}
+
+	virtual int getNumColumns() const { return mColumns; }
+
+	virtual int getNumRows() const { return mRows; }
+
+	virtual bool resize( int columns, int rows ) {
+		mColumns = columns;
+		mRows = rows;
+		return true;
+	}
+
+	virtual bool isTTY() const { return true; }
+
+	virtual int write( const char*, size_t n ) { return (int)n; }
+
+	virtual int read( char* buf, size_t n, bool ) {
+		size_t len = std::min( n, mData.size() - mPos );
+		memcpy( buf, mData.data() + mPos, len );
+		mPos += len;
+		return (int)len;
+	}
+
+	bool eof() const { return mPos >= mData.size(); }
+
+  protected:
+	const std::string& mData;
+	size_t mPos{ 0 };
+	int mColumns;
+	int mRows;
+};
+
+class NullProcess : public eterm::System::IProcess {
+  public:
+	virtual void checkExitStatus() {}
+
+	virtual bool hasExited() const { return false; }
+
+	virtual int getExitCode() const { return 0; }
+
+	virtual void terminate() {}
+
+	virtual void waitForExit() {}
+};
+
+// Keeps the text of the rows and the cursor position of the last frame
+class ScreenDisplay : public ITerminalDisplay {
+  public:
+	std::vector<std::string> rows;
+	int cursorColumn{ -1 };
+	int cursorRow{ -1 };
+
+	virtual void setTitle( const char* ) {}
+
+	virtual bool drawBegin( Uint32, Uint32 rowCount ) {
+		rows.assign( rowCount, "" );
+		cursorColumn = cursorRow = -1;
+		return true;
+	}
+
+	virtual void drawLine( Line line, int x1, int y, int x2 ) {
+		if ( y < 0 || y >= (int)rows.size() )
+			return;
+		std::string& row = rows[y];
+		if ( (int)row.size() < x2 )
+			row.resize( x2, ' ' );
+		for ( int x = x1; x < x2; x++ )
+			row[x] = line[x].u < 0x80 && line[x].u ? (char)line[x].u : ' ';
+	}
+
+	virtual void drawCursor( int cx, int cy, TerminalGlyph, int, int, TerminalGlyph ) {
+		cursorColumn = cx;
+		cursorRow = cy;
+	}
+
+	virtual void drawEnd() {}
+};
+
+struct Terminal {
+	std::string data;
+	StringPseudoTerminal* pty{ nullptr };
+	std::shared_ptr<ScreenDisplay> display{ std::make_shared<ScreenDisplay>() };
+	std::unique_ptr<TerminalEmulator> emulator;
+
+	Terminal( const std::string& text, int columns, int rows ) : data( text ) {
+		auto pseudoTerminal = std::make_unique<StringPseudoTerminal>( data, columns, rows );
+		pty = pseudoTerminal.get();
+		emulator = TerminalEmulator::create( std::move( pseudoTerminal ),
+											 std::make_unique<NullProcess>(), display );
+	}
+
+	void feed() {
+		while ( !pty->eof() )
+			emulator->update();
+		emulator->update();
+	}
+
+	void resize( int columns, int rows ) {
+		emulator->resize( columns, rows );
+		emulator->update();
+		emulator->redraw();
+	}
+
+	std::vector<std::string> screen() {
+		emulator->redraw();
+		return display->rows;
+	}
+
+	// The history and the screen rows joined without separators, the wrapped lines end up whole
+	std::string text() const {
+		std::string text;
+		for ( const auto& line : emulator->getSearchSnapshot().lines )
+			text += line;
+		return text;
+	}
+};
+
+// The lines don't contain blanks, so the rows ending at a wrap point keep all their cells
+std::string scrollbackLine( int number ) {
+	return String::format( "scrollback-line-%02d-long-enough-to-be-wrapped.", number );
+}
+
+// Every line must be found once, in the order they were written
+bool containsLinesInOrder( const std::string& text, const std::vector<std::string>& lines ) {
+	size_t pos = 0;
+	for ( const auto& line : lines ) {
+		size_t found = text.find( line, pos );
+		if ( found == std::string::npos || text.find( line, found + 1 ) != std::string::npos )
+			return false;
+		pos = found + line.size();
+	}
+	return true;
+}
+
+} // namespace
+
+UTEST( TerminalEmulator, resizeReflowRestoresTheScreen ) {
+	Terminal term( "first line\r\n\r\n\r\nsecond line, longer than the narrow width\r\n\r\nend",
+				   40, 20 );
+	term.feed();
+	std::vector<std::string> screen = term.screen();
+	ASSERT_TRUE( String::startsWith( screen[0], "first line" ) );
+
+	// Narrowing the screen while everything still fits in it and widening it back restores it
+	term.resize( 13, 20 );
+	term.resize( 40, 20 );
+	ASSERT_TRUE( term.screen() == screen );
+	// The second line is one cell wider than the screen
+	ASSERT_EQ( term.display->cursorRow, 6 );
+	ASSERT_EQ( term.display->cursorColumn, 3 );
+}
+
+UTEST( TerminalEmulator, resizeReflowKeepsTheScrollback ) {
+	Terminal term( "first line\r\n\r\n\r\nsecond line, longer than the narrow width\r\n\r\nend",
+				   40, 20 );
+	term.feed();
+	term.resize( 13, 20 );
+	term.resize( 40, 20 );
+
+	std::vector<std::string> lines;
+	for ( int i = 0; i < 60; i++ ) {
+		if ( i % 3 ) {
+			lines.emplace_back( scrollbackLine( i ) );
+			term.data += "\r\n" + lines.back();
+		} else {
+			term.data += "\r\n\r\n";
+		}
+	}
+	term.feed();
+	ASSERT_TRUE( containsLinesInOrder( term.text(), lines ) );
+
+	for ( int columns : { 11, 57, 2, 24, 3, 40 } ) {
+		for ( int rows : { 20, 4 } ) {
+			term.resize( columns, rows );
+			ASSERT_EQ( term.emulator->getNumColumns(), columns );
+			ASSERT_EQ( term.emulator->getNumRows(), rows );
+			ASSERT_TRUE( containsLinesInOrder( term.text(), lines ) );
+			ASSERT_GE( term.display->cursorRow, 0 );
+			ASSERT_LT( term.display->cursorRow, rows );
+			ASSERT_GE( term.display->cursorColumn, 0 );
+			ASSERT_LT( term.display->cursorColumn, columns );
+		}
+	}
+
+	// The output goes on from the cursor after the last resize
+	term.data += "\r\nlast";
+	term.feed();
+	std::vector<std::string> screen = term.screen();
+	ASSERT_TRUE( String::startsWith( screen[term.display->cursorRow], "last" ) );
+	ASSERT_TRUE( containsLinesInOrder( term.text(), lines ) );
+}
@@ -0,0 +1,71 @@
+#include "utest.h"
+#include <eepp/scene/scenemanager.hpp>
+#include <eepp/ui/uiscenenode.hpp>
+#include <eepp/ui/uiwidget.hpp>
+#include <eepp/window/engine.hpp>
+
+using namespace EE::Scene;
+using namespace EE::UI;
+using namespace EE::Window;
+
+namespace {
+
+UISceneNode* createSceneNode() {
+	EE::Window::Window* win = Engine::instance()->createWindow(
+		WindowSettings( 320, 240, "eepp - UINode Test" ), ContextSettings( false ) );
+	if ( win == nullptr || !win->isOpen() )
+		return nullptr;
+	UISceneNode* sceneNode = UISceneNode::New();
+	SceneManager::instance()->add( sceneNode );
+	return sceneNode;
+}
+
+UIWidget* createRetainedWidget( Node* parent ) {
+	UIWidget* widget = UIWidget::New();
+	widget->setParent( parent );
+	widget->setPixelsSize( 64, 64 );
+	UIWidget* child = UIWidget::New();
+	child->setParent( widget );
+	child->setPixelsSize( 32, 32 );
+	widget->setRetainedDraw( true );
+	return widget;
+}
+
+} // namespace
+
+UTEST( UINode, retainedDrawWithInvalidatorAncestor ) {
+	UISceneNode* sceneNode = createSceneNode();
+	if ( sceneNode == nullptr ) {
+		Engine::destroySingleton();
+		return;
+	}
+	UIWidget* widget = createRetainedWidget( sceneNode->getRoot() );
+	// Without frame buffers support the node keeps drawing directly
+	if ( widget->isRetainedDraw() ) {
+		widget->getFirstChild()->invalidateDraw();
+		ASSERT_TRUE( widget->invalidated() );
+		widget->setRetainedDraw( false );
+		ASSERT_FALSE( widget->isRetainedDraw() );
+	}
+	Engine::destroySingleton();
+}
+
+UTEST( UINode, retainedDrawWithoutInvalidatorAncestor ) {
+	UISceneNode* sceneNode = createSceneNode();
+	if ( sceneNode == nullptr ) {
+		Engine::destroySingleton();
+		return;
+	}
+	// The node is its own draw invalidator, it must not invalidate itself again
+	Node* detached = Node::New();
+	UIWidget* widget = createRetainedWidget( detached );
+	if ( widget->isRetainedDraw() ) {
+		widget->getFirstChild()->invalidateDraw();
+		widget->invalidateDraw();
+		ASSERT_TRUE( widget->invalidated() );
+		widget->setRetainedDraw( false );
+		ASSERT_FALSE( widget->isRetainedDraw() );
+	}
+	eeDelete( detached );
+	Engine::destroySingleton();
+}
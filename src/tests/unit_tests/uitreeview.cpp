@@ -0,0 +1,279 @@
+#include "utest.h"
+#include <eepp/scene/scenemanager.hpp>
+#include <eepp/ui/models/model.hpp>
+#include <eepp/ui/uiscenenode.hpp>
+#include <eepp/ui/uitreeview.hpp>
+#include <eepp/window/engine.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace EE::Scene;
+using namespace EE::UI;
+using namespace EE::UI::Models;
+using namespace EE::Window;
+
+namespace {
+
+class TreeModel : public Model {
+  public:
+	struct Node {
+		Node* parent{ nullptr };
+		std::string name;
+		std::vector<std::unique_ptr<Node>> childs;
+	};
+
+	Node* root() { return &mRoot; }
+
+	Node* child( Node* parent, size_t row ) { return parent->childs[row].get(); }
+
+	ModelIndex indexOf( Node* node ) const {
+		if ( node == &mRoot )
+			return {};
+		auto& siblings = node->parent->childs;
+		for ( size_t row = 0; row < siblings.size(); ++row )
+			if ( siblings[row].get() == node )
+				return createIndex( row, 0, node );
+		return {};
+	}
+
+	void insert( Node* parent, size_t row, size_t count ) {
+		beginInsertRows( indexOf( parent ), row, row + count - 1 );
+		for ( size_t i = 0; i < count; ++i ) {
+			auto node = std::make_unique<Node>();
+			node->parent = parent;
+			node->name = std::to_string( mNextId++ );
+			parent->childs.insert( parent->childs.begin() + row + i, std::move( node ) );
+		}
+		endInsertRows();
+	}
+
+	void remove( Node* parent, size_t row, size_t count ) {
+		beginDeleteRows( indexOf( parent ), row, row + count - 1 );
+		auto first = parent->childs.begin() + row;
+		// Keep the removed nodes alive, a new node must not reuse the metadata of a removed one
+		for ( auto it = first; it != first + count; ++it )
+			mRemoved.emplace_back( std::move( *it ) );
+		parent->childs.erase( first, first + count );
+		endDeleteRows();
+	}
+
+	size_t rowCount( const ModelIndex& index ) const { return nodeOf( index )->childs.size(); }
+
+	size_t columnCount( const ModelIndex& ) const { return 1; }
+
+	Variant data( const ModelIndex& index, ModelRole role ) const {
+		if ( role == ModelRole::Display )
+			return Variant( nodeOf( index )->name );
+		return {};
+	}
+
+	ModelIndex index( int row, int column, const ModelIndex& parent ) const {
+		const Node* node = nodeOf( parent );
+		if ( row < 0 || (size_t)row >= node->childs.size() || column != 0 )
+			return {};
+		return createIndex( row, column, node->childs[row].get() );
+	}
+
+	ModelIndex parentIndex( const ModelIndex& index ) const {
+		if ( !index.isValid() )
+			return {};
+		return indexOf( nodeOf( index )->parent );
+	}
+
+  protected:
+	Node mRoot;
+	std::vector<std::unique_ptr<Node>> mRemoved;
+	int mNextId{ 0 };
+
+	Node* nodeOf( const ModelIndex& index ) const {
+		return index.isValid() ? static_cast<Node*>( index.internalData() )
+							   : const_cast<Node*>( &mRoot );
+	}
+};
+
+UISceneNode* createSceneNode() {
+	EE::Window::Window* win = Engine::instance()->createWindow(
+		WindowSettings( 320, 240, "eepp - UITreeView Test" ), ContextSettings( false ) );
+	if ( win == nullptr || !win->isOpen() )
+		return nullptr;
+	UISceneNode* sceneNode = UISceneNode::New();
+	SceneManager::instance()->add( sceneNode );
+	return sceneNode;
+}
+
+void appendExpectedRows( const UITreeView* view, const Model& model, const ModelIndex& parent,
+						 std::vector<ModelIndex>& rows ) {
+	size_t count = model.rowCount( parent );
+	for ( size_t i = 0; i < count; ++i ) {
+		ModelIndex index = model.index( i, model.treeColumn(), parent );
+		rows.push_back( index );
+		if ( view->isExpanded( index ) )
+			appendExpectedRows( view, model, index, rows );
+	}
+}
+
+std::vector<ModelIndex> getVisibleRows( const UITreeView* view ) {
+	std::vector<ModelIndex> rows;
+	for ( size_t row = 0; row < view->getVisibleRowCount(); ++row )
+		rows.push_back( view->getIndexAtRow( row ) );
+	return rows;
+}
+
+// The patched rows must be the rows of the tree walk, and every row must be found by its index
+bool rowsMatchModel( const UITreeView* view, const Model& model ) {
+	std::vector<ModelIndex> expected;
+	appendExpectedRows( view, model, {}, expected );
+	if ( getVisibleRows( view ) != expected )
+		return false;
+	for ( size_t row = 0; row < expected.size(); ++row )
+		if ( view->getRowFromIndex( expected[row] ) != (Int64)row )
+			return false;
+	return true;
+}
+
+// A full rebuild of the rows must match the patched ones
+bool rowsMatchRebuild( UITreeView* view, Model& model ) {
+	std::vector<ModelIndex> patched = getVisibleRows( view );
+	model.invalidate();
+	return getVisibleRows( view ) == patched;
+}
+
+} // namespace
+
+UTEST( UITreeView, patchesRowsUnderExpandedParents ) {
+	UISceneNode* sceneNode = createSceneNode();
+	if ( sceneNode == nullptr ) {
+		Engine::destroySingleton();
+		return;
+	}
+	auto model = std::make_shared<TreeModel>();
+	auto* root = model->root();
+	model->insert( root, 0, 3 );
+	model->insert( model->child( root, 1 ), 0, 4 );
+	model->insert( model->child( model->child( root, 1 ), 2 ), 0, 2 );
+	UITreeView* view = UITreeView::New();
+	view->setParent( sceneNode->getRoot() );
+	view->setModel( model );
+	view->expandAll();
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+
+	auto* parent = model->child( root, 1 );
+	model->insert( parent, 0, 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->insert( parent, 3, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->insert( parent, parent->childs.size(), 3 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->insert( root, 0, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->insert( root, root->childs.size(), 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+
+	// The child with its own expanded childs, and the rows around it
+	model->remove( parent, 5, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->remove( parent, 0, 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->remove( parent, parent->childs.size() - 2, 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->remove( root, 0, 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_TRUE( rowsMatchRebuild( view, *model ) );
+
+	Engine::destroySingleton();
+}
+
+UTEST( UITreeView, skipsRowsUnderCollapsedParents ) {
+	UISceneNode* sceneNode = createSceneNode();
+	if ( sceneNode == nullptr ) {
+		Engine::destroySingleton();
+		return;
+	}
+	auto model = std::make_shared<TreeModel>();
+	auto* root = model->root();
+	model->insert( root, 0, 3 );
+	auto* collapsed = model->child( root, 0 );
+	auto* expanded = model->child( root, 2 );
+	model->insert( collapsed, 0, 3 );
+	model->insert( expanded, 0, 3 );
+	UITreeView* view = UITreeView::New();
+	view->setParent( sceneNode->getRoot() );
+	view->setModel( model );
+	view->setExpanded( model->indexOf( expanded ), true );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_EQ( view->getVisibleRowCount(), (size_t)6 );
+
+	model->insert( collapsed, 1, 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_EQ( view->getVisibleRowCount(), (size_t)6 );
+	ASSERT_EQ( view->getRowFromIndex( model->indexOf( model->child( collapsed, 1 ) ) ),
+			   (Int64)-1 );
+	model->remove( collapsed, 0, 3 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_EQ( view->getVisibleRowCount(), (size_t)6 );
+
+	// Expanding it shows the rows inserted while it was collapsed
+	view->setExpanded( model->indexOf( collapsed ), true );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_EQ( view->getVisibleRowCount(), (size_t)8 );
+	view->setExpanded( model->indexOf( collapsed ), false );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+
+	model->insert( expanded, 0, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->remove( root, 1, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_TRUE( rowsMatchRebuild( view, *model ) );
+
+	Engine::destroySingleton();
+}
+
+UTEST( UITreeView, skipsRowsUnderNestedCollapsedParents ) {
+	UISceneNode* sceneNode = createSceneNode();
+	if ( sceneNode == nullptr ) {
+		Engine::destroySingleton();
+		return;
+	}
+	auto model = std::make_shared<TreeModel>();
+	auto* root = model->root();
+	model->insert( root, 0, 2 );
+	auto* outer = model->child( root, 0 );
+	model->insert( outer, 0, 2 );
+	auto* middle = model->child( outer, 1 );
+	model->insert( middle, 0, 2 );
+	auto* inner = model->child( middle, 0 );
+	model->insert( inner, 0, 2 );
+	UITreeView* view = UITreeView::New();
+	view->setParent( sceneNode->getRoot() );
+	view->setModel( model );
+	// The inner nodes are expanded, but hidden by their collapsed ancestor
+	view->setExpanded( model->indexOf( middle ), true );
+	view->setExpanded( model->indexOf( inner ), true );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_EQ( view->getVisibleRowCount(), (size_t)2 );
+
+	model->insert( inner, 1, 3 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->insert( middle, 2, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->remove( inner, 0, 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_EQ( view->getVisibleRowCount(), (size_t)2 );
+	ASSERT_EQ( view->getRowFromIndex( model->indexOf( inner ) ), (Int64)-1 );
+
+	view->setExpanded( model->indexOf( outer ), true );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_EQ( view->getVisibleRowCount(), (size_t)10 );
+
+	// Now visible, the same patches must keep the rows of the whole subtree
+	model->insert( inner, 0, 2 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->remove( middle, 0, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	model->insert( outer, 0, 1 );
+	ASSERT_TRUE( rowsMatchModel( view, *model ) );
+	ASSERT_TRUE( rowsMatchRebuild( view, *model ) );
+
+	Engine::destroySingleton();
+}
@@ -0,0 +1,288 @@
+#include "buildoutputpipeline.hpp"
+#include <algorithm>
+#include <eepp/system/fileinfo.hpp>
+#include <eepp/system/filesystem.hpp>
+#include <unordered_map>
+
+namespace ecode {
+
+static size_t skipPatternSet( std::string_view pattern, size_t i ) {
+	// i points to the '['
+	i++;
+	if ( i < pattern.size() && pattern[i] == '^' )
+		i++;
+	// A ']' right after the opening is part of the set
+	if ( i < pattern.size() && pattern[i] == ']' )
+		i++;
+	while ( i < pattern.size() && pattern[i] != ']' )
+		i += pattern[i] == '%' ? 2 : 1;
+	return eemin( i + 1, pattern.size() );
+}
+
+std::string BuildOutputPrefilter::getRequiredLiteral( std::string_view pattern ) {
+	std::string best;
+	std::string cur;
+	size_t i = !pattern.empty() && pattern[0] == '^' ? 1 : 0;
+
+	const auto endRun = [&]() {
+		if ( cur.size() > best.size() )
+			best = cur;
+		cur.clear();
+	};
+
+	while ( i < pattern.size() ) {
+		int literal = -1;
+		size_t next = i + 1;
+
+		switch ( pattern[i] ) {
+			case '(':
+			case ')':
+				endRun();
+				i++;
+				continue;
+			case '%': {
+				if ( i + 1 >= pattern.size() ) {
+					endRun();
+					return best;
+				}
+				char escaped = pattern[i + 1];
+				if ( escaped == 'b' ) {
+					endRun();
+					i += 4;
+					continue;
+				}
+				if ( escaped == 'f' ) {
+					endRun();
+					i = i + 2 < pattern.size() ? skipPatternSet( pattern, i + 2 ) : pattern.size();
+					continue;
+				}
+				// Character classes and back references
+				if ( !isalnum( (unsigned char)escaped ) )
+					literal = (unsigned char)escaped;
+				next = i + 2;
+				break;
+			}
+			case '[':
+				next = skipPatternSet( pattern, i );
+				break;
+			case '.':
+				break;
+			case '$':
+				if ( i + 1 == pattern.size() ) {
+					endRun();
+					return best;
+				}
+				literal = '$';
+				break;
+			default:
+				literal = (unsigned char)pattern[i];
+				break;
+		}
+
+		char quantifier = next < pattern.size() ? pattern[next] : '\0';
+		if ( quantifier == '*' || quantifier == '-' || quantifier == '?' ) {
+			// The item is optional
+			endRun();
+			i = next + 1;
+		} else if ( quantifier == '+' ) {
+			// The item is required but more of it may follow
+			if ( literal >= 0 )
+				cur += (char)literal;
+			endRun();
+			i = next + 1;
+		} else {
+			if ( literal >= 0 )
+				cur += (char)literal;
+			else
+				endRun();
+			i = next;
+		}
+	}
+
+	endRun();
+	return best;
+}
+
+BuildOutputPrefilter::BuildOutputPrefilter( const std::vector<PatternHolder>& patterns ) :
+	mPatternCount( patterns.size() ) {
+	std::unordered_map<std::string, size_t> literalIndex;
+
+	for ( size_t i = 0; i < patterns.size(); i++ ) {
+		std::string literal( getRequiredLiteral( patterns[i].pattern.getPatern() ) );
+		if ( literal.empty() ) {
+			mUnfiltered.push_back( i );
+			continue;
+		}
+
+		auto found = literalIndex.find( literal );
+		if ( found == literalIndex.end() ) {
+			found = literalIndex.insert( { literal, mLiterals.size() } ).first;
+			mByFirstByte[(unsigned char)literal[0]].push_back( mLiterals.size() );
+			mLiterals.push_back( { literal, {} } );
+		}
+		mLiterals[found->second].patterns.push_back( i );
+	}
+}
+
+void BuildOutputPrefilter::filter( std::string_view line, std::vector<bool>& candidates ) const {
+	candidates.assign( mPatternCount, false );
+	for ( size_t pattern : mUnfiltered )
+		candidates[pattern] = true;
+
+	if ( mLiterals.empty() )
+		return;
+
+	size_t found = 0;
+	mFound.assign( mLiterals.size(), false );
+
+	for ( size_t pos = 0; pos < line.size() && found < mLiterals.size(); pos++ ) {
+		for ( Uint32 index : mByFirstByte[(unsigned char)line[pos]] ) {
+			const Literal& literal = mLiterals[index];
+			if ( mFound[index] || line.compare( pos, literal.text.size(), literal.text ) != 0 )
+				continue;
+			mFound[index] = true;
+			found++;
+			for ( size_t pattern : literal.patterns )
+				candidates[pattern] = true;
+		}
+	}
+}
+
+BuildOutputPipeline::BuildOutputPipeline( std::vector<PatternHolder>&& patterns,
+										  size_t maxLines ) :
+	mPatterns( std::move( patterns ) ), mPrefilter( mPatterns ), mMaxLines( maxLines ) {}
+
+bool BuildOutputPipeline::push( const std::string& buffer, const ProjectBuildCommand* cmd ) {
+	if ( cmd ) {
+		size_t start = 0;
+		size_t nl;
+		while ( ( nl = buffer.find_first_of( '\n', start ) ) != std::string::npos ) {
+			mCurLine.append( buffer, start, nl - start );
+			parseLine( mCurLine, cmd );
+			mCurLine.clear();
+			start = nl + 1;
+		}
+		mCurLine.append( buffer, start, std::string::npos );
+	}
+
+	size_t lines = std::count( buffer.begin(), buffer.end(), '\n' );
+
+	Lock l( mMutex );
+
+	if ( mChunks.empty() || mChunks.back().text.size() + buffer.size() > CHUNK_SIZE ) {
+		mChunks.push_back( {} );
+		mChunks.back().text.reserve( eemax( CHUNK_SIZE, buffer.size() ) );
+	}
+	mChunks.back().text += buffer;
+	mChunks.back().lines += lines;
+	mPendingLines += lines;
+
+	// Keep at most mMaxLines pending lines, the UI would drop them anyway
+	while ( mChunks.size() > 1 && mPendingLines - mChunks.front().lines >= mMaxLines ) {
+		mPendingLines -= mChunks.front().lines;
+		mDroppedLines += mChunks.front().lines;
+		mChunks.pop_front();
+	}
+
+	bool schedule = !mPending;
+	mPending = true;
+	return schedule;
+}
+
+void BuildOutputPipeline::flushLine( const ProjectBuildCommand* cmd ) {
+	if ( !mCurLine.empty() && cmd )
+		parseLine( mCurLine, cmd );
+	mCurLine.clear();
+}
+
+BuildOutputPipeline::Batch BuildOutputPipeline::take() {
+	Batch batch;
+	Lock l( mMutex );
+
+	size_t size = 0;
+	for ( const auto& chunk : mChunks )
+		size += chunk.text.size();
+	batch.output.reserve( size );
+	for ( const auto& chunk : mChunks )
+		batch.output += chunk.text;
+
+	batch.droppedLines = mDroppedLines;
+	batch.issues = std::move( mIssues );
+	mIssues.clear();
+	mChunks.clear();
+	mPendingLines = 0;
+	mDroppedLines = 0;
+	mPending = false;
+	return batch;
+}
+
+void BuildOutputPipeline::parseLine( const std::string& line, const ProjectBuildCommand* cmd ) {
+	StatusMessage status;
+	if ( !matchLine( line, cmd, status ) )
+		return;
+	Lock l( mMutex );
+	mIssues.emplace_back( std::move( status ) );
+}
+
+bool BuildOutputPipeline::matchLine( const std::string& text, const ProjectBuildCommand* cmd,
+									 StatusMessage& status ) {
+	LuaPattern::Range matches[12];
+
+	mPrefilter.filter( text, mCandidates );
+
+	for ( size_t p = 0; p < mPatterns.size(); p++ ) {
+		if ( !mCandidates[p] )
+			continue;
+
+		const auto& pattern = mPatterns[p];
+		if ( !pattern.pattern.matches( text, matches ) )
+			continue;
+
+		status.type = pattern.config.type;
+
+		for ( int i = 0; i < (int)pattern.pattern.getNumMatches(); ++i ) {
+			if ( !matches[i].isValid() )
+				break;
+
+			if ( i == 0 ) {
+				status.output = text;
+				continue;
+			}
+
+			std::string subtxt = text.substr( matches[i].start, matches[i].end - matches[i].start );
+			if ( pattern.config.patternOrder.message == i ) {
+				auto nl = subtxt.find_first_of( '\n' );
+				if ( nl == std::string::npos ) {
+					status.message = std::move( subtxt );
+				} else {
+					status.message = subtxt.substr( 0, nl );
+				}
+			} else if ( pattern.config.patternOrder.file == i ) {
+				bool isRelativePath = FileSystem::isRelativePath( subtxt );
+				status.file = !subtxt.empty() && isRelativePath
+								  ? FileSystem::getRealPath( cmd->workingDir + subtxt )
+								  : FileSystem::getRealPath( subtxt );
+				if ( isRelativePath ) {
+					FileInfo file( status.file );
+					if ( !file.exists() || !file.isRegularFile() )
+						status.file = subtxt;
+				}
+				status.fileName = FileSystem::fileNameFromPath( status.file );
+			} else if ( pattern.config.patternOrder.line == i ) {
+				int l;
+				if ( String::fromString( l, subtxt ) )
+					status.line = l;
+			} else if ( pattern.config.patternOrder.col == i ) {
+				int c;
+				if ( String::fromString( c, subtxt ) )
+					status.col = c;
+			}
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+} // namespace ecode
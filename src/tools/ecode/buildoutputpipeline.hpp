@@ -0,0 +1,130 @@
+#ifndef ECODE_BUILDOUTPUTPIPELINE_HPP
+#define ECODE_BUILDOUTPUTPIPELINE_HPP
+
+#include "projectbuild.hpp"
+#include <array>
+#include <deque>
+#include <eepp/system/lock.hpp>
+#include <eepp/system/luapattern.hpp>
+#include <eepp/system/mutex.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace EE;
+using namespace EE::System;
+
+namespace ecode {
+
+struct StatusMessage {
+	ProjectOutputParserTypes type;
+	String output;
+	String message;
+	std::string file;
+	std::string fileName;
+	Int64 line{ 0 };
+	Int64 col{ 0 };
+};
+
+struct PatternHolder {
+	LuaPatternStorage pattern;
+	ProjectBuildOutputParserConfig config;
+};
+
+/**
+ * Discards the output parser patterns that can't match a line before running them. Every
+ * pattern is reduced to the longest literal that any match must contain, and all the literals
+ * are looked for in a single pass over the line.
+ */
+class BuildOutputPrefilter {
+  public:
+	BuildOutputPrefilter() {}
+
+	explicit BuildOutputPrefilter( const std::vector<PatternHolder>& patterns );
+
+	/** Sets `candidates[i]` to true if the pattern `i` may match `line`. */
+	void filter( std::string_view line, std::vector<bool>& candidates ) const;
+
+	/** @return The longest literal contained in every match of a Lua pattern (can be empty) */
+	static std::string getRequiredLiteral( std::string_view pattern );
+
+  protected:
+	struct Literal {
+		std::string text;
+		std::vector<size_t> patterns;
+	};
+
+	std::vector<Literal> mLiterals;
+	/* patterns without a literal, they are always run */
+	std::vector<size_t> mUnfiltered;
+	/* indexes in mLiterals by the first byte of the literal */
+	std::array<std::vector<Uint32>, 256> mByFirstByte;
+	size_t mPatternCount{ 0 };
+	mutable std::vector<bool> mFound;
+};
+
+/**
+ * Moves the output of a build from the thread that reads the process to the UI thread.
+ * The output is kept in a bounded list of chunks (the oldest ones are dropped if the UI doesn't
+ * keep up) and every complete line is matched against the output parser patterns on the build
+ * thread. The UI thread takes all the pending output and issues at once.
+ */
+class BuildOutputPipeline {
+  public:
+	static constexpr size_t DEFAULT_MAX_LINES = 100000;
+
+	static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+	struct Batch {
+		std::string output;
+		/* lines dropped before the output, because the pending output exceeded the limit */
+		size_t droppedLines{ 0 };
+		std::vector<StatusMessage> issues;
+	};
+
+	explicit BuildOutputPipeline( std::vector<PatternHolder>&& patterns,
+								  size_t maxLines = DEFAULT_MAX_LINES );
+
+	/**
+	 * Appends output of the build. The lines are parsed only when `cmd` is set, the messages of
+	 * the build manager have no command.
+	 * @return True if there was nothing pending, so the caller must schedule a take().
+	 */
+	bool push( const std::string& buffer, const ProjectBuildCommand* cmd );
+
+	/** Parses the last line of a command if it didn't end with a line break. */
+	void flushLine( const ProjectBuildCommand* cmd );
+
+	/** Takes everything pushed since the last call. */
+	Batch take();
+
+	size_t getMaxLines() const { return mMaxLines; }
+
+  protected:
+	struct Chunk {
+		std::string text;
+		size_t lines{ 0 };
+	};
+
+	std::vector<PatternHolder> mPatterns;
+	BuildOutputPrefilter mPrefilter;
+	std::vector<bool> mCandidates;
+	std::string mCurLine;
+	size_t mMaxLines;
+
+	Mutex mMutex;
+	std::deque<Chunk> mChunks;
+	size_t mPendingLines{ 0 };
+	size_t mDroppedLines{ 0 };
+	std::vector<StatusMessage> mIssues;
+	bool mPending{ false };
+
+	void parseLine( const std::string& line, const ProjectBuildCommand* cmd );
+
+	bool matchLine( const std::string& line, const ProjectBuildCommand* cmd,
+					StatusMessage& status );
+};
+
+} // namespace ecode
+
+#endif // ECODE_BUILDOUTPUTPIPELINE_HPP
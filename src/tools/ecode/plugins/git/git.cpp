@@ -78,6 +78,18 @@ std::string Git::branch( const std::string& projectDir ) {
 	return "HEAD";
 }
 
+std::string Git::topLevel( const std::string& projectDir ) {
+	std::string buf;
+
+	if ( EXIT_SUCCESS != git( "rev-parse --show-toplevel", projectDir, buf ) )
+		return "";
+
+	String::trimInPlace( buf );
+	if ( !buf.empty() )
+		FileSystem::dirAddSlashAtEnd( buf );
+	return buf;
+}
+
 std::unordered_map<std::string, std::string>
 Git::branches( const std::vector<std::string>& repos ) {
 	std::unordered_map<std::string, std::string> ret;
@@ -543,15 +555,20 @@ Git::Result Git::gitSimple( const std::string& cmd, const std::string& projectDi
 	return res;
 }
 
-Git::Status Git::status( bool recurseSubmodules, const std::string& projectDir ) {
+Git::Status Git::status( bool recurseSubmodules, const std::string& projectDir,
+						 std::vector<std::string> pathspecs ) {
 	static constexpr auto DIFF_CMD = "diff --numstat";
 	static constexpr auto DIFF_STAGED_CMD = "diff --numstat --staged";
 	static constexpr auto STATUS_CMD = "-c color.status=never status -b -u -s";
 	Status s;
 	std::string buf;
+	// File names can contain glob characters, they must only match themselves
+	for ( auto& path : pathspecs )
+		path = ":(literal)" + path;
+	std::string pathspec( pathspecs.empty() ? "" : " -- " + asList( pathspecs ) );
 
 	getSubModules( projectDir );
-	bool submodules = hasSubmodules( projectDir );
+	bool submodules = pathspec.empty() && hasSubmodules( projectDir );
 
 	std::string enteringPtrn( "^Entering '(.*)'" );
 	LuaPattern subModulePattern( enteringPtrn );
@@ -641,7 +658,7 @@ Git::Status Git::status( bool recurseSubmodules, const std::string& projectDir )
 		} );
 	};
 
-	if ( EXIT_SUCCESS != git( STATUS_CMD, projectDir, buf ) )
+	if ( EXIT_SUCCESS != git( STATUS_CMD + pathspec, projectDir, buf ) )
 		return s;
 
 	parseStatus();
@@ -708,12 +725,12 @@ Git::Status Git::status( bool recurseSubmodules, const std::string& projectDir )
 		} );
 	};
 
-	if ( EXIT_SUCCESS != git( DIFF_CMD, projectDir, buf ) )
+	if ( EXIT_SUCCESS != git( DIFF_CMD + pathspec, projectDir, buf ) )
 		return s;
 
 	parseNumStat( false );
 
-	git( DIFF_STAGED_CMD, projectDir, buf );
+	git( DIFF_STAGED_CMD + pathspec, projectDir, buf );
 	parseNumStat( true );
 
 	if ( recurseSubmodules && submodules ) {
@@ -797,6 +814,138 @@ Git::Blame Git::blame( const std::string& filepath, std::size_t line ) const {
 			 line };
 }
 
+Git::Blame Git::BlameFile::getLine( std::size_t line ) const {
+	if ( !error.empty() )
+		return { error };
+
+	if ( line == 0 || line > lines.size() || lines[line - 1] == NotCommitted )
+		return { "Not Committed Yet" };
+
+	auto commit = commits[lines[line - 1]];
+
+	return { std::move( commit.author ),
+			 std::move( commit.authorEmail ),
+			 std::move( commit.date ),
+			 std::move( commit.commitHash ),
+			 std::move( commit.commitShortHash ),
+			 std::move( commit.commitMessage ),
+			 line };
+}
+
+Git::BlameFile Git::blameFile( const std::string& filepath,
+							   const std::string& contentsPath ) const {
+	BlameFile blame;
+	std::string buf;
+	std::string workingDir( FileSystem::fileRemoveFileName( filepath ) );
+	std::string args( "blame -p" );
+	if ( !contentsPath.empty() )
+		args += String::format( " --contents \"%s\"", contentsPath );
+	args += String::format( " -- \"%s\"", filepath );
+
+	if ( EXIT_SUCCESS != git( args, workingDir, buf ) ) {
+		blame.error = String::startsWith( buf, "fatal: " ) ? buf.substr( 7 ) : buf;
+		return blame;
+	}
+
+	// Abbreviated hashes share the length that git decides for the repository
+	std::string shortHead;
+	size_t shortHashLength = 7;
+	if ( EXIT_SUCCESS == git( "rev-parse --short HEAD", workingDir, shortHead ) &&
+		 !String::rTrim( shortHead, '\n' ).empty() )
+		shortHashLength = String::rTrim( shortHead, '\n' ).size();
+
+	std::unordered_map<std::string_view, uint32_t> commitsIndex;
+	uint32_t curCommit = BlameFile::NotCommitted;
+	size_t curLine = 0;
+
+	const auto setDate = [&blame]( uint32_t commitIdx ) {
+		auto& date = blame.commits[commitIdx].date;
+		auto tzPos = date.find( ' ' );
+		std::string tz( tzPos != std::string::npos ? date.substr( tzPos + 1 ) : "" );
+		Uint64 epoch;
+		if ( String::fromString( epoch, date.substr( 0, tzPos ) ) )
+			date = Sys::epochToString( epoch ) + ( tz.empty() ? "" : " " + tz );
+	};
+
+	const auto getValue = []( std::string_view line, std::string_view key, std::string& val ) {
+		if ( line.size() > key.size() && line[key.size()] == ' ' &&
+			 line.substr( 0, key.size() ) == key ) {
+			val = std::string( line.substr( key.size() + 1 ) );
+			return true;
+		}
+		return false;
+	};
+
+	StringHelper::readBySeparator(
+		buf,
+		[&]( const std::string_view& line ) {
+			if ( line.empty() )
+				return;
+
+			// Line contents, ends the line entry
+			if ( line[0] == '\t' ) {
+				if ( curLine > 0 ) {
+					if ( blame.lines.size() < curLine )
+						blame.lines.resize( curLine, BlameFile::NotCommitted );
+					blame.lines[curLine - 1] = curCommit;
+				}
+				return;
+			}
+
+			// Line entry header: <hash> <original line> <final line> [<lines in group>]
+			auto hashEnd = line.find( ' ' );
+			if ( hashEnd != std::string_view::npos && hashEnd >= 40 &&
+				 line.find_first_not_of( "0123456789abcdef" ) == hashEnd ) {
+				auto hash = line.substr( 0, hashEnd );
+				auto finalLine = line.substr( hashEnd + 1 );
+				finalLine = finalLine.substr( finalLine.find( ' ' ) + 1 );
+				String::fromString( curLine, std::string( finalLine.substr(
+												 0, finalLine.find( ' ' ) ) ) );
+
+				if ( hash == sNotCommitedYetHash ) {
+					curCommit = BlameFile::NotCommitted;
+					return;
+				}
+
+				auto found = commitsIndex.find( hash );
+				if ( found != commitsIndex.end() ) {
+					curCommit = found->second;
+					return;
+				}
+
+				curCommit = blame.commits.size();
+				BlameCommit commit;
+				commit.commitHash = std::string( hash );
+				commit.commitShortHash = commit.commitHash.substr( 0, shortHashLength );
+				blame.commits.emplace_back( std::move( commit ) );
+				// The view points to buf, which outlives the index
+				commitsIndex[hash] = curCommit;
+				return;
+			}
+
+			if ( curCommit == BlameFile::NotCommitted )
+				return;
+
+			auto& commit = blame.commits[curCommit];
+			std::string value;
+			if ( getValue( line, "author"sv, commit.author ) ||
+				 getValue( line, "summary"sv, commit.commitMessage ) ) {
+				return;
+			} else if ( getValue( line, "author-mail"sv, value ) ) {
+				commit.authorEmail =
+					value.size() > 3 ? value.substr( 1, value.size() - 2 ) : value;
+			} else if ( getValue( line, "author-time"sv, value ) ) {
+				commit.date = value;
+			} else if ( getValue( line, "author-tz"sv, value ) ) {
+				commit.date += " " + value;
+				setDate( curCommit );
+			}
+		},
+		'\n' );
+
+	return blame;
+}
+
 Git::GitStatusReport Git::statusFromShortStatusStr( const std::string_view& statusStr ) {
 	Uint16 status = git_xy( statusStr[0], statusStr[1] );
 	GitStatus gitStatus = GitStatus::NotSet;
@@ -35,6 +35,30 @@ class Git {
 		std::size_t line{ 0 };
 	};
 
+	struct BlameCommit {
+		std::string author;
+		std::string authorEmail;
+		std::string date;
+		std::string commitHash;
+		std::string commitShortHash;
+		std::string commitMessage;
+	};
+
+	/** Blame information of every line of a file. Commits are interned, each line only keeps the
+	 * index of its commit. */
+	struct BlameFile {
+		static constexpr uint32_t NotCommitted = UINT32_MAX;
+
+		std::string error;
+		std::vector<BlameCommit> commits;
+		std::vector<uint32_t> lines;
+
+		bool isValid() const { return error.empty(); }
+
+		/** @param line 1-based line number (same as Git::blame) */
+		Blame getLine( std::size_t line ) const;
+	};
+
 	enum class GitStatusChar : char {
 		Unknown = ' ',
 		Modified = 'M',
@@ -239,11 +263,23 @@ class Git {
 
 	Blame blame( const std::string& filepath, std::size_t line ) const;
 
+	/** Blames the whole file with a single git process.
+	 * @param contentsPath If set, blames the contents of this file as if it were the working tree
+	 * version of filepath (used to blame unsaved documents). */
+	BlameFile blameFile( const std::string& filepath, const std::string& contentsPath = "" ) const;
+
 	std::string branch( const std::string& projectDir = "" );
 
+	/** @return The root of the working tree (with a slash at the end), or an empty string if the
+	 * directory is not inside a repository */
+	std::string topLevel( const std::string& projectDir = "" );
+
 	std::unordered_map<std::string, std::string> branches( const std::vector<std::string>& repos );
 
-	Status status( bool recurseSubmodules, const std::string& projectDir = "" );
+	/** @param pathspecs If not empty, only the status of these paths (relative to the project
+	 * directory, matched literally) is queried and submodules are not recursed */
+	Status status( bool recurseSubmodules, const std::string& projectDir = "",
+				   std::vector<std::string> pathspecs = {} );
 
 	Result add( std::vector<std::string> files, const std::string& projectDir = "" );
 
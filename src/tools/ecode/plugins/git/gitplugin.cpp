@@ -1,9 +1,11 @@
 #include "gitplugin.hpp"
 #include "gitbranchmodel.hpp"
 #include "gitstatusmodel.hpp"
+#include "gitstatusservice.hpp"
 #include <eepp/graphics/primitives.hpp>
 #include <eepp/scene/scenemanager.hpp>
 #include <eepp/system/filesystem.hpp>
+#include <eepp/system/iostreamstring.hpp>
 #include <eepp/system/luapattern.hpp>
 #include <eepp/system/scopedop.hpp>
 #include <eepp/ui/doc/syntaxdefinitionmanager.hpp>
@@ -92,6 +94,14 @@ GitPlugin::~GitPlugin() {
 
 	endModelStyler();
 
+	{
+		Lock l( mBlameMutex );
+		for ( const auto& client : mBlameClients )
+			client.first->unregisterClient( client.second.get() );
+		mBlameClients.clear();
+		mBlameCache.clear();
+	}
+
 	if ( getUISceneNode() )
 		getUISceneNode()->removeActionsByTag( GIT_STATUS_UPDATE_TAG );
 
@@ -221,6 +231,7 @@ void GitPlugin::load( PluginManager* pluginManager ) {
 
 	mGit = std::make_unique<Git>( pluginManager->getWorkspaceFolder() );
 	mGit->setLogLevel( mSilence ? LogLevel::Warning : LogLevel::Info );
+	mGitStatusService = std::make_unique<GitStatusService>( mGit.get() );
 	mGitFound = !mGit->getGitPath().empty();
 	mProjectPath = mRepoSelected = mGit->getProjectPath();
 
@@ -391,8 +402,18 @@ void GitPlugin::updateStatusBarSync() {
 }
 
 void GitPlugin::updateStatus( bool force ) {
-	if ( !mGit || !mGitFound || mRunningUpdateStatus )
+	if ( !mGit || !mGitFound )
 		return;
+
+	if ( force )
+		mGitStatusService->invalidateAll();
+
+	// Requests arriving while a refresh is running are coalesced into a single refresh
+	if ( mRunningUpdateStatus ) {
+		mPendingUpdateStatus = true;
+		mPendingUpdateStatusForce = mPendingUpdateStatusForce || force;
+		return;
+	}
 	mRunningUpdateStatus++;
 	mThreadPool->run(
 		[this, force] {
@@ -407,7 +428,7 @@ void GitPlugin::updateStatus( bool force ) {
 				Lock l( mGitStatusMutex );
 				prevGitStatus = mGitStatus;
 			}
-			Git::Status newGitStatus = mGit->status( mStatusRecurseSubmodules );
+			Git::Status newGitStatus = mGitStatusService->status( mStatusRecurseSubmodules );
 			UnorderedSet<std::string> cache;
 
 			for ( const auto& status : newGitStatus.files ) {
@@ -437,7 +458,16 @@ void GitPlugin::updateStatus( bool force ) {
 
 			getUISceneNode()->runOnMainThread( [this] { updateStatusBarSync(); } );
 		},
-		[this]( auto ) { mRunningUpdateStatus--; } );
+		[this]( auto ) {
+			mRunningUpdateStatus--;
+			if ( mPendingUpdateStatus && !mShuttingDown ) {
+				bool pendingForce = mPendingUpdateStatusForce;
+				mPendingUpdateStatus = false;
+				mPendingUpdateStatusForce = false;
+				updateStatus( pendingForce );
+			}
+		},
+		0, ThreadPool::Priority::Background );
 }
 
 PluginRequestHandle GitPlugin::processMessage( const PluginMessage& msg ) {
@@ -505,6 +535,20 @@ void GitPlugin::onFileSystemEvent( const FileEvent& ev, const FileInfo& file ) {
 		 ( file.getExtension() == "lock" || file.isDirectory() ) )
 		return;
 
+	mGitStatusService->invalidatePath( file.getFilepath() );
+
+	if ( String::startsWith( file.getFilepath(), mGit->getGitFolder() ) ) {
+		// HEAD moved (checkout, commit, reset, pull...), every blame is outdated
+		std::string_view gitFile( file.getFilepath() );
+		gitFile.remove_prefix( mGit->getGitFolder().size() );
+		if ( !gitFile.empty() && ( gitFile.front() == '/' || gitFile.front() == '\\' ) )
+			gitFile.remove_prefix( 1 );
+		if ( gitFile == "HEAD" || gitFile == "packed-refs" || String::startsWith( gitFile, "refs" ) )
+			blameInvalidateAll();
+	} else {
+		blameInvalidate( file.getFilepath() );
+	}
+
 	updateUI();
 }
 
@@ -614,9 +658,23 @@ void GitPlugin::onBeforeUnregister( UICodeEditor* editor ) {
 		editor->getKeyBindings().removeCommandKeybind( kb.first );
 }
 
+void GitPlugin::onRegisterDocument( TextDocument* doc ) {
+	Lock l( mBlameMutex );
+	mBlameClients[doc] = std::make_unique<GitBlameClient>( this, doc );
+	doc->registerClient( mBlameClients[doc].get() );
+}
+
 void GitPlugin::onUnregisterDocument( TextDocument* doc ) {
 	for ( auto& kb : mKeyBindings )
 		doc->removeCommand( kb.first );
+
+	Lock l( mBlameMutex );
+	auto clientIt = mBlameClients.find( doc );
+	if ( clientIt != mBlameClients.end() ) {
+		doc->unregisterClient( clientIt->second.get() );
+		mBlameClients.erase( clientIt );
+	}
+	mBlameCache.erase( doc );
 }
 
 Color GitPlugin::getVarColor( const std::string& var ) {
@@ -631,18 +689,153 @@ void GitPlugin::blame( UICodeEditor* editor ) {
 				  "Git binary not found.\nPlease check that git is accesible via PATH" ) );
 		return;
 	}
-	mThreadPool->run( [this, editor]() {
-		auto blame = mGit->blame( editor->getDocument().getFilePath(),
-								  editor->getDocument().getSelection().start().line() + 1 );
-		editor->runOnMainThread( [this, editor, blame] {
-			displayTooltip(
-				editor, blame,
-				editor->getScreenPosition( editor->getDocument().getSelection().start() )
-					.getPosition() );
-		} );
+
+	TextDocument* doc = editor->getDocumentRef().get();
+	const auto displayBlame = [this, editor]( const Git::Blame& blame ) {
+		displayTooltip(
+			editor, blame,
+			editor->getScreenPosition( editor->getDocument().getSelection().start() )
+				.getPosition() );
+	};
+
+	std::size_t line = doc->getSelection().start().line() + 1;
+
+	std::optional<Git::Blame> cachedBlame;
+	{
+		Lock l( mBlameMutex );
+		auto cacheIt = mBlameCache.find( doc );
+		if ( cacheIt != mBlameCache.end() && cacheIt->second.loading )
+			return;
+		if ( cacheIt != mBlameCache.end() && !cacheIt->second.stale ) {
+			cachedBlame = cacheIt->second.blame.getLine( line );
+		} else {
+			auto& cache = mBlameCache[doc];
+			cache = {};
+			cache.filePath = doc->getFilePath();
+			cache.loading = true;
+		}
+	}
+
+	if ( cachedBlame ) {
+		displayBlame( *cachedBlame );
+		return;
+	}
+
+	// Unsaved documents are blamed with their current contents so lines match
+	std::string contentsPath;
+	if ( doc->isDirty() ) {
+		IOStreamString text;
+		doc->save( text, true );
+		contentsPath = Sys::getTempPath() + "ecode-blame-" +
+					   String::toString( String::hash( doc->getFilePath() ) );
+		if ( !FileSystem::fileWrite( contentsPath, text.getStream() ) )
+			contentsPath.clear();
+	}
+
+	std::string filePath( doc->getFilePath() );
+	mThreadPool->run( [this, editor, doc, filePath, line, contentsPath, displayBlame]() {
+		auto blame = mGit->blameFile( filePath, contentsPath );
+		if ( !contentsPath.empty() )
+			FileSystem::fileRemove( contentsPath );
+
+		auto lineBlame = blame.getLine( line );
+
+		{
+			Lock l( mBlameMutex );
+			auto cacheIt = mBlameCache.find( doc );
+			if ( cacheIt == mBlameCache.end() )
+				return;
+			cacheIt->second.loading = false;
+			cacheIt->second.blame = std::move( blame );
+		}
+
+		editor->runOnMainThread( [lineBlame, displayBlame] { displayBlame( lineBlame ); } );
 	} );
 }
 
+void GitPlugin::blameInvalidate( TextDocument* doc ) {
+	Lock l( mBlameMutex );
+	auto cacheIt = mBlameCache.find( doc );
+	if ( cacheIt == mBlameCache.end() )
+		return;
+	if ( cacheIt->second.loading )
+		cacheIt->second.stale = true;
+	else
+		mBlameCache.erase( cacheIt );
+}
+
+void GitPlugin::blameInvalidate( const std::string& filePath ) {
+	Lock l( mBlameMutex );
+	for ( auto& cache : mBlameCache ) {
+		if ( cache.second.filePath == filePath )
+			cache.second.stale = true;
+	}
+}
+
+void GitPlugin::blameInvalidateAll() {
+	Lock l( mBlameMutex );
+	for ( auto& cache : mBlameCache )
+		cache.second.stale = true;
+}
+
+void GitPlugin::GitBlameClient::onDocumentTextChanged( const DocumentContentChange& change ) {
+	Lock l( mParent->mBlameMutex );
+	auto cacheIt = mParent->mBlameCache.find( mDoc );
+	if ( cacheIt == mParent->mBlameCache.end() || cacheIt->second.stale )
+		return;
+
+	auto& cache = cacheIt->second;
+	if ( cache.loading ) {
+		cache.stale = true;
+		return;
+	}
+
+	if ( !cache.blame.isValid() )
+		return;
+
+	// Shift the blamed lines to follow the local edits, any edited line is reported as not
+	// committed until the file is blamed again
+	auto& lines = cache.blame.lines;
+	const auto setNotCommitted = [&lines]( Int64 line ) {
+		if ( line >= 0 && line < (Int64)lines.size() )
+			lines[line] = Git::BlameFile::NotCommitted;
+	};
+	auto range = change.range.normalized();
+
+	if ( change.text.empty() ) {
+		Int64 from = range.start().line();
+		Int64 to = range.end().line();
+		if ( range.start().column() == 0 && range.end().column() == 0 ) {
+			// Whole lines removed, the remaining lines are untouched
+			to = eemin( to, (Int64)lines.size() );
+			if ( from < to )
+				lines.erase( lines.begin() + from, lines.begin() + to );
+		} else {
+			to = eemin( to + 1, (Int64)lines.size() );
+			if ( from + 1 < to )
+				lines.erase( lines.begin() + from + 1, lines.begin() + to );
+			if ( range.hasSelection() )
+				setNotCommitted( from );
+		}
+		return;
+	}
+
+	Int64 newLines = std::count( change.text.begin(), change.text.end(), '\n' );
+	Int64 at = range.start().line();
+
+	if ( newLines == 0 ) {
+		setNotCommitted( at );
+	} else if ( range.start().column() == 0 && change.text.back() == '\n' ) {
+		// Whole lines inserted before the line
+		if ( at <= (Int64)lines.size() )
+			lines.insert( lines.begin() + at, newLines, Git::BlameFile::NotCommitted );
+	} else {
+		setNotCommitted( at );
+		if ( at + 1 <= (Int64)lines.size() )
+			lines.insert( lines.begin() + at + 1, newLines, Git::BlameFile::NotCommitted );
+	}
+}
+
 // Branch operations
 
 void GitPlugin::checkout( Git::Branch branch ) {
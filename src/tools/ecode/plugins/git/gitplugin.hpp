@@ -23,6 +23,7 @@ namespace ecode {
 
 class Git;
 class GitBranchModel;
+class GitStatusService;
 
 static constexpr const char* GIT_EMPTY = "";
 static constexpr const char* GIT_SUCCESS = "success";
@@ -78,6 +79,7 @@ class GitPlugin : public PluginBase {
 
   protected:
 	std::unique_ptr<Git> mGit;
+	std::unique_ptr<GitStatusService> mGitStatusService;
 	std::unordered_map<std::string, std::string> mGitBranches;
 	Git::Status mGitStatus;
 	std::vector<std::pair<std::string, std::string>> mRepos;
@@ -117,6 +119,8 @@ class GitPlugin : public PluginBase {
 	UILoader* mLoader{ nullptr };
 	std::atomic<int> mRunningUpdateBranches{ 0 };
 	std::atomic<int> mRunningUpdateStatus{ 0 };
+	std::atomic<bool> mPendingUpdateStatus{ false };
+	std::atomic<bool> mPendingUpdateStatusForce{ false };
 	Clock mLastBranchesUpdate;
 	Mutex mGitBranchMutex;
 	Mutex mGitStatusMutex;
@@ -134,6 +138,41 @@ class GitPlugin : public PluginBase {
 	Uint32 mModelChangedId{ 0 };
 	Uint32 mModelStylerId{ 0 };
 
+	class GitBlameClient : public TextDocument::Client {
+	  public:
+		explicit GitBlameClient( GitPlugin* parent, TextDocument* doc ) :
+			mDoc( doc ), mParent( parent ) {}
+
+		virtual void onDocumentTextChanged( const DocumentContentChange& );
+		virtual void onDocumentUndoRedo( const TextDocument::UndoRedo& ) {};
+		virtual void onDocumentCursorChange( const TextPosition& ) {};
+		virtual void onDocumentSelectionChange( const TextRange& ) {};
+		virtual void onDocumentLineCountChange( const size_t&, const size_t& ) {};
+		virtual void onDocumentLineChanged( const Int64& ) {};
+		virtual void onDocumentSaved( TextDocument* ) {};
+		virtual void onDocumentClosed( TextDocument* ) {};
+		virtual void onDocumentDirtyOnFileSystem( TextDocument* ) {};
+		virtual void onDocumentMoved( TextDocument* doc ) { mParent->blameInvalidate( doc ); };
+		virtual void onDocumentReloaded( TextDocument* doc ) { mParent->blameInvalidate( doc ); };
+		virtual void onDocumentReset( TextDocument* doc ) { mParent->blameInvalidate( doc ); }
+
+	  protected:
+		TextDocument* mDoc{ nullptr };
+		GitPlugin* mParent{ nullptr };
+	};
+
+	struct BlameCache {
+		Git::BlameFile blame;
+		std::string filePath;
+		bool loading{ false };
+		//! The document was modified while the blame was running, lines can't be mapped
+		bool stale{ false };
+	};
+
+	std::unordered_map<TextDocument*, std::unique_ptr<GitBlameClient>> mBlameClients;
+	std::unordered_map<TextDocument*, BlameCache> mBlameCache;
+	Mutex mBlameMutex;
+
 	GitPlugin( PluginManager* pluginManager, bool sync );
 
 	void load( PluginManager* pluginManager );
@@ -148,12 +187,20 @@ class GitPlugin : public PluginBase {
 
 	void onBeforeUnregister( UICodeEditor* ) override;
 
+	void onRegisterDocument( TextDocument* ) override;
+
 	void onUnregisterDocument( TextDocument* ) override;
 
 	Color getVarColor( const std::string& var );
 
 	void blame( UICodeEditor* editor );
 
+	void blameInvalidate( TextDocument* doc );
+
+	void blameInvalidate( const std::string& filePath );
+
+	void blameInvalidateAll();
+
 	void checkout( Git::Branch branch );
 
 	void branchRename( Git::Branch branch );
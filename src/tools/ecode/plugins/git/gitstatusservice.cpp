@@ -0,0 +1,191 @@
+#include "gitstatusservice.hpp"
+#include <algorithm>
+#include <eepp/system/filesystem.hpp>
+#include <eepp/system/lock.hpp>
+
+namespace ecode {
+
+// Above this amount of modified paths a full status query is cheaper than the pathspec list
+static constexpr size_t MAX_PATHSPECS = 64;
+
+static bool pathContains( const std::string& path, const std::string& file ) {
+	return file == path ||
+		   ( file.size() > path.size() && String::startsWith( file, path ) &&
+			 file[path.size()] == '/' );
+}
+
+GitStatusService::GitStatusService( Git* git ) : mGit( git ) {}
+
+void GitStatusService::invalidatePath( const std::string& path ) {
+	const std::string& projectPath = mGit->getProjectPath();
+	const std::string& gitFolder = mGit->getGitFolder();
+
+	if ( projectPath.empty() )
+		return;
+
+	// git reports the root with forward slashes on every platform
+	std::string root( repoRoot( projectPath ) );
+	std::string filePath( path );
+	std::replace( filePath.begin(), filePath.end(), '\\', '/' );
+	std::replace( root.begin(), root.end(), '\\', '/' );
+	if ( !String::startsWith( filePath, root ) )
+		return;
+
+	Lock l( mMutex );
+	auto& entry = mEntries[projectPath];
+
+	if ( !gitFolder.empty() && String::startsWith( path, gitFolder ) ) {
+		std::string gitFile( path.substr( gitFolder.size() ) );
+		if ( !gitFile.empty() && ( gitFile.front() == '/' || gitFile.front() == '\\' ) )
+			gitFile.erase( 0, 1 );
+		if ( gitFile == "index" || gitFile == "HEAD" || gitFile == "packed-refs" ||
+			 String::startsWith( gitFile, "refs" ) || String::startsWith( gitFile, "modules" ) )
+			entry.fullRefresh = true;
+		return;
+	}
+
+	if ( FileSystem::fileNameFromPath( path ) == ".gitignore" ) {
+		entry.fullRefresh = true;
+		return;
+	}
+
+	if ( entry.fullRefresh )
+		return;
+
+	std::string relPath( filePath.substr( root.size() ) );
+	while ( !relPath.empty() && relPath.back() == '/' )
+		relPath.pop_back();
+
+	if ( relPath.empty() ) {
+		entry.fullRefresh = true;
+		return;
+	}
+
+	entry.dirtyPaths.insert( std::move( relPath ) );
+
+	if ( entry.dirtyPaths.size() > MAX_PATHSPECS ) {
+		entry.dirtyPaths.clear();
+		entry.fullRefresh = true;
+	}
+}
+
+void GitStatusService::invalidateAll() {
+	Lock l( mMutex );
+	for ( auto& entry : mEntries ) {
+		entry.second.dirtyPaths.clear();
+		entry.second.fullRefresh = true;
+	}
+}
+
+Git::Status GitStatusService::status( bool recurseSubmodules ) {
+	Lock rl( mRefreshMutex );
+	std::string projectPath( mGit->getProjectPath() );
+	std::string root( repoRoot( projectPath ) );
+	Uint64 indexModificationTime =
+		FileInfo( mGit->getGitFolder() + "/index" ).getModificationTime();
+	std::set<std::string> dirtyPaths;
+	Git::Status status;
+	bool fullRefresh = false;
+
+	{
+		Lock l( mMutex );
+		auto& entry = mEntries[projectPath];
+		fullRefresh = !entry.valid || entry.fullRefresh ||
+					  entry.indexModificationTime != indexModificationTime ||
+					  entry.recurseSubmodules != recurseSubmodules;
+
+		if ( !fullRefresh && entry.dirtyPaths.empty() )
+			return entry.status;
+
+		// Anything invalidated from now on will be applied in the next refresh
+		dirtyPaths = std::move( entry.dirtyPaths );
+		entry.dirtyPaths.clear();
+		entry.fullRefresh = false;
+		if ( !fullRefresh )
+			status = entry.status;
+	}
+
+	if ( !fullRefresh && recurseSubmodules ) {
+		auto subModules = mGit->getSubModules();
+		fullRefresh = std::any_of( dirtyPaths.begin(), dirtyPaths.end(),
+								   [&subModules]( const std::string& path ) {
+									   return std::any_of( subModules.begin(), subModules.end(),
+														   [&path]( const std::string& sub ) {
+															   return pathContains( sub, path );
+														   } );
+								   } );
+	}
+
+	if ( fullRefresh ) {
+		status = mGit->status( recurseSubmodules, root );
+	} else {
+		merge( status,
+			   mGit->status( false, root,
+							 std::vector<std::string>( dirtyPaths.begin(), dirtyPaths.end() ) ),
+			   dirtyPaths );
+	}
+
+	{
+		Lock l( mMutex );
+		auto& entry = mEntries[projectPath];
+		entry.status = status;
+		entry.indexModificationTime = indexModificationTime;
+		entry.recurseSubmodules = recurseSubmodules;
+		entry.valid = true;
+	}
+
+	return status;
+}
+
+std::string GitStatusService::repoRoot( const std::string& projectPath ) {
+	{
+		Lock l( mMutex );
+		auto found = mRepoRoots.find( projectPath );
+		if ( found != mRepoRoots.end() )
+			return found->second;
+	}
+
+	std::string root( mGit->topLevel( projectPath ) );
+	if ( root.empty() )
+		root = projectPath;
+
+	Lock l( mMutex );
+	mRepoRoots[projectPath] = root;
+	return root;
+}
+
+void GitStatusService::merge( Git::Status& status, Git::Status&& partial,
+							  const std::set<std::string>& paths ) const {
+	const auto isAffected = [&paths]( const Git::DiffFile& file ) {
+		return std::any_of( paths.begin(), paths.end(), [&file]( const std::string& path ) {
+			return pathContains( path, file.file );
+		} );
+	};
+
+	for ( auto& repo : status.files ) {
+		auto& files = repo.second;
+		files.erase( std::remove_if( files.begin(), files.end(), isAffected ), files.end() );
+	}
+
+	for ( auto& repo : partial.files ) {
+		auto& files = status.files[repo.first];
+		for ( auto& file : repo.second )
+			files.emplace_back( std::move( file ) );
+	}
+
+	status.totalInserts = 0;
+	status.totalDeletions = 0;
+	for ( auto it = status.files.begin(); it != status.files.end(); ) {
+		if ( it->second.empty() ) {
+			it = status.files.erase( it );
+			continue;
+		}
+		for ( const auto& file : it->second ) {
+			status.totalInserts += file.inserts;
+			status.totalDeletions += file.deletes;
+		}
+		++it;
+	}
+}
+
+} // namespace ecode
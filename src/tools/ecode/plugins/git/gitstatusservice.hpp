@@ -0,0 +1,57 @@
+#ifndef ECODE_GITSTATUSSERVICE_HPP
+#define ECODE_GITSTATUSSERVICE_HPP
+
+#include "git.hpp"
+
+#include <eepp/system/mutex.hpp>
+#include <set>
+
+using namespace EE;
+using namespace EE::System;
+
+namespace ecode {
+
+/** Keeps the last git status of each repository and only queries git again when something
+ * changed. Working tree changes reported by the file system listener are re-queried using
+ * pathspecs, any change in the index, HEAD or refs triggers a full status query. */
+class GitStatusService {
+  public:
+	explicit GitStatusService( Git* git );
+
+	/** Marks a file or directory (absolute path) as modified */
+	void invalidatePath( const std::string& path );
+
+	/** Forces a full status query on the next request */
+	void invalidateAll();
+
+	/** Returns the repository status. Concurrent requests are serialized and reuse the result of
+	 * the refresh in progress if nothing changed meanwhile. */
+	Git::Status status( bool recurseSubmodules );
+
+  protected:
+	struct Entry {
+		Git::Status status;
+		std::set<std::string> dirtyPaths;
+		Uint64 indexModificationTime{ 0 };
+		bool recurseSubmodules{ false };
+		bool valid{ false };
+		bool fullRefresh{ true };
+	};
+
+	Git* mGit{ nullptr };
+	std::map<std::string, Entry> mEntries;
+	std::map<std::string, std::string> mRepoRoots;
+	Mutex mMutex;
+	Mutex mRefreshMutex;
+
+	/** The pathspecs and the status file names are relative to the root of the working tree,
+	 * which is not the project path when the project is a subdirectory of the repository */
+	std::string repoRoot( const std::string& projectPath );
+
+	void merge( Git::Status& status, Git::Status&& partial,
+				const std::set<std::string>& paths ) const;
+};
+
+} // namespace ecode
+
+#endif // ECODE_GITSTATUSSERVICE_HPP
@@ -35,7 +35,8 @@ Plugin* LinterPlugin::NewSync( PluginManager* pluginManager ) {
 	return eeNew( LinterPlugin, ( pluginManager, true ) );
 }
 
-LinterPlugin::LinterPlugin( PluginManager* pluginManager, bool sync ) : Plugin( pluginManager ) {
+LinterPlugin::LinterPlugin( PluginManager* pluginManager, bool sync ) :
+	Plugin( pluginManager ), mMaxConcurrentLinters( eemax<int>( 1, Sys::getCPUCount() / 2 ) ) {
 	if ( sync ) {
 		load( pluginManager );
 	} else {
@@ -111,6 +112,12 @@ void LinterPlugin::loadLinterConfig( const std::string& path, bool updateConfigF
 		else if ( updateConfigFile )
 			config["delay_time"] = getDelayTime().toString();
 
+		if ( config.contains( "max_concurrent_linters" ) &&
+			 config["max_concurrent_linters"].is_number_integer() )
+			setMaxConcurrentLinters( config["max_concurrent_linters"].get<int>() );
+		else if ( updateConfigFile )
+			config["max_concurrent_linters"] = getMaxConcurrentLinters();
+
 		if ( config.contains( "enable_lsp_diagnostics" ) &&
 			 config["enable_lsp_diagnostics"].is_boolean() )
 			setEnableLSPDiagnostics( config["enable_lsp_diagnostics"].get<bool>() );
@@ -350,14 +357,68 @@ void LinterPlugin::insertMatches( TextDocument* doc,
 	}
 }
 
+static bool isSameMatch( const LinterMatch& left, const LinterMatch& right ) {
+	return left.origin == right.origin && left.type == right.type &&
+		   left.range == right.range && left.lineCache == right.lineCache &&
+		   left.text == right.text;
+}
+
+static LinterMatch* findSameMatch( std::map<Int64, std::vector<LinterMatch>>& docMatches,
+								   const Int64& line, const LinterMatch& match ) {
+	auto lineIt = docMatches.find( line );
+	if ( lineIt == docMatches.end() )
+		return nullptr;
+	for ( auto& oldMatch : lineIt->second )
+		if ( isSameMatch( oldMatch, match ) )
+			return &oldMatch;
+	return nullptr;
+}
+
 void LinterPlugin::setMatches( TextDocument* doc, const MatchOrigin& origin,
 							   std::map<Int64, std::vector<LinterMatch>>& matches ) {
-	if ( !mEnableLSPDiagnostics ) {
+	{
 		Lock matchesLock( mMatchesMutex );
-		mMatches[doc] = std::move( matches );
-	} else {
-		eraseMatchesFromOrigin( doc, origin );
-		insertMatches( doc, matches );
+		// Checked with the matches locked, a closed document erases its matches after cancelling
+		if ( origin == MatchOrigin::Linter && isLintCancelled( doc ) )
+			return;
+
+		auto& docMatches = mMatches[doc];
+		size_t oldCount = 0;
+		size_t newCount = 0;
+		bool changed = false;
+
+		for ( const auto& lineMatches : docMatches )
+			for ( const auto& match : lineMatches.second )
+				if ( !mEnableLSPDiagnostics || match.origin == origin )
+					oldCount++;
+
+		for ( auto& lineMatches : matches ) {
+			for ( auto& match : lineMatches.second ) {
+				newCount++;
+				if ( !changed && !findSameMatch( docMatches, lineMatches.first, match ) )
+					changed = true;
+			}
+		}
+
+		// Nothing changed, keep the current matches and their cached layout
+		if ( !changed && oldCount == newCount )
+			return;
+
+		// Reuse the layout of the matches that didn't change
+		for ( auto& lineMatches : matches ) {
+			for ( auto& match : lineMatches.second ) {
+				LinterMatch* oldMatch = findSameMatch( docMatches, lineMatches.first, match );
+				if ( oldMatch )
+					match.box = oldMatch->box;
+			}
+		}
+
+		if ( !mEnableLSPDiagnostics ) {
+			docMatches = std::move( matches );
+		} else {
+			eraseMatchesFromOrigin( doc, origin );
+			insertMatches( doc, matches );
+		}
 	}
 
 	invalidateEditors( doc );
@@ -629,6 +690,7 @@ void LinterPlugin::onRegister( UICodeEditor* editor ) {
 			TextDocument* doc = docEvent->getDoc();
 			mDocs.erase( doc );
 			mDirtyDoc.erase( doc );
+			cancelLint( doc );
 			Lock matchesLock( mMatchesMutex );
 			mMatches.erase( doc );
 		} ) );
@@ -640,6 +702,7 @@ void LinterPlugin::onRegister( UICodeEditor* editor ) {
 			Lock l( mDocMutex );
 			mDocs.erase( oldDoc );
 			mDirtyDoc.erase( oldDoc );
+			cancelLint( oldDoc );
 			mEditorDocs[editor] = newDoc;
 			mDocs.insert( newDoc );
 			Lock matchesLock( mMatchesMutex );
@@ -702,6 +765,7 @@ void LinterPlugin::onUnregister( UICodeEditor* editor ) {
 
 	mDocs.erase( doc );
 	mDirtyDoc.erase( doc );
+	cancelLint( doc );
 	Lock matchesLock( mMatchesMutex );
 	mMatches.erase( doc );
 }
@@ -712,13 +776,111 @@ void LinterPlugin::update( UICodeEditor* editor ) {
 	if ( it != mDirtyDoc.end() && it->second->getElapsedTime() >= mDelayTime ) {
 		mDirtyDoc.erase( doc.get() );
 #if LINTER_THREADED
-		mThreadPool->run( [this, doc] { lintDoc( doc ); } );
+		scheduleLint( doc );
 #else
 		lintDoc( doc );
 #endif
 	}
 }
 
+void LinterPlugin::scheduleLint( std::shared_ptr<TextDocument> doc ) {
+	{
+		std::lock_guard l( mLintQueueMutex );
+		auto& request = mLintRequests[doc.get()];
+		request.doc = doc;
+		if ( request.running ) {
+			// The running lint is outdated, kill it and re-queue the document once it finishes
+			request.pending = true;
+			std::lock_guard pl( mRunningProcessesMutex );
+			auto found = mRunningProcesses.find( doc.get() );
+			if ( found != mRunningProcesses.end() )
+				found->second.cancel();
+		} else if ( !request.pending ) {
+			request.pending = true;
+			mLintQueue.push_back( doc.get() );
+		}
+	}
+	dispatchLints();
+}
+
+void LinterPlugin::dispatchLints() {
+	std::vector<std::shared_ptr<TextDocument>> docs;
+	{
+		std::lock_guard l( mLintQueueMutex );
+		while ( mRunningLinters < mMaxConcurrentLinters && !mLintQueue.empty() ) {
+			TextDocument* docPtr = mLintQueue.front();
+			mLintQueue.pop_front();
+			auto it = mLintRequests.find( docPtr );
+			if ( it == mLintRequests.end() || !it->second.pending || it->second.running )
+				continue;
+			it->second.pending = false;
+			it->second.running = true;
+			mRunningLinters++;
+			docs.emplace_back( it->second.doc );
+		}
+	}
+
+	for ( auto& doc : docs ) {
+		mThreadPool->run( [this, doc] {
+			ScopedOp op(
+				[this]() {
+					std::lock_guard l( mWorkMutex );
+					mWorkersCount++;
+				},
+				[this]() {
+					{
+						std::lock_guard l( mWorkMutex );
+						mWorkersCount--;
+					}
+					mWorkerCondition.notify_all();
+				} );
+			lintDoc( doc );
+			onLintDone( doc.get() );
+		} );
+	}
+}
+
+void LinterPlugin::onLintDone( TextDocument* doc ) {
+	{
+		std::lock_guard l( mLintQueueMutex );
+		mRunningLinters--;
+		auto it = mLintRequests.find( doc );
+		if ( it != mLintRequests.end() ) {
+			it->second.running = false;
+			if ( it->second.pending ) {
+				mLintQueue.push_back( doc );
+			} else {
+				mLintRequests.erase( it );
+			}
+		}
+	}
+	if ( !mShuttingDown )
+		dispatchLints();
+}
+
+void LinterPlugin::cancelLint( TextDocument* doc ) {
+	std::lock_guard l( mLintQueueMutex );
+	auto it = mLintRequests.find( doc );
+	if ( it == mLintRequests.end() )
+		return;
+	if ( it->second.running ) {
+		// Keep the request until the worker reports back, it will be released in onLintDone
+		it->second.pending = false;
+		std::lock_guard pl( mRunningProcessesMutex );
+		auto found = mRunningProcesses.find( doc );
+		if ( found != mRunningProcesses.end() )
+			found->second.cancel();
+	} else {
+		mLintRequests.erase( it );
+	}
+}
+
+bool LinterPlugin::isLintCancelled( TextDocument* doc ) {
+	std::lock_guard l( mRunningProcessesMutex );
+	auto found = mRunningProcesses.find( doc );
+	return found != mRunningProcesses.end() && *found->second.cancelled;
+}
+
 const Time& LinterPlugin::getDelayTime() const {
 	return mDelayTime;
 }
@@ -727,6 +889,14 @@ void LinterPlugin::setDelayTime( const Time& delayTime ) {
 	mDelayTime = delayTime;
 }
 
+Uint32 LinterPlugin::getMaxConcurrentLinters() const {
+	return mMaxConcurrentLinters;
+}
+
+void LinterPlugin::setMaxConcurrentLinters( Uint32 maxConcurrentLinters ) {
+	mMaxConcurrentLinters = eemax<Uint32>( 1, maxConcurrentLinters );
+}
+
 bool LinterPlugin::getEnableLSPDiagnostics() const {
 	return mEnableLSPDiagnostics;
 }
@@ -794,6 +964,7 @@ void LinterPlugin::lintDoc( std::shared_ptr<TextDocument> doc ) {
 	if ( !binaryFound )
 		return;
 
+	const Uint64 modificationId = doc->getModificationId();
 	IOStreamString fileString;
 	if ( doc->isDirty() || !doc->hasFilepath() ) {
 		std::string tmpPath;
@@ -816,37 +987,42 @@ void LinterPlugin::lintDoc( std::shared_ptr<TextDocument> doc ) {
 		FileSystem::fileWrite( tmpPath, (Uint8*)fileString.getStreamPointer(),
 							   fileString.getSize() );
 		FileSystem::fileHide( tmpPath );
-		runLinter( doc, linter, tmpPath );
+		runLinter( doc, linter, tmpPath, modificationId );
 		FileSystem::fileRemove( tmpPath );
 	} else {
-		runLinter( doc, linter, doc->getFilePath() );
+		runLinter( doc, linter, doc->getFilePath(), modificationId );
 	}
 }
 
 void LinterPlugin::runLinter( std::shared_ptr<TextDocument> doc, const Linter& linter,
-							  const std::string& path ) {
+							  const std::string& path, Uint64 modificationId ) {
 	Clock clock;
 	std::string cmd( linter.command );
 	String::replaceAll( cmd, "$FILENAME", "\"" + path + "\"" );
-	if ( linter.isNative && mNativeLinters.find( cmd ) != mNativeLinters.end() ) {
-		mNativeLinters[cmd]( doc, path );
-		return;
-	}
+	bool isNative = linter.isNative && mNativeLinters.find( cmd ) != mNativeLinters.end();
 	Process process;
+	std::atomic<bool> cancelled{ false };
 	TextDocument* docPtr = doc.get();
+	// The native linters are registered too, setMatches discards the results of a cancelled run
 	ScopedOp op(
-		[this, &process, &docPtr] {
+		[this, &process, &cancelled, &docPtr, isNative] {
 			std::lock_guard l( mRunningProcessesMutex );
 			auto found = mRunningProcesses.find( docPtr );
 			if ( found != mRunningProcesses.end() )
-				found->second->kill();
-			mRunningProcesses[docPtr] = &process;
+				found->second.cancel();
+			mRunningProcesses[docPtr] = { isNative ? nullptr : &process, &cancelled };
 		},
-		[this, &docPtr] {
+		[this, &cancelled, &docPtr] {
 			std::lock_guard l( mRunningProcessesMutex );
-			mRunningProcesses.erase( docPtr );
+			auto found = mRunningProcesses.find( docPtr );
+			if ( found != mRunningProcesses.end() && found->second.cancelled == &cancelled )
+				mRunningProcesses.erase( found );
 		} );
-	;
+
+	if ( isNative ) {
+		mNativeLinters[cmd]( doc, path );
+		return;
+	}
 
 	if ( process.create( cmd, Process::getDefaultOptions() | Process::CombinedStdoutStderr, {},
 						 mManager->getWorkspaceFolder() ) ) {
@@ -854,7 +1030,7 @@ void LinterPlugin::runLinter( std::shared_ptr<TextDocument> doc, const Linter& l
 		std::string data;
 		process.readAllStdOut( data, Seconds( 30 ) );
 
-		if ( mShuttingDown ) {
+		if ( mShuttingDown || cancelled ) {
 			process.kill();
 			return;
 		}
@@ -862,6 +1038,14 @@ void LinterPlugin::runLinter( std::shared_ptr<TextDocument> doc, const Linter& l
 		process.join( &returnCode );
 		process.destroy();
 
+		// Killed because the document was closed or changed, the output is partial
+		if ( cancelled )
+			return;
+
+		// The document changed while linting, a newer run will report its matches
+		if ( doc->getModificationId() != modificationId )
+			return;
+
 		if ( linter.hasNoErrorsExitCode && linter.noErrorsExitCode == returnCode ) {
 			Lock matchesLock( mMatchesMutex );
 			std::map<Int64, std::vector<LinterMatch>> empty;
@@ -8,6 +8,8 @@
 #include <eepp/system/process.hpp>
 #include <eepp/system/threadpool.hpp>
 #include <eepp/ui/uicodeeditor.hpp>
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <set>
 using namespace EE;
@@ -100,6 +102,10 @@ class LinterPlugin : public Plugin {
 
 	void setDelayTime( const Time& delayTime );
 
+	Uint32 getMaxConcurrentLinters() const;
+
+	void setMaxConcurrentLinters( Uint32 maxConcurrentLinters );
+
 	bool getEnableLSPDiagnostics() const;
 
 	void setEnableLSPDiagnostics( bool enableLSPDiagnostics );
@@ -122,6 +128,24 @@ class LinterPlugin : public Plugin {
 	void unregisterNativeLinter( const std::string& cmd );
 
   protected:
+	struct LintRequest {
+		std::shared_ptr<TextDocument> doc;
+		bool running{ false };
+		bool pending{ false };
+	};
+
+	struct RunningLint {
+		Process* process{ nullptr };
+		// Set when the document was closed or changed, the results of the run are discarded
+		std::atomic<bool>* cancelled{ nullptr };
+
+		void cancel() {
+			*cancelled = true;
+			if ( process )
+				process->kill();
+		}
+	};
+
 	std::vector<Linter> mLinters;
 	std::unordered_map<UICodeEditor*, std::vector<Uint32>> mEditors;
 	std::set<TextDocument*> mDocs;
@@ -136,7 +160,12 @@ class LinterPlugin : public Plugin {
 	Int32 mWorkersCount{ 0 };
 	std::map<std::string, std::string> mKeyBindings; /* cmd, shortcut */
 	std::mutex mRunningProcessesMutex;
-	std::unordered_map<TextDocument*, Process*> mRunningProcesses;
+	std::unordered_map<TextDocument*, RunningLint> mRunningProcesses;
+	std::mutex mLintQueueMutex;
+	std::deque<TextDocument*> mLintQueue;
+	std::unordered_map<TextDocument*, LintRequest> mLintRequests;
+	Uint32 mRunningLinters{ 0 };
+	Uint32 mMaxConcurrentLinters{ 2 };
 	std::unordered_map<std::string, std::function<void( std::shared_ptr<TextDocument> doc,
 														const std::string& file )>>
 		mNativeLinters;
@@ -155,10 +184,20 @@ class LinterPlugin : public Plugin {
 
 	void load( PluginManager* pluginManager );
 
+	void scheduleLint( std::shared_ptr<TextDocument> doc );
+
+	void dispatchLints();
+
+	void onLintDone( TextDocument* doc );
+
+	void cancelLint( TextDocument* doc );
+
+	bool isLintCancelled( TextDocument* doc );
+
 	void lintDoc( std::shared_ptr<TextDocument> doc );
 
 	void runLinter( std::shared_ptr<TextDocument> doc, const Linter& linter,
-					const std::string& path );
+					const std::string& path, Uint64 modificationId );
 
 	Linter supportsLinter( std::shared_ptr<TextDocument> doc );
 
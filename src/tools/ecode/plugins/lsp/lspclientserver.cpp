@@ -17,6 +17,8 @@ namespace ecode {
 #define CONTENT_LENGTH "Content-Length"
 #define CONTENT_LENGTH_HEADER "Content-Length:"
 
+static const Time SLOW_REQUEST_THRESHOLD = Seconds( 2 );
+
 static const char* MEMBER_ID = "id";
 static const char* MEMBER_METHOD = "method";
 static const char* MEMBER_PARAMS = "params";
@@ -1135,6 +1137,7 @@ void LSPClientServer::initialize() {
 			mReady = true;
 			write( newRequest( "initialized" ) );
 			sendQueuedMessages();
+			processDidChangeQueue();
 			notifyServerInitialized();
 
 			// Broadcast the language capabilities to all the interested plugins
@@ -1217,8 +1220,10 @@ bool LSPClientServer::start() {
 	}
 
 	if ( !cmd.empty() ) {
-		bool ret = mProcess.create( cmd, Process::getDefaultOptions() | Process::EnableAsync,
-									mLSP.env, mRootPath );
+		bool ret = mProcess.create(
+			cmd,
+			Process::getDefaultOptions() | Process::EnableAsync | Process::SharedIOService,
+			mLSP.env, mRootPath );
 		if ( ret ) {
 			if ( mProcess.isAlive() ) {
 				mUsingProcess = true;
@@ -1283,6 +1288,14 @@ bool LSPClientServer::isRunning() {
 }
 
 void LSPClientServer::removeDoc( TextDocument* doc ) {
+	{
+		Lock l( mDidChangeMutex );
+		mDidChangeQueue.erase( std::remove_if( mDidChangeQueue.begin(), mDidChangeQueue.end(),
+											   [doc]( const DidChangeQueue& change ) {
+												   return change.doc == doc;
+											   } ),
+							   mDidChangeQueue.end() );
+	}
 	Lock l( mClientsMutex );
 	if ( mClients.erase( doc ) > 0 ) {
 		auto it = std::find( mDocs.begin(), mDocs.end(), doc );
@@ -1300,6 +1313,7 @@ LSPClientServer::LSPRequestHandle LSPClientServer::cancel( const PluginIDType& r
 	{
 		Lock l( mHandlersMutex );
 		res = mHandlers.erase( reqid ) > 0;
+		mRequestsInfo.erase( reqid );
 	}
 	if ( res > 0 ) {
 		auto params = newID( reqid );
@@ -1325,6 +1339,15 @@ LSPClientServer::LSPRequestHandle LSPClientServer::write( json&& msg, const Json
 
 	msg["jsonrpc"] = "2.0";
 
+	// Any pending (batched) document change must reach the server before any other request,
+	// otherwise the server could reply with outdated information
+	if ( mReady && msg.contains( MEMBER_METHOD ) && hasPendingDidChange() ) {
+		const auto& method = msg[MEMBER_METHOD];
+		if ( method != "textDocument/didChange" && method != "textDocument/didOpen" &&
+			 method != "initialized" )
+			processDidChangeQueue();
+	}
+
 	// notification == no handler
 	if ( h ) {
 		int msgId = ++mLastMsgId;
@@ -1340,6 +1363,14 @@ LSPClientServer::LSPRequestHandle LSPClientServer::write( json&& msg, const Json
 		std::string sjson( msg.dump() );
 		sjson.insert( 0, "Content-Length: " + String::toString( sjson.size() ) + "\r\n\r\n" );
 
+		if ( h && msg.contains( MEMBER_METHOD ) ) {
+			Lock l( mHandlersMutex );
+			auto& info = mRequestsInfo[ret.mId];
+			info.method = msg[MEMBER_METHOD].get<std::string>();
+			info.requestSize = sjson.size();
+			info.clock.restart();
+		}
+
 		if ( mReady || ( msg.contains( MEMBER_METHOD ) && msg[MEMBER_METHOD] == "initialize" ) ) {
 			if ( !isSilent() ) {
 				std::string method;
@@ -1522,21 +1553,64 @@ LSPClientServer::didChange( TextDocument* doc, const std::vector<DocumentContent
 	return LSPRequestHandle();
 }
 
-void LSPClientServer::queueDidChange( const URI& document, int version, const std::string&,
+void LSPClientServer::queueDidChange( TextDocument* doc, int version,
 									  const std::vector<DocumentContentChange>& change ) {
+	// Capabilities are unknown until the server is initialized, so keep the changes until then
+	auto syncKind = mReady ? mCapabilities.textDocumentSync.change
+						   : LSPDocumentSyncKind::Incremental;
+
+	if ( syncKind == LSPDocumentSyncKind::None )
+		return;
+
+	// The queue is flushed from the thread pool, the document can only be read from here.
+	// Until initialized the server may still ask for the full text.
+	std::string text;
+	if ( syncKind == LSPDocumentSyncKind::Full || !mReady )
+		text = doc->getText().toUtf8();
+
 	Lock l( mDidChangeMutex );
-	mDidChangeQueue.push( { document, version, change } );
+	if ( !mDidChangeQueue.empty() && mDidChangeQueue.back().doc == doc ) {
+		auto& last = mDidChangeQueue.back();
+		last.version = version;
+		last.text = std::move( text );
+		if ( syncKind == LSPDocumentSyncKind::Incremental )
+			last.change.insert( last.change.end(), change.begin(), change.end() );
+		return;
+	}
+
+	mDidChangeQueue.push_back(
+		{ doc, doc->getURI(), version,
+		  syncKind == LSPDocumentSyncKind::Incremental ? change
+													   : std::vector<DocumentContentChange>{},
+		  std::move( text ) } );
 }
 
 void LSPClientServer::processDidChangeQueue() {
+	if ( !mReady )
+		return;
+
 	Lock l( mDidChangeMutex );
 	while ( !mDidChangeQueue.empty() ) {
 		auto& change = mDidChangeQueue.front();
-		didChange( change.uri, change.version, "", change.change );
-		mDidChangeQueue.pop();
+		switch ( mCapabilities.textDocumentSync.change ) {
+			case LSPDocumentSyncKind::Incremental:
+				didChange( change.uri, change.version, "", change.change );
+				break;
+			case LSPDocumentSyncKind::Full:
+				didChange( change.uri, change.version, change.text );
+				break;
+			case LSPDocumentSyncKind::None:
+				break;
+		}
+		mDidChangeQueue.pop_front();
 	}
 }
 
+bool LSPClientServer::hasPendingDidChange() {
+	Lock l( mDidChangeMutex );
+	return !mDidChangeQueue.empty();
+}
+
 bool LSPClientServer::hasDocument( TextDocument* doc ) const {
 	return std::find( mDocs.begin(), mDocs.end(), doc ) != mDocs.end();
 }
@@ -1803,53 +1877,73 @@ void LSPClientServer::processRequest( const json& msg ) {
 void LSPClientServer::readStdOut( const char* bytes, size_t n ) {
 	if ( mEnded )
 		return;
-	mReceive.append( bytes, n );
 
-	std::string& buffer = mReceive;
+	// The receive buffer is reused for every message, frames are read in place and only the
+	// already consumed bytes are discarded before appending the new data
+	if ( mReceiveOffset > 0 ) {
+		mReceive.erase( 0, mReceiveOffset );
+		mReceiveOffset = 0;
+	}
+	mReceive.append( bytes, n );
 
 	while ( ( mUsingProcess && !mProcess.isShuttingDown() ) ||
 			( mUsingSocket && mSocket != nullptr ) ) {
-		auto index = buffer.find( CONTENT_LENGTH_HEADER );
-		if ( index == std::string::npos ) {
-			if ( buffer.size() > ( (Uint64)1 << 20 ) )
-				buffer.clear();
-			break;
-		}
+		std::string_view buffer( mReceive );
+		buffer.remove_prefix( mReceiveOffset );
+
+		// The header of a partially received message is parsed only once
+		if ( mReceivePayloadLength < 0 ) {
+			auto index = buffer.find( CONTENT_LENGTH_HEADER );
+			if ( index == std::string::npos ) {
+				if ( buffer.size() > ( (Uint64)1 << 20 ) )
+					mReceiveOffset = mReceive.size();
+				break;
+			}
 
-		index += strlen( CONTENT_LENGTH_HEADER );
-		auto endindex = buffer.find( "\r\n", index );
-		auto msgstart = buffer.find( "\r\n\r\n", index );
-		if ( endindex == std::string::npos || msgstart == std::string::npos )
-			break;
+			index += strlen( CONTENT_LENGTH_HEADER );
+			auto endindex = buffer.find( "\r\n", index );
+			auto msgstart = buffer.find( "\r\n\r\n", index );
+			if ( endindex == std::string::npos || msgstart == std::string::npos )
+				break;
 
-		msgstart += 4;
-		int length = 0;
-		bool ok = String::fromString( length, buffer.substr( index, endindex - index ) );
-		// FIXME perhaps detect if no reply for some time
-		// then again possibly better left to user to restart in such case
-		if ( !ok ) {
-			if ( !isSilent() )
-				Log::debug( "LSPClientServer::readStdOut server %s invalid " CONTENT_LENGTH,
-							mLSP.name.c_str() );
-			// flush and try to carry on to some next header
-			buffer.erase( 0, msgstart );
-			continue;
-		}
-		// sanity check to avoid extensive buffering
-		if ( length > ( 1 << 29 ) ) {
-			if ( !isSilent() )
-				Log::debug( "LSPClientServer::readStdOut server %s excessive size",
-							mLSP.name.c_str() );
-			buffer.clear();
+			msgstart += 4;
+			int length = 0;
+			bool ok = String::fromString(
+				length, std::string( buffer.substr( index, endindex - index ) ) );
+			// FIXME perhaps detect if no reply for some time
+			// then again possibly better left to user to restart in such case
+			if ( !ok ) {
+				if ( !isSilent() )
+					Log::debug( "LSPClientServer::readStdOut server %s invalid " CONTENT_LENGTH,
+								mLSP.name.c_str() );
+				// flush and try to carry on to some next header
+				mReceiveOffset += msgstart;
+				continue;
+			}
+			// sanity check to avoid extensive buffering
+			if ( length > ( 1 << 29 ) ) {
+				if ( !isSilent() )
+					Log::debug( "LSPClientServer::readStdOut server %s excessive size",
+								mLSP.name.c_str() );
+				mReceiveOffset = mReceive.size();
+				continue;
+			}
+
+			mReceiveOffset += msgstart;
+			mReceivePayloadLength = length;
+			// Big messages are received in several reads, avoid reallocating on each one
+			if ( mReceive.capacity() < mReceiveOffset + length )
+				mReceive.reserve( mReceiveOffset + length );
 			continue;
 		}
-		if ( msgstart + length > buffer.length() ) {
+
+		if ( (Int64)buffer.size() < mReceivePayloadLength )
 			break;
-		}
 
 		// now onto payload
-		auto payload = buffer.substr( msgstart, length );
-		buffer.erase( 0, msgstart + length );
+		auto payload = buffer.substr( 0, mReceivePayloadLength );
+		mReceiveOffset += mReceivePayloadLength;
+		mReceivePayloadLength = -1;
 
 		if ( payload.empty() ) {
 			if ( !isSilent() )
@@ -1858,72 +1952,118 @@ void LSPClientServer::readStdOut( const char* bytes, size_t n ) {
 			continue;
 		}
 
+		processMessage( payload );
+	}
+
+	if ( mReceiveOffset == mReceive.size() ) {
+		mReceive.clear();
+		mReceiveOffset = 0;
+	}
+}
+
+void LSPClientServer::processMessage( std::string_view payload ) {
 #ifndef EE_DEBUG
-		try {
+	try {
 #endif
-			auto res = json::parse( payload );
+		auto res = json::parse( payload.begin(), payload.end() );
 
-			PluginIDType msgid;
-			if ( res.contains( MEMBER_ID ) ) {
-				msgid = getID( res );
-			} else {
-				processNotification( res );
-				continue;
-			}
+		PluginIDType msgid;
+		if ( res.contains( MEMBER_ID ) ) {
+			msgid = getID( res );
+		} else {
+			processNotification( res );
+			return;
+		}
 
-			if ( res.contains( MEMBER_METHOD ) ) {
-				processRequest( res );
-				continue;
-			}
+		if ( res.contains( MEMBER_METHOD ) ) {
+			processRequest( res );
+			return;
+		}
 
-			if ( !isSilent() ) {
-				std::string respd( res.dump() );
-				if ( trimLogs() && respd.size() > EE_1KB ) {
-					Log::debug( "LSPClientServer::readStdOut server %s said:", mLSP.name.c_str() );
-					if ( Log::instance()->getLogLevelThreshold() <= LogLevel::Debug )
-						Log::instance()->writel( std::string_view( respd ).substr( 0, EE_1KB ) );
-				} else {
-					Log::debug( "LSPClientServer::readStdOut server %s said:\n%s",
-								mLSP.name.c_str(), respd.c_str() );
-				}
+		if ( !isSilent() ) {
+			std::string respd( res.dump() );
+			if ( trimLogs() && respd.size() > EE_1KB ) {
+				Log::debug( "LSPClientServer::readStdOut server %s said:", mLSP.name.c_str() );
+				if ( Log::instance()->getLogLevelThreshold() <= LogLevel::Debug )
+					Log::instance()->writel( std::string_view( respd ).substr( 0, EE_1KB ) );
+			} else {
+				Log::debug( "LSPClientServer::readStdOut server %s said:\n%s", mLSP.name.c_str(),
+							respd.c_str() );
 			}
+		}
 
-			HandlersMap::iterator it;
-			HandlersMap::iterator itEnd;
-			JsonReplyHandler handlerOK;
-			JsonReplyHandler handlerErr;
-			bool handlerFound = false;
-			{
-				Lock l( mHandlersMutex );
-				it = mHandlers.find( msgid );
-				itEnd = mHandlers.end();
-				handlerFound = it != itEnd;
-				if ( handlerFound ) {
-					handlerOK = it->second.first;
-					handlerErr = it->second.second;
-					mHandlers.erase( it );
-				}
+		HandlersMap::iterator it;
+		HandlersMap::iterator itEnd;
+		JsonReplyHandler handlerOK;
+		JsonReplyHandler handlerErr;
+		bool handlerFound = false;
+		{
+			Lock l( mHandlersMutex );
+			it = mHandlers.find( msgid );
+			itEnd = mHandlers.end();
+			handlerFound = it != itEnd;
+			if ( handlerFound ) {
+				handlerOK = it->second.first;
+				handlerErr = it->second.second;
+				mHandlers.erase( it );
 			}
+		}
 
-			if ( handlerFound ) {
-				if ( res.contains( MEMBER_ERROR ) && handlerErr ) {
-					handlerErr( msgid, res[MEMBER_ERROR] );
-				} else {
-					handlerOK( msgid, res[MEMBER_RESULT] );
-				}
+		updateRequestStats( msgid, payload.size() );
+
+		if ( handlerFound ) {
+			if ( res.contains( MEMBER_ERROR ) && handlerErr ) {
+				handlerErr( msgid, res[MEMBER_ERROR] );
 			} else {
-				if ( !isSilent() ) {
-					Log::debug( "LSPClientServer::readStdOut server %s unexpected reply id: %s",
-								mLSP.name.c_str(), msgid.toString().c_str() );
-				}
+				handlerOK( msgid, res[MEMBER_RESULT] );
+			}
+		} else {
+			if ( !isSilent() ) {
+				Log::debug( "LSPClientServer::readStdOut server %s unexpected reply id: %s",
+							mLSP.name.c_str(), msgid.toString().c_str() );
 			}
-#ifndef EE_DEBUG
-		} catch ( const json::exception& e ) {
-			Log::warning( "LSPClientServer::readStdOut server %s said: Coudln't parse json err: %s",
-						  mLSP.name.c_str(), e.what() );
 		}
+#ifndef EE_DEBUG
+	} catch ( const json::exception& e ) {
+		Log::warning( "LSPClientServer::readStdOut server %s said: Coudln't parse json err: %s",
+					  mLSP.name.c_str(), e.what() );
+	}
 #endif
+}
+
+void LSPClientServer::updateRequestStats( const PluginIDType& id, size_t responseSize ) {
+	Lock l( mHandlersMutex );
+	auto it = mRequestsInfo.find( id );
+	if ( it == mRequestsInfo.end() )
+		return;
+
+	Time elapsed = it->second.clock.getElapsedTime();
+	auto& stats = mRequestsStats[it->second.method];
+	stats.count++;
+	stats.totalTime += elapsed;
+	stats.maxTime = eemax( stats.maxTime, elapsed );
+	stats.requestBytes += it->second.requestSize;
+	stats.responseBytes += responseSize;
+
+	if ( !isSilent() ) {
+		Log::debug( "LSPClientServer server %s %s took %.2f ms (request %s, response %s)",
+					mLSP.name, it->second.method, elapsed.asMilliseconds(),
+					FileSystem::sizeToString( it->second.requestSize ),
+					FileSystem::sizeToString( responseSize ) );
+	}
+
+	if ( elapsed >= SLOW_REQUEST_THRESHOLD ) {
+		Log::warning( "LSPClientServer server %s slow response for %s: %.2f ms (response %s)",
+					  mLSP.name, it->second.method, elapsed.asMilliseconds(),
+					  FileSystem::sizeToString( responseSize ) );
 	}
+
+	mRequestsInfo.erase( it );
+}
+
+std::map<std::string, LSPClientServer::RequestStats> LSPClientServer::getRequestsStats() {
+	Lock l( mHandlersMutex );
+	return mRequestsStats;
 }
 
 void LSPClientServer::notifyServerError() {
@@ -6,6 +6,7 @@
 #include "lspdocumentclient.hpp"
 #include "lspprotocol.hpp"
 #include <atomic>
+#include <deque>
 #include <eepp/network/tcpsocket.hpp>
 #include <eepp/system/process.hpp>
 #include <eepp/ui/doc/textdocument.hpp>
@@ -113,11 +114,16 @@ class LSPClientServer {
 	LSPRequestHandle didChange( TextDocument* doc,
 								const std::vector<DocumentContentChange>& change = {} );
 
-	void queueDidChange( const URI& document, int version, const std::string& text,
+	//! Queues the document changes to be sent on the next didChange flush. Consecutive changes
+	//! of the same document are coalesced into a single didChange notification.
+	void queueDidChange( TextDocument* doc, int version,
 						 const std::vector<DocumentContentChange>& change = {} );
 
+	//! Sends all the queued document changes respecting the server text document sync kind.
 	void processDidChangeQueue();
 
+	bool hasPendingDidChange();
+
 	void documentDefinition( const URI& document, const TextPosition& pos );
 
 	void documentDeclaration( const URI& document, const TextPosition& pos );
@@ -245,6 +251,17 @@ class LSPClientServer {
 
 	bool isSilent() const;
 
+	struct RequestStats {
+		Uint64 count{ 0 };
+		Time totalTime{ Time::Zero };
+		Time maxTime{ Time::Zero };
+		Uint64 requestBytes{ 0 };
+		Uint64 responseBytes{ 0 };
+	};
+
+	//! Latency and size accumulated for every request method sent to the server.
+	std::map<std::string, RequestStats> getRequestsStats();
+
   protected:
 	LSPClientServerManager* mManager{ nullptr };
 	String::HashType mId;
@@ -270,17 +287,29 @@ class LSPClientServer {
 	};
 	std::vector<QueueMessage> mQueuedMessages;
 	std::string mReceive;
+	size_t mReceiveOffset{ 0 };
+	Int64 mReceivePayloadLength{ -1 };
 	std::string mReceiveErr;
+	struct RequestInfo {
+		std::string method;
+		size_t requestSize{ 0 };
+		Clock clock;
+	};
+	std::map<PluginIDType, RequestInfo> mRequestsInfo;
+	std::map<std::string, RequestStats> mRequestsStats;
 	LSPServerCapabilities mCapabilities;
 	URI mWorkspaceFolder;
 	std::vector<std::string> mLanguagesSupported;
 
 	struct DidChangeQueue {
+		TextDocument* doc;
 		URI uri;
-		IdType version;
+		int version;
 		std::vector<DocumentContentChange> change;
+		// Snapshot of the document for the full sync, taken when the change is queued
+		std::string text;
 	};
-	std::queue<DidChangeQueue> mDidChangeQueue;
+	std::deque<DidChangeQueue> mDidChangeQueue;
 	Mutex mDidChangeMutex;
 	std::mutex mShutdownMutex;
 	std::condition_variable mShutdownCond;
@@ -291,6 +320,10 @@ class LSPClientServer {
 
 	void readStdErr( const char* bytes, size_t n );
 
+	void processMessage( std::string_view payload );
+
+	void updateRequestStats( const PluginIDType& id, size_t responseSize );
+
 	LSPRequestHandle write( json&& msg, const JsonReplyHandler& h = nullptr,
 							const JsonReplyHandler& eh = nullptr, const int id = 0 );
 
@@ -2,6 +2,7 @@
 #include "lspclientplugin.hpp"
 #include "lspclientserver.hpp"
 #include "lspclientservermanager.hpp"
+#include <eepp/scene/actionmanager.hpp>
 #include <eepp/system/filesystem.hpp>
 #include <eepp/system/iostreamstring.hpp>
 #include <eepp/system/log.hpp>
@@ -27,6 +28,8 @@ LSPDocumentClient::~LSPDocumentClient() {
 		sceneNode->removeActionsByTag( mTag );
 	if ( nullptr != sceneNode && 0 != mTagSemanticTokens )
 		sceneNode->removeActionsByTag( mTagSemanticTokens );
+	if ( nullptr != sceneNode && 0 != mTagDidChange )
+		sceneNode->removeActionsByTag( mTagDidChange );
 	mShutdown = true;
 	while ( mRunningSemanticTokens )
 		Sys::sleep( Milliseconds( 0.1f ) );
@@ -40,10 +43,10 @@ void LSPDocumentClient::onDocumentLoaded( TextDocument* ) {
 
 void LSPDocumentClient::onDocumentTextChanged( const DocumentContentChange& change ) {
 	++mVersion;
-	// If several change event are being fired, the thread pool can't guaranteed that it will be
-	// executed in FIFO. Se we accumulate the events in a queue and fire them in correct order.
-	mServer->queueDidChange( mDoc->getURI(), mVersion, "", { change } );
-	mServer->getThreadPool()->run( [this, change]() { mServer->processDidChangeQueue(); } );
+	// Changes are accumulated and sent in batches, several consecutive changes will be sent in a
+	// single didChange notification. Any other request sent to the server flushes the queue first.
+	mServer->queueDidChange( mDoc, mVersion, { change } );
+	requestDidChangeDelayed();
 	requestSymbolsDelayed();
 	requestSemanticHighlightingDelayed();
 }
@@ -119,11 +122,34 @@ void LSPDocumentClient::refreshTag() {
 	String::HashType oldTag = mTag;
 	mTag = String::hash( mDoc->getURI().toString() );
 	mTagSemanticTokens = String::hash( mDoc->getURI().toString() + ":semantictokens" );
+	mTagDidChange = String::hash( mDoc->getURI().toString() + ":didchange" );
 	UISceneNode* sceneNode = getUISceneNode();
 	if ( nullptr != sceneNode && 0 != oldTag )
 		sceneNode->removeActionsByTag( oldTag );
 }
 
+void LSPDocumentClient::requestDidChangeDelayed() {
+	LSPClientServer* server = mServer;
+	LSPClientServerManager* manager = mServerManager;
+	UISceneNode* sceneNode = getUISceneNode();
+	if ( nullptr == sceneNode ) {
+		server->getThreadPool()->run( [server]() { server->processDidChangeQueue(); } );
+		return;
+	}
+	// A flush is already scheduled, the change will be sent with it
+	ActionManager* actionManager = sceneNode->getActionManager();
+	if ( actionManager->getActionByTagFromTarget( sceneNode, mTagDidChange, true ) )
+		return;
+	sceneNode->runOnMainThread(
+		[server, manager]() {
+			server->getThreadPool()->run( [server, manager]() {
+				if ( manager->isServerRunning( server ) )
+					server->processDidChangeQueue();
+			} );
+		},
+		Milliseconds( 50 ), mTagDidChange );
+}
+
 void LSPDocumentClient::requestSemanticHighlighting( bool reqFull ) {
 	if ( !mServer || !mServer->getManager()->getPlugin()->semanticHighlightingEnabled() ||
 		 !mServer->getManager()->getPlugin()->langSupportsSemanticHighlighting(
@@ -70,6 +70,7 @@ class LSPDocumentClient : public TextDocument::Client {
 	TextDocument* mDoc{ nullptr };
 	String::HashType mTag{ 0 };
 	String::HashType mTagSemanticTokens{ 0 };
+	String::HashType mTagDidChange{ 0 };
 	int mVersion{ 0 };
 	std::string mSemanticeResultId;
 	LSPSemanticTokensDelta mSemanticTokens;
@@ -81,6 +82,8 @@ class LSPDocumentClient : public TextDocument::Client {
 
 	void refreshTag();
 
+	void requestDidChangeDelayed();
+
 	UISceneNode* getUISceneNode();
 
 	void processTokens( LSPSemanticTokensDelta&& tokens, const Uint64& docModificationId );
@@ -302,7 +302,7 @@ void ProjectSearch::find( const std::vector<std::string> files, std::string stri
 							findData->res.push_back( { std::move( file ), std::move( fileRes ) } );
 						}
 					},
-					onSearchEnd );
+					onSearchEnd, 0, ThreadPool::Priority::Background );
 			} else {
 				pool->run(
 					[findData, file, string, caseSensitive, wholeWord, occ, type] {
@@ -316,7 +316,7 @@ void ProjectSearch::find( const std::vector<std::string> files, std::string stri
 							findData->res.push_back( { std::move( file ), std::move( fileRes ) } );
 						}
 					},
-					onSearchEnd );
+					onSearchEnd, 0, ThreadPool::Priority::Background );
 			}
 		}
 	} );
@@ -38,65 +38,51 @@ UIPushButton* StatusBuildOutputController::getCleanButton( App* app ) {
 	return nullptr;
 }
 
-bool StatusBuildOutputController::searchFindAndAddStatusResult(
-	const std::vector<PatternHolder>& patterns, const std::string& text,
-	const ProjectBuildCommand* cmd ) {
-	LuaPattern::Range matches[12];
-	for ( const auto& pattern : patterns ) {
-		if ( pattern.pattern.matches( text, matches ) ) {
-			StatusMessage status;
-			status.type = pattern.config.type;
-
-			for ( int i = 0; i < (int)pattern.pattern.getNumMatches(); ++i ) {
-				if ( !matches[i].isValid() )
-					break;
-
-				if ( i == 0 ) {
-					status.output = text;
-					continue;
-				}
+static void safeInsertBuffer( TextDocument& doc, const std::string& buffer ) {
+	doc.insert( 0, doc.endOfDoc(), buffer );
+}
 
-				std::string subtxt = text.substr( matches[i].start, matches[i].end );
-				if ( pattern.config.patternOrder.message == i ) {
-					auto nl = subtxt.find_first_of( '\n' );
-					if ( nl == std::string::npos ) {
-						status.message = std::move( subtxt );
-					} else {
-						status.message = subtxt.substr( 0, nl );
-					}
-				} else if ( pattern.config.patternOrder.file == i ) {
-					bool isRelativePath = FileSystem::isRelativePath( subtxt );
-					status.file = !subtxt.empty() && isRelativePath
-									  ? FileSystem::getRealPath( cmd->workingDir + subtxt )
-									  : FileSystem::getRealPath( subtxt );
-					if ( isRelativePath ) {
-						FileInfo file( status.file );
-						if ( !file.exists() || !file.isRegularFile() )
-							status.file = subtxt;
-					}
-					status.fileName = FileSystem::fileNameFromPath( status.file );
-				} else if ( pattern.config.patternOrder.line == i ) {
-					int l;
-					if ( String::fromString( l, subtxt ) )
-						status.line = l;
-				} else if ( pattern.config.patternOrder.col == i ) {
-					int c;
-					if ( String::fromString( c, subtxt ) )
-						status.col = c;
-				}
-			}
+void StatusBuildOutputController::pushOutput( const std::shared_ptr<BuildOutputPipeline>& pipeline,
+											 const std::string& buffer,
+											 const ProjectBuildCommand* cmd ) {
+	// Everything pushed until the UI thread takes it is inserted at once, in the next frame
+	if ( pipeline->push( buffer, cmd ) )
+		mBuildOutput->runOnMainThread( [this, pipeline]() { flushOutput( pipeline ); } );
+}
 
-			mStatusResults.emplace_back( status );
-			if ( mTableIssues->getModel() )
-				mTableIssues->getModel()->invalidate();
-			return true;
-		}
+void StatusBuildOutputController::flushOutput(
+	const std::shared_ptr<BuildOutputPipeline>& pipeline ) {
+	// The output of a previous build
+	if ( pipeline != mPipeline )
+		return;
+
+	auto batch( pipeline->take() );
+	TextDocument& doc = mBuildOutput->getDocument();
+
+	if ( batch.droppedLines > 0 ) {
+		safeInsertBuffer( doc, String::format( "[... %zu lines omitted ...]\n",
+											   batch.droppedLines ) );
 	}
-	return false;
-}
 
-static void safeInsertBuffer( TextDocument& doc, const std::string& buffer ) {
-	doc.insert( 0, doc.endOfDoc(), buffer );
+	if ( !batch.output.empty() )
+		safeInsertBuffer( doc, batch.output );
+
+	// Keep the document bounded, the oldest lines are removed
+	if ( doc.linesCount() > pipeline->getMaxLines() ) {
+		doc.remove( 0, { { 0, 0 }, { (Int64)( doc.linesCount() - pipeline->getMaxLines() ), 0 } } );
+		mBuildOutput->invalidateLongestLineWidth();
+	}
+
+	if ( !batch.issues.empty() ) {
+		mStatusResults.insert( mStatusResults.end(),
+							   std::make_move_iterator( batch.issues.begin() ),
+							   std::make_move_iterator( batch.issues.end() ) );
+		if ( mTableIssues->getModel() )
+			mTableIssues->getModel()->invalidate();
+	}
+
+	if ( mScrollLocked )
+		mBuildOutput->setScrollY( mBuildOutput->getMaxScroll().y );
 }
 
 void StatusBuildOutputController::runBuild( const std::string& buildName,
@@ -120,14 +106,12 @@ void StatusBuildOutputController::runBuild( const std::string& buildName,
 	mBuildOutput->setScrollY( mBuildOutput->getMaxScroll().y );
 
 	std::vector<SyntaxPattern> patterns;
-
-	mPatternHolder.clear();
-	mCurLineBuffer.clear();
+	std::vector<PatternHolder> patternHolder;
 
 	auto configs = { outputParser.getPresetConfig(), outputParser.getConfig() };
 	for ( const auto& config : configs ) {
 		for ( const auto& parser : config ) {
-			mPatternHolder.push_back( { LuaPatternStorage( parser.pattern ), parser } );
+			patternHolder.push_back( { LuaPatternStorage( parser.pattern ), parser } );
 
 			SyntaxPattern ptn( { parser.pattern },
 							   getProjectOutputParserTypeToString( parser.type ) );
@@ -145,6 +129,9 @@ void StatusBuildOutputController::runBuild( const std::string& buildName,
 
 	SyntaxDefinition synDef( "custom_build", {}, std::move( patterns ) );
 
+	auto pipeline = std::make_shared<BuildOutputPipeline>( std::move( patternHolder ) );
+	mPipeline = pipeline;
+
 	mBuildOutput->getDocument().setSyntaxDefinition( synDef );
 	mBuildOutput->getVScrollBar()->setValue( 1.f );
 	mBuildOutput->getDocument().getHighlighter()->setMaxTokenizationLength( 2048 );
@@ -206,33 +193,12 @@ void StatusBuildOutputController::runBuild( const std::string& buildName,
 	auto res = pbm->build(
 		buildName, [this]( const auto& key, const auto& def ) { return mApp->i18n( key, def ); },
 		buildType,
-		[this]( auto, std::string buffer, const ProjectBuildCommand* cmd ) {
-			mBuildOutput->runOnMainThread( [this, buffer]() {
-				safeInsertBuffer( mBuildOutput->getDocument(), buffer );
-				if ( mScrollLocked )
-					mBuildOutput->setScrollY( mBuildOutput->getMaxScroll().y );
-			} );
-
-			if ( nullptr == cmd )
-				return;
-
-			do {
-				auto nl = buffer.find_first_of( '\n' );
-				if ( nl != std::string::npos ) {
-					mCurLineBuffer += buffer.substr( 0, nl );
-					searchFindAndAddStatusResult( mPatternHolder, mCurLineBuffer, cmd );
-					buffer = buffer.substr( nl + 1 );
-					mCurLineBuffer.clear();
-				} else {
-					mCurLineBuffer += buffer;
-					buffer.clear();
-				}
-			} while ( !buffer.empty() );
+		[this, pipeline]( auto, std::string buffer, const ProjectBuildCommand* cmd ) {
+			pushOutput( pipeline, buffer, cmd );
 		},
-		[this, updateBuildButton, isClean, doneFn]( auto exitCode,
-													const ProjectBuildCommand* cmd ) {
-			if ( !mCurLineBuffer.empty() && nullptr != cmd )
-				searchFindAndAddStatusResult( mPatternHolder, mCurLineBuffer, cmd );
+		[this, pipeline, updateBuildButton, isClean, doneFn]( auto exitCode,
+															  const ProjectBuildCommand* cmd ) {
+			pipeline->flushLine( cmd );
 			String buffer;
 
 			if ( EXIT_SUCCESS == exitCode ) {
@@ -245,11 +211,7 @@ void StatusBuildOutputController::runBuild( const std::string& buildName,
 								   : mApp->i18n( "build_failed", "Build run with errors\n" ) );
 			}
 
-			mBuildOutput->runOnMainThread( [this, buffer]() {
-				safeInsertBuffer( mBuildOutput->getDocument(), buffer );
-				if ( mScrollLocked )
-					mBuildOutput->setScrollY( mBuildOutput->getMaxScroll().y );
-			} );
+			pushOutput( pipeline, buffer.toUtf8(), nullptr );
 
 			updateBuildButton();
 
@@ -1,6 +1,7 @@
 #ifndef ECODE_STATUSBUILDOUTPUTCONTROLLER_HPP
 #define ECODE_STATUSBUILDOUTPUTCONTROLLER_HPP
 
+#include "buildoutputpipeline.hpp"
 #include "projectbuild.hpp"
 #include "uistatusbar.hpp"
 #include <eepp/system/luapattern.hpp>
@@ -20,21 +21,6 @@ namespace ecode {
 class App;
 class UIRelativeLayoutCommandExecuter;
 
-struct StatusMessage {
-	ProjectOutputParserTypes type;
-	String output;
-	String message;
-	std::string file;
-	std::string fileName;
-	Int64 line{ 0 };
-	Int64 col{ 0 };
-};
-
-struct PatternHolder {
-	LuaPatternStorage pattern;
-	ProjectBuildOutputParserConfig config;
-};
-
 class StatusBuildOutputController : public StatusBarElement {
   public:
 	StatusBuildOutputController( UISplitter* mainSplitter, UISceneNode* uiSceneNode, App* app );
@@ -69,8 +55,7 @@ class StatusBuildOutputController : public StatusBarElement {
 	UIPushButton* mConfigureButton{ nullptr };
 
 	std::vector<StatusMessage> mStatusResults;
-	std::vector<PatternHolder> mPatternHolder;
-	std::string mCurLineBuffer;
+	std::shared_ptr<BuildOutputPipeline> mPipeline;
 	bool mScrollLocked{ true };
 
 	void createContainer();
@@ -79,8 +64,10 @@ class StatusBuildOutputController : public StatusBarElement {
 
 	UIPushButton* getCleanButton( App* app );
 
-	bool searchFindAndAddStatusResult( const std::vector<PatternHolder>& patterns,
-									   const std::string& text, const ProjectBuildCommand* cmd );
+	void pushOutput( const std::shared_ptr<BuildOutputPipeline>& pipeline,
+					 const std::string& buffer, const ProjectBuildCommand* cmd );
+
+	void flushOutput( const std::shared_ptr<BuildOutputPipeline>& pipeline );
 
 	void onLoadDone( const Variant& lineNum, const Variant& colNum );
 